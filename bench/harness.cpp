@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file harness.cpp
+ * @brief Implements the helpers of the end-to-end benchmarks: stage statistics and runs of the yolo-cls executable.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "harness.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "json.h"
+#include "utils.h"
+
+/// An anonymous temporary file, removed when it is closed.
+using temporary_file = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+/**
+ * @brief Creates an anonymous temporary file.
+ * @return The open file.
+ * @throws std::runtime_error if the file cannot be created.
+ */
+static temporary_file make_temporary_file()
+{
+    temporary_file file(std::tmpfile(), std::fclose);
+    if(!file)
+        throw std::runtime_error(std::string("Could not create a temporary file: ") + std::strerror(errno));
+
+    return file;
+}
+
+/**
+ * @brief Lists the supported image files of a directory and its subdirectories.
+ * @param[in] directory The directory.
+ * @return The paths, sorted.
+ * @throws std::filesystem::filesystem_error if the directory cannot be read.
+ */
+std::vector<std::string> list_images(std::string const &directory)
+{
+    std::vector<std::string> result;
+
+    for(auto const &entry : std::filesystem::recursive_directory_iterator(directory))
+    {
+        if(entry.is_regular_file() && is_supported_image(entry.path().extension().string()))
+            result.push_back(entry.path().string());
+    }
+
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+/**
+ * @brief Reads the per-stage statistics written by `yolo-cls --stats-json`.
+ * @param[in] path The path to the statistics file.
+ * @return The time spent in every stage.
+ * @throws std::runtime_error if the file cannot be read or has another format.
+ */
+stage_times read_stage_times(std::string const &path)
+{
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+
+    if(!file)
+        throw std::runtime_error("Could not read the statistics '" + path + "'.");
+
+    auto const root = parse_json(ss.str());
+
+    stage_times result;
+    result.images = static_cast<size_t>(root.at("images").number);
+    result.bytes  = static_cast<uint64_t>(root.at("bytes_read").number);
+
+    // Stages without operations are left out of the file
+    auto const &stages = root.at("stages");
+    for(size_t i = 0; i < pipeline_stage_count; ++i)
+    {
+        auto const *s = stages.find(pipeline_stage_name(static_cast<pipeline_stage>(i)));
+        if(s == nullptr)
+            continue;
+
+        result.count[i] = static_cast<uint64_t>(s->at("count").number);
+        result.total[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double, std::micro>(s->at("total_us").number));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Runs yolo-cls with a single worker thread and takes the time of every stage from its `--stats-json`.
+ * @details `-t 1` and `--stats-json` with a temporary file are appended to the arguments.
+ * @param[in] arguments The path to the yolo-cls executable followed by its arguments.
+ * @param[in] input The standard input of the process, the paths to the images.
+ * @return The time spent in every stage.
+ * @throws std::runtime_error if the process fails or its statistics cannot be read.
+ */
+stage_times time_stages(std::vector<std::string> arguments, std::string const &input)
+{
+    // yolo-cls writes the statistics by name, so the temporary file needs a path
+    std::string path = (std::filesystem::temp_directory_path() / "yolo-cls-stats-XXXXXX").string();
+    int const fd     = mkstemp(path.data());
+    if(fd < 0)
+        throw std::runtime_error(std::string("Could not create a temporary file: ") + std::strerror(errno));
+    close(fd);
+
+    arguments.insert(arguments.end(), {"-t", "1", "--stats-json", path});
+
+    stage_times result;
+    try
+    {
+        run_process(arguments, input);
+        result = read_stage_times(path);
+    }
+    catch(...)
+    {
+        std::filesystem::remove(path);
+        throw;
+    }
+
+    std::filesystem::remove(path);
+
+    return result;
+}
+
+/**
+ * @brief Runs an executable and measures its resource usage.
+ * @details The standard output is written to an anonymous temporary file and counted, the standard error is kept for the error message.
+ * @param[in] arguments The path to the executable followed by its arguments.
+ * @param[in] input The standard input of the process.
+ * @return The resource usage of the process.
+ * @throws std::runtime_error if the process cannot be started or exits with a non-zero status.
+ */
+process_result run_process(std::vector<std::string> const &arguments, std::string const &input)
+{
+    auto const in  = make_temporary_file();
+    auto const out = make_temporary_file();
+    auto const err = make_temporary_file();
+
+    std::fwrite(input.data(), 1, input.size(), in.get());
+    std::fflush(in.get());
+    std::rewind(in.get());
+
+    std::vector<char *> argv;
+    for(auto const &argument : arguments)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    argv.push_back(nullptr);
+
+    process_result result;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    pid_t const pid = fork();
+    if(pid < 0)
+        throw std::runtime_error(std::string("Could not start a process: ") + std::strerror(errno));
+
+    if(pid == 0)
+    {
+        // The child: the temporary files become the standard streams
+        dup2(fileno(in.get()), STDIN_FILENO);
+        dup2(fileno(out.get()), STDOUT_FILENO);
+        dup2(fileno(err.get()), STDERR_FILENO);
+
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    rusage usage {};
+    if(wait4(pid, &status, 0, &usage) < 0)
+        throw std::runtime_error(std::string("Could not wait for a process: ") + std::strerror(errno));
+
+    result.wall = std::chrono::steady_clock::now() - start;
+    result.cpu  = std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+
+    // Linux reports the peak resident set size in KiB
+    result.peak_rss_kib = usage.ru_maxrss;
+
+    std::rewind(out.get());
+    char buffer[65536];
+    for(size_t n = std::fread(buffer, 1, sizeof(buffer), out.get()); n != 0; n = std::fread(buffer, 1, sizeof(buffer), out.get()))
+        result.output_lines += static_cast<size_t>(std::count(buffer, buffer + n, '\n'));
+
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        // The last line of the standard error explains the failure
+        std::string message;
+        std::rewind(err.get());
+        for(size_t n = std::fread(buffer, 1, sizeof(buffer), err.get()); n != 0; n = std::fread(buffer, 1, sizeof(buffer), err.get()))
+            message.append(buffer, n);
+
+        while(!message.empty() && message.back() == '\n')
+            message.pop_back();
+        message = message.substr(message.find_last_of('\n') + 1);
+
+        std::string const reason = WIFEXITED(status) ? "exited with the status " + std::to_string(WEXITSTATUS(status)) : "was killed by the signal " + std::to_string(WTERMSIG(status));
+        throw std::runtime_error("'" + arguments.front() + "' " + reason + (message.empty() ? "." : ": " + message));
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file harness.h
+ * @brief Declares the helpers of the end-to-end benchmarks: stage statistics and runs of the yolo-cls executable.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef HARNESS_H
+#define HARNESS_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "stage_stats.h"
+
+/**
+ * @struct stage_times
+ * @brief The time spent in every pipeline stage of a yolo-cls run, as reported by `--stats-json`.
+ */
+struct stage_times
+{
+    std::array<std::chrono::nanoseconds, pipeline_stage_count> total {}; ///< The total time of every stage.
+    std::array<uint64_t, pipeline_stage_count> count {};                ///< The number of timed operations of every stage, 0 if it was not run.
+    size_t images  = 0;                                                 ///< The number of classified images.
+    uint64_t bytes = 0;                                                 ///< The number of bytes read.
+};
+
+/**
+ * @struct process_result
+ * @brief The resource usage of a finished child process.
+ */
+struct process_result
+{
+    std::chrono::nanoseconds wall {}; ///< The wall-clock time from the start to the exit.
+    std::chrono::nanoseconds cpu {};  ///< The user and system CPU time.
+    long peak_rss_kib   = 0;          ///< The peak resident set size in KiB.
+    size_t output_lines = 0;          ///< The number of lines written to the standard output.
+};
+
+/**
+ * @brief Lists the supported image files of a directory and its subdirectories.
+ * @param[in] directory The directory.
+ * @return The paths, sorted.
+ * @throws std::filesystem::filesystem_error if the directory cannot be read.
+ */
+std::vector<std::string> list_images(std::string const &directory);
+
+/**
+ * @brief Reads the per-stage statistics written by `yolo-cls --stats-json`.
+ * @param[in] path The path to the statistics file.
+ * @return The time spent in every stage.
+ * @throws std::runtime_error if the file cannot be read or has another format.
+ */
+stage_times read_stage_times(std::string const &path);
+
+/**
+ * @brief Runs yolo-cls with a single worker thread and takes the time of every stage from its `--stats-json`.
+ * @details `-t 1` and `--stats-json` with a temporary file are appended to the arguments.
+ * @param[in] arguments The path to the yolo-cls executable followed by its arguments.
+ * @param[in] input The standard input of the process, the paths to the images.
+ * @return The time spent in every stage.
+ * @throws std::runtime_error if the process fails or its statistics cannot be read.
+ */
+stage_times time_stages(std::vector<std::string> arguments, std::string const &input);
+
+/**
+ * @brief Runs an executable and measures its resource usage.
+ * @details The standard output is written to an anonymous temporary file and counted, the standard error is kept for the error message.
+ * @param[in] arguments The path to the executable followed by its arguments.
+ * @param[in] input The standard input of the process.
+ * @return The resource usage of the process.
+ * @throws std::runtime_error if the process cannot be started or exits with a non-zero status.
+ */
+process_result run_process(std::vector<std::string> const &arguments, std::string const &input);
+
+/**
+ * @brief Returns the median of some values.
+ * @param[in] values The values, not empty.
+ * @return The median, the lower middle value for an even count.
+ */
+template<typename T>
+T median(std::vector<T> values)
+{
+    auto const middle = values.begin() + static_cast<std::ptrdiff_t>((values.size() - 1) / 2);
+    std::nth_element(values.begin(), middle, values.end());
+
+    return *middle;
+}
+
+#endif // HARNESS_H
\ No newline at end of file
@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file postprocess.cpp
+ * @brief Microbenchmarks of the post-processing of the model output.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "yolo.h"
+
+/**
+ * @brief Generates reproducible raw scores (logits).
+ * @param[in] count The number of scores (classes).
+ * @return The scores.
+ */
+static std::vector<float> random_scores(size_t count)
+{
+    std::mt19937 generator(42);
+    std::normal_distribution<float> distribution(0.0f, 4.0f);
+
+    std::vector<float> scores(count);
+    for(float &score : scores)
+        score = distribution(generator);
+
+    return scores;
+}
+
+/**
+ * @brief Measures `softmax_scores`, including the copy of the raw scores that `yolo::postprocess` makes.
+ * @details The argument is the number of classes.
+ * @param[in,out] state The benchmark state.
+ */
+static void bm_softmax_scores(benchmark::State &state)
+{
+    std::vector<float> const logits = random_scores(static_cast<size_t>(state.range(0)));
+    std::vector<float> scores;
+
+    for(auto _ : state)
+    {
+        scores = logits;
+        softmax_scores(scores);
+        benchmark::DoNotOptimize(scores.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_softmax_scores)->ArgName("classes")->Arg(1000)->Arg(21843);
+
+/**
+ * @brief Measures `top_k_scores`.
+ * @details The arguments are the number of classes and K.
+ * @param[in,out] state The benchmark state.
+ */
+static void bm_top_k_scores(benchmark::State &state)
+{
+    std::vector<float> const scores = random_scores(static_cast<size_t>(state.range(0)));
+    size_t const top_k              = static_cast<size_t>(state.range(1));
+
+    for(auto _ : state)
+    {
+        auto top = top_k_scores(scores, top_k);
+        benchmark::DoNotOptimize(top.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(bm_top_k_scores)->ArgNames({"classes", "k"})->ArgsProduct({{1000, 21843}, {1, 5, 100}});
\ No newline at end of file
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file preprocess.cpp
+ * @brief Microbenchmarks of the image preprocessing.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+
+#include "yolo.h"
+
+/**
+ * @brief Measures `preprocess_image` for a source image of the given resolution.
+ * @details The arguments are the width and the height of the source image, which is resized to the default model input size.
+ * @param[in,out] state The benchmark state.
+ */
+static void bm_preprocess_image(benchmark::State &state)
+{
+    cv::Mat image(static_cast<int>(state.range(1)), static_cast<int>(state.range(0)), CV_8UC3);
+    cv::randu(image, cv::Scalar(0), cv::Scalar(255));
+
+    cv::Size const size(yolo::default_input_size, yolo::default_input_size);
+    std::vector<float> tensor(3 * static_cast<size_t>(size.area()));
+
+    for(auto _ : state)
+    {
+        preprocess_image(image, size, tensor.data());
+        benchmark::DoNotOptimize(tensor.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(image.total() * image.elemSize()));
+}
+BENCHMARK(bm_preprocess_image)
+    ->ArgNames({"width", "height"})
+    ->Args({224, 224})
+    ->Args({640, 480})
+    ->Args({1280, 720})
+    ->Args({1920, 1080})
+    ->Args({3840, 2160})
+    ->Unit(benchmark::kMicrosecond);
\ No newline at end of file
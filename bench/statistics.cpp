@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file statistics.cpp
+ * @brief Implements the statistical tests of the performance regression gate.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "statistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief Tests whether two samples come from the same distribution with the Mann-Whitney U test.
+ * @details The test is two-sided and uses the normal approximation with tie and continuity corrections,
+ *          which is adequate from about 8 values per sample. It compares ranks, so a few outliers
+ *          (e.g., a run disturbed by another process) do not decide the result.
+ * @param[in] a The first sample.
+ * @param[in] b The second sample.
+ * @return The p-value, 1 if either sample is empty or all values are equal.
+ */
+double mann_whitney_p(std::vector<double> const &a, std::vector<double> const &b)
+{
+    if(a.empty() || b.empty())
+        return 1.0;
+
+    // The pooled values, each marked with its sample
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(a.size() + b.size());
+    for(double value : a)
+        pooled.emplace_back(value, true);
+    for(double value : b)
+        pooled.emplace_back(value, false);
+
+    std::sort(pooled.begin(), pooled.end(), [](auto const &x, auto const &y) { return x.first < y.first; });
+
+    // Rank sum of the first sample, tied values get the mean of their ranks
+    double rank_sum_a = 0.0;
+    double tie_term   = 0.0;
+    for(size_t i = 0; i < pooled.size();)
+    {
+        size_t j = i;
+        while(j < pooled.size() && pooled[j].first == pooled[i].first)
+            ++j;
+
+        double const ties = static_cast<double>(j - i);
+        double const rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+        for(size_t k = i; k < j; ++k)
+        {
+            if(pooled[k].second)
+                rank_sum_a += rank;
+        }
+
+        tie_term += ties * ties * ties - ties;
+        i = j;
+    }
+
+    double const n1 = static_cast<double>(a.size());
+    double const n2 = static_cast<double>(b.size());
+    double const n  = n1 + n2;
+
+    double const u     = rank_sum_a - n1 * (n1 + 1.0) / 2.0;
+    double const mean  = n1 * n2 / 2.0;
+    double const sigma = std::sqrt(n1 * n2 / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0))));
+
+    if(sigma == 0.0)
+        return 1.0;
+
+    double const z = std::max(0.0, std::abs(u - mean) - 0.5) / sigma;
+
+    return std::erfc(z / std::sqrt(2.0));
+}
\ No newline at end of file
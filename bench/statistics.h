@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file statistics.h
+ * @brief Declares the statistical tests of the performance regression gate.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <vector>
+
+/**
+ * @brief Tests whether two samples come from the same distribution with the Mann-Whitney U test.
+ * @details The test is two-sided and uses the normal approximation with tie and continuity corrections,
+ *          which is adequate from about 8 values per sample. It compares ranks, so a few outliers
+ *          (e.g., a run disturbed by another process) do not decide the result.
+ * @param[in] a The first sample.
+ * @param[in] b The second sample.
+ * @return The p-value, 1 if either sample is empty or all values are equal.
+ */
+double mann_whitney_p(std::vector<double> const &a, std::vector<double> const &b);
+
+#endif // STATISTICS_H
\ No newline at end of file
@@ -0,0 +1,404 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file synthetic.cpp
+ * @brief Implements the generators of synthetic benchmark inputs: image corpora and a tiny classification model.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "synthetic.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include "utils.h"
+
+/**
+ * @brief Parses a comma-separated list (e.g., `jpg,png`).
+ * @param[in] list The list.
+ * @return The non-empty items of the list.
+ */
+std::vector<std::string> split_list(std::string const &list)
+{
+    std::vector<std::string> result;
+
+    std::stringstream ss(list);
+    std::string item;
+    while(std::getline(ss, item, ','))
+    {
+        if(!item.empty())
+            result.push_back(item);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Parses a comma-separated list of resolutions (e.g., `640x480,1920x1080`).
+ * @param[in] list The resolutions as `<size>` (square) or `<width>x<height>`.
+ * @return The resolutions.
+ * @throws std::invalid_argument if a resolution is invalid.
+ */
+std::vector<cv::Size> parse_sizes(std::string const &list)
+{
+    std::vector<cv::Size> result;
+
+    for(auto const &item : split_list(list))
+    {
+        auto const [width, height] = parse_input_size(item);
+        result.emplace_back(static_cast<int>(width), static_cast<int>(height));
+    }
+
+    if(result.empty())
+        throw std::invalid_argument("No resolution in '" + list + "'.");
+
+    return result;
+}
+
+/**
+ * @brief Generates an image with smooth color regions and sensor-like noise, which compresses like a photo.
+ * @param[in] size The resolution of the image.
+ * @param[in,out] rng The random number generator.
+ * @return The BGR image.
+ */
+cv::Mat synthetic_image(cv::Size size, cv::RNG &rng)
+{
+    // Smooth color regions: a coarse random grid upscaled with bicubic interpolation
+    cv::Mat coarse(6, 8, CV_8UC3);
+    rng.fill(coarse, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    cv::Mat image;
+    cv::resize(coarse, image, size, 0, 0, cv::INTER_CUBIC);
+
+    // Sensor-like noise, without it the encoded images are unrealistically small
+    cv::Mat noise(size, CV_16SC3);
+    rng.fill(noise, cv::RNG::NORMAL, cv::Scalar::all(0), cv::Scalar::all(6));
+
+    cv::Mat noisy;
+    image.convertTo(noisy, CV_16SC3);
+    noisy += noise;
+    noisy.convertTo(image, CV_8UC3);
+
+    return image;
+}
+
+/**
+ * @brief Returns the encoder parameters of an image format.
+ * @param[in] format The file extension of the format.
+ * @param[in] quality The JPEG and WebP quality.
+ * @return The parameters for `cv::imwrite`.
+ * @throws std::invalid_argument if the format is unknown.
+ */
+static std::vector<int> encoder_parameters(std::string const &format, int quality)
+{
+    if(format == "jpg" || format == "jpeg")
+        return {cv::IMWRITE_JPEG_QUALITY, quality};
+
+    if(format == "webp")
+        return {cv::IMWRITE_WEBP_QUALITY, quality};
+
+    if(format == "png")
+        return {cv::IMWRITE_PNG_COMPRESSION, 3};
+
+    throw std::invalid_argument("Unknown image format '" + format + "', expected jpg, png or webp.");
+}
+
+/**
+ * @brief Writes a synthetic image corpus.
+ * @details The images are named `<width>x<height>-<index>.<format>`. The directory is created if it does not exist.
+ * @param[in] directory The output directory.
+ * @param[in] options The corpus description.
+ * @return The paths to the written images.
+ * @throws std::runtime_error if an image cannot be encoded or written (e.g., OpenCV is built without WebP).
+ */
+std::vector<std::string> write_corpus(std::string const &directory, corpus_options const &options)
+{
+    std::filesystem::create_directories(directory);
+
+    std::vector<std::string> result;
+    result.reserve(options.count * options.sizes.size() * options.formats.size());
+
+    cv::RNG rng(options.seed);
+
+    for(auto const &format : options.formats)
+    {
+        auto const parameters = encoder_parameters(format, options.quality);
+
+        for(auto const &size : options.sizes)
+        {
+            for(size_t i = 0; i < options.count; ++i)
+            {
+                char name[64];
+                std::snprintf(name, sizeof(name), "%dx%d-%05zu.%s", size.width, size.height, i, format.c_str());
+
+                std::string const path = (std::filesystem::path(directory) / name).string();
+                if(!cv::imwrite(path, synthetic_image(size, rng), parameters))
+                    throw std::runtime_error("Could not write the image '" + path + "'.");
+
+                result.push_back(path);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @class proto_writer
+ * @brief A minimal protocol buffers encoder, enough for the messages of a tiny ONNX model.
+ */
+class proto_writer
+{
+public:
+    /**
+     * @brief Writes an integer field (varint wire type).
+     * @param[in] field The field number.
+     * @param[in] value The value.
+     */
+    void integer(uint32_t field, uint64_t value)
+    {
+        key(field, 0);
+        varint(value);
+    }
+
+    /**
+     * @brief Writes a string or bytes field (length-delimited wire type).
+     * @param[in] field The field number.
+     * @param[in] value The value.
+     */
+    void bytes(uint32_t field, std::string_view value)
+    {
+        key(field, 2);
+        varint(value.size());
+        buffer.append(value);
+    }
+
+    /**
+     * @brief Writes an embedded message field.
+     * @param[in] field The field number.
+     * @param[in] message The encoded message.
+     */
+    void message(uint32_t field, proto_writer const &message)
+    {
+        bytes(field, message.buffer);
+    }
+
+    /**
+     * @brief Returns the encoded message.
+     * @return The bytes of the message.
+     */
+    std::string const &str() const
+    {
+        return buffer;
+    }
+
+private:
+    std::string buffer; ///< The encoded fields.
+
+    /**
+     * @brief Writes a base 128 varint.
+     * @param[in] value The value.
+     */
+    void varint(uint64_t value)
+    {
+        while(value >= 0x80)
+        {
+            buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    /**
+     * @brief Writes the key of a field.
+     * @param[in] field The field number.
+     * @param[in] wire_type The wire type.
+     */
+    void key(uint32_t field, uint32_t wire_type)
+    {
+        varint((static_cast<uint64_t>(field) << 3) | wire_type);
+    }
+};
+
+/// The `TensorProto.DataType` of 32-bit floats.
+static constexpr uint64_t onnx_float = 1;
+
+/// The `AttributeProto.AttributeType` of integers.
+static constexpr uint64_t onnx_attribute_int = 2;
+
+/**
+ * @brief Encodes an `onnx.ValueInfoProto` of a float tensor whose first dimension is the dynamic batch.
+ * @param[in] name The name of the value.
+ * @param[in] dims The fixed dimensions after the batch dimension.
+ * @return The encoded message.
+ */
+static proto_writer batched_value_info(std::string const &name, std::vector<int64_t> const &dims)
+{
+    proto_writer shape;
+
+    proto_writer batch;
+    batch.bytes(2, "batch"); // dim_param
+    shape.message(1, batch);
+
+    for(int64_t d : dims)
+    {
+        proto_writer dim;
+        dim.integer(1, static_cast<uint64_t>(d)); // dim_value
+        shape.message(1, dim);
+    }
+
+    proto_writer tensor;
+    tensor.integer(1, onnx_float); // elem_type
+    tensor.message(2, shape);
+
+    proto_writer type;
+    type.message(1, tensor); // tensor_type
+
+    proto_writer value;
+    value.bytes(1, name);
+    value.message(2, type);
+
+    return value;
+}
+
+/**
+ * @brief Encodes an `onnx.TensorProto` of floats.
+ * @param[in] name The name of the tensor.
+ * @param[in] dims The dimensions.
+ * @param[in] values The values in row-major order.
+ * @return The encoded message.
+ */
+static proto_writer float_tensor(std::string const &name, std::vector<int64_t> const &dims, std::vector<float> const &values)
+{
+    proto_writer tensor;
+
+    for(int64_t d : dims)
+        tensor.integer(1, static_cast<uint64_t>(d));
+
+    tensor.integer(2, onnx_float);
+    tensor.bytes(8, name);
+
+    // raw_data is little-endian, as are the platforms the benchmarks run on
+    std::string raw(values.size() * sizeof(float), '\0');
+    std::memcpy(raw.data(), values.data(), raw.size());
+    tensor.bytes(9, raw);
+
+    return tensor;
+}
+
+/**
+ * @brief Encodes an `onnx.NodeProto`.
+ * @param[in] op_type The operator.
+ * @param[in] inputs The names of the inputs.
+ * @param[in] output The name of the output, also used as the node name.
+ * @param[in] int_attributes The integer attributes as (name, value) pairs.
+ * @return The encoded message.
+ */
+static proto_writer node(std::string const &op_type, std::vector<std::string> const &inputs, std::string const &output, std::vector<std::pair<std::string, int64_t>> const &int_attributes = {})
+{
+    proto_writer result;
+
+    for(auto const &input : inputs)
+        result.bytes(1, input);
+
+    result.bytes(2, output);
+    result.bytes(3, output);
+    result.bytes(4, op_type);
+
+    for(auto const &[name, value] : int_attributes)
+    {
+        proto_writer attribute;
+        attribute.bytes(1, name);
+        attribute.integer(3, static_cast<uint64_t>(value));
+        attribute.integer(20, onnx_attribute_int);
+        result.message(5, attribute);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Writes a tiny ONNX classification model and its class names file.
+ * @details The model has the input `images` of shape `[batch, 3, size, size]` with a dynamic batch dimension
+ *          and the output `output0` of shape `[batch, classes]`, like an exported YOLO classification model.
+ *          The graph is `GlobalAveragePool`, `Flatten`, `Gemm` and `Softmax` (opset 13), so the inference is cheap
+ *          and the benchmarks measure the pipeline around it. The class is decided by the mean color of the image.
+ * @param[in] model_path The path to the ONNX model file.
+ * @param[in] classes_path The path to the class names file.
+ * @param[in] classes The number of classes.
+ * @param[in] size The spatial input size.
+ * @throws std::runtime_error if a file cannot be written.
+ */
+void write_tiny_model(std::string const &model_path, std::string const &classes_path, int classes, int size)
+{
+    if(classes <= 0 || size <= 0)
+        throw std::invalid_argument("The number of classes and the input size must be positive.");
+
+    // Every class responds to its own mix of the mean R, G and B values
+    std::vector<float> weights(3 * static_cast<size_t>(classes));
+    for(int channel = 0; channel < 3; ++channel)
+    {
+        for(int cls = 0; cls < classes; ++cls)
+            weights[static_cast<size_t>(channel * classes + cls)] = 8.0f * std::cos(2.4f * static_cast<float>(cls) + 1.7f * static_cast<float>(channel));
+    }
+    std::vector<float> const bias(static_cast<size_t>(classes), 0.0f);
+
+    proto_writer graph;
+    graph.message(1, node("GlobalAveragePool", {"images"}, "pooled"));
+    graph.message(1, node("Flatten", {"pooled"}, "flat", {{"axis", 1}}));
+    graph.message(1, node("Gemm", {"flat", "weights", "bias"}, "logits"));
+    graph.message(1, node("Softmax", {"logits"}, "output0", {{"axis", 1}}));
+    graph.bytes(2, "yolo-cls-tiny");
+    graph.message(5, float_tensor("weights", {3, classes}, weights));
+    graph.message(5, float_tensor("bias", {classes}, bias));
+    graph.message(11, batched_value_info("images", {3, size, size}));
+    graph.message(12, batched_value_info("output0", {classes}));
+
+    proto_writer opset;
+    opset.bytes(1, "");
+    opset.integer(2, 13);
+
+    proto_writer model;
+    model.integer(1, 8); // ir_version
+    model.bytes(2, "yolo-cls");
+    model.message(7, graph);
+    model.message(8, opset);
+
+    std::ofstream model_file(model_path, std::ios::binary);
+    model_file << model.str();
+    if(!model_file)
+        throw std::runtime_error("Could not write the model '" + model_path + "'.");
+
+    std::ofstream classes_file(classes_path);
+    for(int cls = 0; cls < classes; ++cls)
+        classes_file << "class_" << cls << "\n";
+    if(!classes_file)
+        throw std::runtime_error("Could not write the class names '" + classes_path + "'.");
+}
\ No newline at end of file
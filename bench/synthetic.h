@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file synthetic.h
+ * @brief Declares the generators of synthetic benchmark inputs: image corpora and a tiny classification model.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef SYNTHETIC_H
+#define SYNTHETIC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @struct corpus_options
+ * @brief Describes a synthetic image corpus.
+ */
+struct corpus_options
+{
+    size_t count                     = 100;           ///< The number of images per resolution and format.
+    std::vector<cv::Size> sizes      = {{640, 480}};  ///< The resolutions of the images.
+    std::vector<std::string> formats = {"jpg"};       ///< The file extensions of the formats (`jpg`, `png` or `webp`).
+    int quality                      = 90;            ///< The JPEG and WebP quality.
+    uint64_t seed                    = 1;             ///< The seed of the image content, the same seed gives the same corpus.
+};
+
+/**
+ * @brief Parses a comma-separated list (e.g., `jpg,png`).
+ * @param[in] list The list.
+ * @return The non-empty items of the list.
+ */
+std::vector<std::string> split_list(std::string const &list);
+
+/**
+ * @brief Parses a comma-separated list of resolutions (e.g., `640x480,1920x1080`).
+ * @param[in] list The resolutions as `<size>` (square) or `<width>x<height>`.
+ * @return The resolutions.
+ * @throws std::invalid_argument if a resolution is invalid.
+ */
+std::vector<cv::Size> parse_sizes(std::string const &list);
+
+/**
+ * @brief Generates an image with smooth color regions and sensor-like noise, which compresses like a photo.
+ * @param[in] size The resolution of the image.
+ * @param[in,out] rng The random number generator.
+ * @return The BGR image.
+ */
+cv::Mat synthetic_image(cv::Size size, cv::RNG &rng);
+
+/**
+ * @brief Writes a synthetic image corpus.
+ * @details The images are named `<width>x<height>-<index>.<format>`. The directory is created if it does not exist.
+ * @param[in] directory The output directory.
+ * @param[in] options The corpus description.
+ * @return The paths to the written images.
+ * @throws std::runtime_error if an image cannot be encoded or written (e.g., OpenCV is built without WebP).
+ */
+std::vector<std::string> write_corpus(std::string const &directory, corpus_options const &options);
+
+/**
+ * @brief Writes a tiny ONNX classification model and its class names file.
+ * @details The model has the input `images` of shape `[batch, 3, size, size]` with a dynamic batch dimension
+ *          and the output `output0` of shape `[batch, classes]`, like an exported YOLO classification model.
+ *          The graph is `GlobalAveragePool`, `Flatten`, `Gemm` and `Softmax` (opset 13), so the inference is cheap
+ *          and the benchmarks measure the pipeline around it. The class is decided by the mean color of the image.
+ * @param[in] model_path The path to the ONNX model file.
+ * @param[in] classes_path The path to the class names file.
+ * @param[in] classes The number of classes.
+ * @param[in] size The spatial input size.
+ * @throws std::runtime_error if a file cannot be written.
+ */
+void write_tiny_model(std::string const &model_path, std::string const &classes_path, int classes, int size);
+
+#endif // SYNTHETIC_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file tsqueue.cpp
+ * @brief Microbenchmarks of the thread-safe queue.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "job.h"
+#include "tsqueue.h"
+
+/**
+ * @brief Measures a push followed by a pop of a job on a queue shared by all benchmark threads.
+ * @details Every thread pushes before it pops, so a pop never waits for long,
+ *          and the queue is empty again at the end of every run.
+ * @param[in,out] state The benchmark state.
+ */
+static void bm_tsqueue_push_pop(benchmark::State &state)
+{
+    static tsqueue<job> queue(job_priority_levels);
+    std::string const name = "image-" + std::to_string(state.thread_index()) + ".jpg";
+
+    for(auto _ : state)
+    {
+        job j;
+        j.name = name;
+        queue.push(std::move(j), static_cast<size_t>(job_priority::interactive));
+        auto popped = queue.pop();
+        benchmark::DoNotOptimize(popped);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(bm_tsqueue_push_pop)->ThreadRange(1, 64)->UseRealTime();
+
+/**
+ * @brief Measures a single producer feeding consumer threads that pop batches, as the worker threads do.
+ * @details The arguments are the number of consumer threads and the batch size.
+ *          Every iteration pushes `jobs` jobs, closes the queue and waits for the consumers to drain it.
+ * @param[in,out] state The benchmark state.
+ */
+static void bm_tsqueue_pop_batch(benchmark::State &state)
+{
+    constexpr size_t jobs  = 100000;
+    size_t const consumers = static_cast<size_t>(state.range(0));
+    size_t const batch     = static_cast<size_t>(state.range(1));
+
+    for(auto _ : state)
+    {
+        tsqueue<job> queue(job_priority_levels);
+
+        std::vector<std::thread> threads;
+        threads.reserve(consumers);
+        for(size_t i = 0; i < consumers; ++i)
+        {
+            threads.emplace_back(
+                [&queue, batch]
+                {
+                    for(auto values = queue.pop_batch(batch); !values.empty(); values = queue.pop_batch(batch))
+                        benchmark::DoNotOptimize(values.data());
+                });
+        }
+
+        for(size_t i = 0; i < jobs; ++i)
+        {
+            job j;
+            j.name = "image.jpg";
+            queue.push(std::move(j), static_cast<size_t>(job_priority::interactive));
+        }
+        queue.close();
+
+        for(auto &thread : threads)
+            thread.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(jobs));
+}
+BENCHMARK(bm_tsqueue_pop_batch)->ArgNames({"consumers", "batch"})->ArgsProduct({{1, 2, 4, 8, 16, 32, 64}, {1, 8}})->UseRealTime()->Unit(benchmark::kMillisecond);
\ No newline at end of file
@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file utils.cpp
+ * @brief Microbenchmarks of the command-line helpers.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <array>
+#include <string>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+
+#include "utils.h"
+
+/**
+ * @brief Measures `string_unit_to_numeric` over a mix of units.
+ * @param[in,out] state The benchmark state.
+ */
+static void bm_string_unit_to_numeric(benchmark::State &state)
+{
+    std::array<std::string, 6> const units = {"512", "64kb", "100mb", "2G", "1tb", "15MB"};
+
+    for(auto _ : state)
+    {
+        for(auto const &unit : units)
+            benchmark::DoNotOptimize(string_unit_to_numeric(unit));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(units.size()));
+}
+BENCHMARK(bm_string_unit_to_numeric);
+
+/**
+ * @brief Measures `is_supported_image` over supported and unsupported extensions, as found in a directory walk.
+ * @param[in,out] state The benchmark state.
+ */
+static void bm_is_supported_image(benchmark::State &state)
+{
+    std::array<std::string_view, 8> const extensions = {".jpg", ".JPEG", ".png", ".webp", ".tiff", ".txt", ".json", ""};
+
+    for(auto _ : state)
+    {
+        for(auto extension : extensions)
+            benchmark::DoNotOptimize(is_supported_image(extension));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(extensions.size()));
+}
+BENCHMARK(bm_is_supported_image);
\ No newline at end of file
@@ -0,0 +1,127 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file yolo-cls-corpus.cpp
+ * @brief Writes synthetic image corpora for the end-to-end benchmarks.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "synthetic.h"
+#include "xgetopt/xgetopt.h"
+
+/**
+ * @brief Prints the usage.
+ */
+static void print_usage()
+{
+    std::cout << R"(Usage: yolo-cls-corpus [options] <directory>
+
+Writes a reproducible synthetic image corpus, named <width>x<height>-<index>.<format>.
+
+Options:
+  -n, --count <int>      Number of images per resolution and format. [default: 100]
+  -s, --sizes <list>     Comma-separated resolutions, <size> or <width>x<height>. [default: 640x480]
+  -f, --formats <list>   Comma-separated formats: jpg, png, webp. [default: jpg]
+  -q, --quality <int>    JPEG and WebP quality. [default: 90]
+      --seed <int>       Seed of the image content. [default: 1]
+  -h, --help             Display this help message and exit.
+)";
+}
+
+/// The long-only options.
+enum long_only_option : int
+{
+    option_seed = 256,
+};
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        corpus_options options;
+
+        // clang-format off
+        std::array<xoption, 7> long_options =
+            {{
+                {"count",   xrequired_argument, nullptr, 'n'},
+                {"sizes",   xrequired_argument, nullptr, 's'},
+                {"formats", xrequired_argument, nullptr, 'f'},
+                {"quality", xrequired_argument, nullptr, 'q'},
+                {"seed",    xrequired_argument, nullptr, option_seed},
+                {"help",    xno_argument,       nullptr, 'h'},
+                {0, 0, 0, 0} // Sentinel
+            }};
+        // clang-format on
+
+        while(true)
+        {
+            auto const opt = xgetopt_long(argc, argv, "n:s:f:q:h", long_options.data(), nullptr);
+
+            if(opt == -1)
+                break;
+
+            // clang-format off
+            switch(opt)
+            {
+                case 'n': options.count = std::stoul(xoptarg); break;
+                case 's': options.sizes = parse_sizes(xoptarg); break;
+                case 'f': options.formats = split_list(xoptarg); break;
+                case 'q': options.quality = std::stoi(xoptarg); break;
+                case option_seed: options.seed = std::stoull(xoptarg); break;
+                case 'h': print_usage(); return EXIT_SUCCESS;
+                default: throw std::runtime_error("could not parse parameters, use --help for usage.");
+            }
+            // clang-format on
+        }
+
+        if(argc - xoptind != 1)
+            throw std::runtime_error("expected the output directory, use --help for usage.");
+
+        auto const paths = write_corpus(argv[xoptind], options);
+
+        std::uintmax_t bytes = 0;
+        for(auto const &path : paths)
+            bytes += std::filesystem::file_size(path);
+
+        std::cout << "Wrote " << paths.size() << " images (" << bytes / 1024 << " KiB) to " << argv[xoptind] << std::endl;
+    }
+    catch(std::exception const &e)
+    {
+        std::stringstream ss;
+        ss << "yolo-cls-corpus: " << e.what() << std::endl;
+        std::cerr << ss.str();
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
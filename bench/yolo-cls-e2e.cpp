@@ -0,0 +1,310 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file yolo-cls-e2e.cpp
+ * @brief End-to-end throughput benchmark of the yolo-cls executable over a sweep of worker thread counts.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.h"
+#include "json.h"
+#include "synthetic.h"
+#include "xgetopt/xgetopt.h"
+
+// The executable and the tiny model of the build tree, set by CMake
+#ifndef YOLOCLS_BENCH_EXECUTABLE
+    #define YOLOCLS_BENCH_EXECUTABLE ""
+#endif
+#ifndef YOLOCLS_BENCH_MODEL
+    #define YOLOCLS_BENCH_MODEL ""
+#endif
+#ifndef YOLOCLS_BENCH_CLASSES
+    #define YOLOCLS_BENCH_CLASSES ""
+#endif
+
+/**
+ * @struct e2e_options
+ * @brief The settings of the benchmark.
+ */
+struct e2e_options
+{
+    std::string executable = YOLOCLS_BENCH_EXECUTABLE; ///< The yolo-cls executable.
+    std::string model      = YOLOCLS_BENCH_MODEL;      ///< The ONNX model.
+    std::string classes    = YOLOCLS_BENCH_CLASSES;    ///< The class names file.
+    std::vector<unsigned int> threads;                 ///< The worker thread counts of the sweep.
+    size_t repeat = 3;                                 ///< The number of runs per thread count, the median is reported.
+    size_t top_k  = 5;                                 ///< The number of top predictions to print.
+    std::vector<std::string> extra_arguments;          ///< More arguments of yolo-cls.
+    std::string json_path;                             ///< If not empty, the results are also written here as JSON.
+    std::string corpus;                                ///< The directory of the images.
+};
+
+/**
+ * @struct sweep_result
+ * @brief The median run of a thread count.
+ */
+struct sweep_result
+{
+    unsigned int threads     = 0;   ///< The number of worker threads.
+    process_result run;             ///< The run with the median wall-clock time.
+    double images_per_second = 0.0; ///< The throughput of the run, including the startup.
+};
+
+/**
+ * @brief Prints the usage.
+ */
+static void print_usage()
+{
+    std::cout << R"(Usage: yolo-cls-e2e [options] <corpus directory>
+
+Runs yolo-cls over every image of the corpus (paths piped to the standard input) for every thread count
+and reports images/s, CPU time and peak RSS. The time of every stage of an image is taken from the --stats-json
+of a single-threaded run.
+
+Options:
+  -x, --executable <path>      The yolo-cls executable. [default: the one of the build tree]
+  -m, --model <path>           Path to the ONNX model. [default: the tiny model of the build tree]
+  -c, --classes <path>         Path to the class names file. [default: the tiny model class names]
+  -t, --threads <list>         Comma-separated worker thread counts. [default: powers of two up to the number of hardware cores]
+  -r, --repeat <int>           Runs per thread count, the median is reported. [default: 3]
+  -k, --top-k <int>            Number of top predictions to print. [default: 5]
+  -X, --yolo-cls-arg <arg>     Pass an argument to yolo-cls (e.g., -X -b -X 8). Can be repeated.
+      --json <path>            Also write the results as JSON.
+  -h, --help                   Display this help message and exit.
+)";
+}
+
+/// The long-only options.
+enum long_only_option : int
+{
+    option_json = 256,
+};
+
+/**
+ * @brief Parses the command-line arguments.
+ * @param[in] argc The argument count.
+ * @param[in] argv The argument vector.
+ * @return The settings.
+ * @throws std::runtime_error if the arguments are invalid.
+ */
+static e2e_options parse_e2e_arguments(int argc, char **argv)
+{
+    e2e_options result;
+
+    // clang-format off
+    std::array<xoption, 10> long_options =
+        {{
+            {"executable",   xrequired_argument, nullptr, 'x'},
+            {"model",        xrequired_argument, nullptr, 'm'},
+            {"classes",      xrequired_argument, nullptr, 'c'},
+            {"threads",      xrequired_argument, nullptr, 't'},
+            {"repeat",       xrequired_argument, nullptr, 'r'},
+            {"top-k",        xrequired_argument, nullptr, 'k'},
+            {"yolo-cls-arg", xrequired_argument, nullptr, 'X'},
+            {"json",         xrequired_argument, nullptr, option_json},
+            {"help",         xno_argument,       nullptr, 'h'},
+            {0, 0, 0, 0} // Sentinel
+        }};
+    // clang-format on
+
+    while(true)
+    {
+        auto const opt = xgetopt_long(argc, argv, "x:m:c:t:r:k:X:h", long_options.data(), nullptr);
+
+        if(opt == -1)
+            break;
+
+        // clang-format off
+        switch(opt)
+        {
+            case 'x': result.executable = xoptarg; break;
+            case 'm': result.model = xoptarg; break;
+            case 'c': result.classes = xoptarg; break;
+            case 't': for(auto const &t : split_list(xoptarg)) result.threads.push_back(static_cast<unsigned int>(std::stoul(t))); break;
+            case 'r': result.repeat = std::stoul(xoptarg); break;
+            case 'k': result.top_k = std::stoul(xoptarg); break;
+            case 'X': result.extra_arguments.push_back(xoptarg); break;
+            case option_json: result.json_path = xoptarg; break;
+            case 'h': print_usage(); exit(EXIT_SUCCESS); break;
+            default: throw std::runtime_error("could not parse parameters, use --help for usage.");
+        }
+        // clang-format on
+    }
+
+    if(argc - xoptind != 1)
+        throw std::runtime_error("expected the corpus directory, use --help for usage.");
+    result.corpus = argv[xoptind];
+
+    if(result.executable.empty() || result.model.empty() || result.classes.empty())
+        throw std::runtime_error("the executable, the model and the class names must be set, use --help for usage.");
+
+    if(result.repeat == 0)
+        result.repeat = 1;
+
+    if(result.threads.empty())
+    {
+        unsigned int const cores = std::max(1u, std::thread::hardware_concurrency());
+        for(unsigned int t = 1; t < cores; t *= 2)
+            result.threads.push_back(t);
+        result.threads.push_back(cores);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Converts a duration to seconds.
+ * @param[in] duration The duration.
+ * @return The seconds.
+ */
+static double seconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        auto const options = parse_e2e_arguments(argc, argv);
+
+        auto const paths = list_images(options.corpus);
+        if(paths.empty())
+            throw std::runtime_error("no images in '" + options.corpus + "'.");
+
+        std::string const input = std::accumulate(paths.begin(), paths.end(), std::string(), [](std::string sum, std::string const &path) { return std::move(sum) + path + "\n"; });
+
+        // The command line of yolo-cls, the thread count is appended per run
+        std::vector<std::string> command = {options.executable, "-m", options.model, "-c", options.classes, "-k", std::to_string(options.top_k)};
+        command.insert(command.end(), options.extra_arguments.begin(), options.extra_arguments.end());
+
+        // The time of every stage, as yolo-cls reports it with a single worker thread
+        auto const stages = time_stages(command, input);
+
+        std::cout << "corpus: " << stages.images << " images, " << stages.bytes / 1024 << " KiB, " << options.corpus << "\n\n";
+        std::cout << std::left << std::setw(12) << "stage" << std::right << std::setw(14) << "mean (us)" << std::setw(10) << "share" << "\n";
+
+        auto const per_image = [&](std::chrono::nanoseconds total) { return stages.images == 0 ? 0.0 : std::chrono::duration<double, std::micro>(total).count() / static_cast<double>(stages.images); };
+        auto const all       = std::accumulate(stages.total.begin(), stages.total.end(), std::chrono::nanoseconds(0));
+
+        for(size_t s = 0; s < pipeline_stage_count; ++s)
+        {
+            if(stages.count[s] == 0)
+                continue;
+
+            double const share = all.count() == 0 ? 0.0 : 100.0 * static_cast<double>(stages.total[s].count()) / static_cast<double>(all.count());
+            std::cout << std::left << std::setw(12) << pipeline_stage_name(static_cast<pipeline_stage>(s)) << std::right << std::fixed << std::setprecision(1) << std::setw(14) << per_image(stages.total[s]) << std::setw(9) << share << "%\n";
+        }
+
+        auto const median_run = [&](unsigned int threads, std::string const &run_input)
+        {
+            auto arguments = command;
+            arguments.push_back("-t");
+            arguments.push_back(std::to_string(threads));
+
+            std::vector<process_result> runs;
+            for(size_t r = 0; r < options.repeat; ++r)
+                runs.push_back(run_process(arguments, run_input));
+
+            std::vector<std::chrono::nanoseconds> walls;
+            for(auto const &run : runs)
+                walls.push_back(run.wall);
+
+            auto const wall = median(walls);
+            return *std::find_if(runs.begin(), runs.end(), [&](process_result const &run) { return run.wall == wall; });
+        };
+
+        // Loading the model and starting the threads, without images
+        auto const startup = median_run(1, "");
+
+        std::vector<sweep_result> sweep;
+        for(unsigned int threads : options.threads)
+        {
+            auto const run = median_run(threads, input);
+            if(run.output_lines != paths.size())
+                std::cerr << "yolo-cls-e2e: " << run.output_lines << " of " << paths.size() << " images were classified with " << threads << " threads." << std::endl;
+
+            sweep.push_back({threads, run, static_cast<double>(run.output_lines) / seconds(run.wall)});
+        }
+
+        std::cout << "\n" << std::setw(8) << "threads" << std::setw(12) << "images/s" << std::setw(12) << "wall (s)" << std::setw(12) << "cpu (s)" << std::setw(16) << "peak RSS (MiB)" << "\n";
+        for(auto const &s : sweep)
+        {
+            std::cout << std::setw(8) << s.threads << std::setprecision(1) << std::setw(12) << s.images_per_second << std::setprecision(3) << std::setw(12) << seconds(s.run.wall) << std::setw(12) << seconds(s.run.cpu) << std::setprecision(1) << std::setw(16) << static_cast<double>(s.run.peak_rss_kib) / 1024.0 << "\n";
+        }
+        std::cout << "\nstartup (no images): " << std::setprecision(3) << seconds(startup.wall) << " s, peak RSS " << std::setprecision(1) << static_cast<double>(startup.peak_rss_kib) / 1024.0 << " MiB" << std::endl;
+
+        if(!options.json_path.empty())
+        {
+            std::ofstream json(options.json_path);
+            json << std::setprecision(6) << "{\n";
+            json << "  \"corpus\": {\"path\": " << json_quote(options.corpus) << ", \"images\": " << stages.images << ", \"bytes\": " << stages.bytes << "},\n";
+            json << "  \"model\": " << json_quote(options.model) << ",\n";
+            json << "  \"stages_us\": {";
+            bool first = true;
+            for(size_t s = 0; s < pipeline_stage_count; ++s)
+            {
+                if(stages.count[s] == 0)
+                    continue;
+
+                json << (first ? "" : ", ") << json_quote(pipeline_stage_name(static_cast<pipeline_stage>(s))) << ": " << per_image(stages.total[s]);
+                first = false;
+            }
+            json << "},\n";
+            json << "  \"startup\": {\"wall_s\": " << seconds(startup.wall) << ", \"peak_rss_kib\": " << startup.peak_rss_kib << "},\n";
+            json << "  \"runs\": [\n";
+            for(size_t i = 0; i < sweep.size(); ++i)
+            {
+                auto const &s = sweep[i];
+                json << "    {\"threads\": " << s.threads << ", \"images\": " << s.run.output_lines << ", \"images_per_s\": " << s.images_per_second << ", \"wall_s\": " << seconds(s.run.wall) << ", \"cpu_s\": " << seconds(s.run.cpu) << ", \"peak_rss_kib\": " << s.run.peak_rss_kib << "}" << (i + 1 == sweep.size() ? "\n" : ",\n");
+            }
+            json << "  ]\n}\n";
+
+            if(!json)
+                throw std::runtime_error("could not write '" + options.json_path + "'.");
+        }
+    }
+    catch(std::exception const &e)
+    {
+        std::stringstream ss;
+        ss << "yolo-cls-e2e: " << e.what() << std::endl;
+        std::cerr << ss.str();
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,522 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file yolo-cls-perf.cpp
+ * @brief Performance regression gate: times the pipeline stages, post-processing, queue and end-to-end paths and compares them with a stored baseline.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "harness.h"
+#include "json.h"
+#include "job.h"
+#include "statistics.h"
+#include "synthetic.h"
+#include "tsqueue.h"
+#include "yolo.h"
+#include "xgetopt/xgetopt.h"
+
+// The executable and the tiny model of the build tree, set by CMake
+#ifndef YOLOCLS_BENCH_EXECUTABLE
+    #define YOLOCLS_BENCH_EXECUTABLE ""
+#endif
+#ifndef YOLOCLS_BENCH_MODEL
+    #define YOLOCLS_BENCH_MODEL ""
+#endif
+#ifndef YOLOCLS_BENCH_CLASSES
+    #define YOLOCLS_BENCH_CLASSES ""
+#endif
+
+/// The version of the baseline file format.
+static constexpr int baseline_version = 1;
+
+/**
+ * @struct perf_options
+ * @brief The settings of the gate.
+ */
+struct perf_options
+{
+    std::string executable = YOLOCLS_BENCH_EXECUTABLE; ///< The yolo-cls executable.
+    std::string model      = YOLOCLS_BENCH_MODEL;      ///< The ONNX model.
+    std::string classes    = YOLOCLS_BENCH_CLASSES;    ///< The class names file.
+    std::string baseline;                              ///< The baseline file.
+    bool write_baseline = false;                       ///< If true, the baseline is recorded instead of compared.
+    std::string work_dir = "yolo-cls-perf";            ///< The directory of the synthetic corpus.
+    size_t samples       = 15;                         ///< The number of samples of every metric.
+    double alpha         = 0.01;                       ///< The significance level of the Mann-Whitney test.
+    double tolerance     = 0.10;                       ///< The accepted relative slowdown of a median.
+    unsigned int threads = 2;                          ///< The worker threads of the end-to-end runs.
+};
+
+/**
+ * @struct metric
+ * @brief The samples of a measured quantity, lower is better.
+ */
+struct metric
+{
+    std::string name;            ///< The name (e.g., `stage.decode`).
+    std::string unit;            ///< The unit of the samples (e.g., `us`).
+    std::vector<double> samples; ///< The samples, one per round.
+};
+
+/**
+ * @brief Prints the usage.
+ */
+static void print_usage()
+{
+    std::cout << R"(Usage: yolo-cls-perf [options] --baseline <path>
+
+Measures the pipeline stages of an image (from the --stats-json of a single-threaded yolo-cls run),
+the post-processing, the input queue and end-to-end runs of yolo-cls on a small synthetic corpus.
+Every metric is sampled repeatedly and compared with the baseline: a metric regresses if the
+Mann-Whitney test rejects equality and the median is slower by more than the tolerance.
+
+Exit status: 0 if no metric regressed, 1 on a regression, a missing baseline or an error.
+
+Options:
+      --baseline <path>        The baseline file (JSON).
+      --write-baseline         Record the baseline instead of comparing with it.
+      --work-dir <path>        Directory for the synthetic corpus. [default: yolo-cls-perf]
+  -n, --samples <int>          Samples of every metric. [default: 15]
+      --alpha <float>          Significance level of the Mann-Whitney test. [default: 0.01]
+      --tolerance <float>      Accepted relative slowdown of a median. [default: 0.10]
+  -t, --threads <int>          Worker threads of the end-to-end runs. [default: 2]
+  -x, --executable <path>      The yolo-cls executable. [default: the one of the build tree]
+  -m, --model <path>           Path to the ONNX model. [default: the tiny model of the build tree]
+  -c, --classes <path>         Path to the class names file. [default: the tiny model class names]
+  -h, --help                   Display this help message and exit.
+)";
+}
+
+/// The long-only options.
+enum long_only_option : int
+{
+    option_baseline = 256,
+    option_write_baseline,
+    option_work_dir,
+    option_alpha,
+    option_tolerance,
+};
+
+/**
+ * @brief Parses the command-line arguments.
+ * @param[in] argc The argument count.
+ * @param[in] argv The argument vector.
+ * @return The settings.
+ * @throws std::runtime_error if the arguments are invalid.
+ */
+static perf_options parse_perf_arguments(int argc, char **argv)
+{
+    perf_options result;
+
+    // clang-format off
+    std::array<xoption, 12> long_options =
+        {{
+            {"baseline",       xrequired_argument, nullptr, option_baseline},
+            {"write-baseline", xno_argument,       nullptr, option_write_baseline},
+            {"work-dir",       xrequired_argument, nullptr, option_work_dir},
+            {"samples",        xrequired_argument, nullptr, 'n'},
+            {"alpha",          xrequired_argument, nullptr, option_alpha},
+            {"tolerance",      xrequired_argument, nullptr, option_tolerance},
+            {"threads",        xrequired_argument, nullptr, 't'},
+            {"executable",     xrequired_argument, nullptr, 'x'},
+            {"model",          xrequired_argument, nullptr, 'm'},
+            {"classes",        xrequired_argument, nullptr, 'c'},
+            {"help",           xno_argument,       nullptr, 'h'},
+            {0, 0, 0, 0} // Sentinel
+        }};
+    // clang-format on
+
+    while(true)
+    {
+        auto const opt = xgetopt_long(argc, argv, "n:t:x:m:c:h", long_options.data(), nullptr);
+
+        if(opt == -1)
+            break;
+
+        // clang-format off
+        switch(opt)
+        {
+            case option_baseline: result.baseline = xoptarg; break;
+            case option_write_baseline: result.write_baseline = true; break;
+            case option_work_dir: result.work_dir = xoptarg; break;
+            case 'n': result.samples = std::stoul(xoptarg); break;
+            case option_alpha: result.alpha = std::stod(xoptarg); break;
+            case option_tolerance: result.tolerance = std::stod(xoptarg); break;
+            case 't': result.threads = static_cast<unsigned int>(std::stoul(xoptarg)); break;
+            case 'x': result.executable = xoptarg; break;
+            case 'm': result.model = xoptarg; break;
+            case 'c': result.classes = xoptarg; break;
+            case 'h': print_usage(); exit(EXIT_SUCCESS); break;
+            default: throw std::runtime_error("could not parse parameters, use --help for usage.");
+        }
+        // clang-format on
+    }
+
+    if(result.baseline.empty())
+        throw std::runtime_error("the baseline file must be set, use --help for usage.");
+
+    if(result.executable.empty() || result.model.empty() || result.classes.empty())
+        throw std::runtime_error("the executable, the model and the class names must be set, use --help for usage.");
+
+    // The normal approximation of the test needs enough samples
+    if(result.samples < 8)
+        throw std::runtime_error("at least 8 samples are needed.");
+
+    if(result.threads == 0)
+        result.threads = 1;
+
+    return result;
+}
+
+/**
+ * @brief Measures the post-processing of the scores of a single image: the copy, `softmax_scores` and `top_k_scores`.
+ * @param[in] logits The raw scores.
+ * @param[in] iterations The number of repetitions.
+ * @return The mean time of a single image in microseconds.
+ */
+static double measure_postprocess(std::vector<float> const &logits, size_t iterations)
+{
+    auto const start = std::chrono::steady_clock::now();
+
+    size_t checksum = 0;
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        std::vector<float> scores = logits;
+        softmax_scores(scores);
+        checksum += static_cast<size_t>(top_k_scores(scores, 5).front().first);
+    }
+
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    // Keeps the loop from being optimized away
+    if(checksum == static_cast<size_t>(-1))
+        std::cerr << checksum;
+
+    return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+}
+
+/**
+ * @brief Measures the input queue: a producer pushes jobs that consumer threads pop in batches, as the worker threads do.
+ * @return The mean time per job in microseconds.
+ */
+static double measure_queue()
+{
+    constexpr size_t jobs      = 20000;
+    constexpr size_t consumers = 4;
+    constexpr size_t batch     = 8;
+
+    tsqueue<job> queue(job_priority_levels);
+
+    auto const start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for(size_t i = 0; i < consumers; ++i)
+    {
+        threads.emplace_back(
+            [&queue]
+            {
+                while(!queue.pop_batch(batch).empty())
+                {
+                }
+            });
+    }
+
+    for(size_t i = 0; i < jobs; ++i)
+    {
+        job j;
+        j.name = "image.jpg";
+        queue.push(std::move(j), static_cast<size_t>(job_priority::interactive));
+    }
+    queue.close();
+
+    for(auto &thread : threads)
+        thread.join();
+
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(jobs);
+}
+
+/**
+ * @brief Measures every metric `samples` times.
+ * @details The metrics are sampled round-robin, so that a slow phase of the machine affects all of them alike.
+ *          One round is run first and discarded to warm up the page cache.
+ * @param[in] options The settings.
+ * @param[in] paths The images of the corpus.
+ * @return The metrics.
+ */
+static std::vector<metric> measure(perf_options const &options, std::vector<std::string> const &paths)
+{
+    std::vector<metric> result;
+
+    // A stage is a metric once yolo-cls reports it
+    auto record = [&](std::string const &name, std::string const &unit, double value)
+    {
+        auto m = std::find_if(result.begin(), result.end(), [&](metric const &r) { return r.name == name; });
+        if(m == result.end())
+            m = result.insert(result.end(), {name, unit, {}});
+
+        m->samples.push_back(value);
+    };
+
+    // Scores of ImageNet-1k and ImageNet-21k sized models
+    std::mt19937 generator(42);
+    std::normal_distribution<float> distribution(0.0f, 4.0f);
+    std::vector<float> logits_1k(1000), logits_21k(21843);
+    for(float &score : logits_1k)
+        score = distribution(generator);
+    for(float &score : logits_21k)
+        score = distribution(generator);
+
+    std::string const input = std::accumulate(paths.begin(), paths.end(), std::string(), [](std::string sum, std::string const &path) { return std::move(sum) + path + "\n"; });
+    std::vector<std::string> const command = {options.executable, "-m", options.model, "-c", options.classes};
+
+    auto threaded = command;
+    threaded.insert(threaded.end(), {"-t", std::to_string(options.threads)});
+
+    for(size_t round = 0; round <= options.samples; ++round)
+    {
+        // The stages of single-threaded yolo-cls, as its --stats-json reports them
+        auto const stages = time_stages(command, input);
+        if(stages.images != paths.size())
+            throw std::runtime_error(std::to_string(stages.images) + " of " + std::to_string(paths.size()) + " images were classified by yolo-cls.");
+
+        for(size_t s = 0; s < pipeline_stage_count; ++s)
+        {
+            if(stages.count[s] != 0)
+                record(std::string("stage.") + pipeline_stage_name(static_cast<pipeline_stage>(s)), "us", std::chrono::duration<double, std::micro>(stages.total[s]).count() / static_cast<double>(stages.images));
+        }
+
+        record("postprocess.1k", "us", measure_postprocess(logits_1k, 2000));
+        record("postprocess.21k", "us", measure_postprocess(logits_21k, 200));
+        record("queue.pop_batch", "us", measure_queue());
+
+        auto const run = run_process(threaded, input);
+        if(run.output_lines != paths.size())
+            throw std::runtime_error(std::to_string(run.output_lines) + " of " + std::to_string(paths.size()) + " images were classified by yolo-cls.");
+        record("e2e.wall", "ms", std::chrono::duration<double, std::milli>(run.wall).count());
+
+        // The first round warms up
+        if(round == 0)
+        {
+            for(auto &m : result)
+                m.samples.clear();
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Writes the metrics as a baseline file.
+ * @param[in] path The path to the baseline file.
+ * @param[in] metrics The metrics.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+static void write_baseline(std::string const &path, std::vector<metric> const &metrics)
+{
+    std::ofstream file(path);
+    file << std::setprecision(6);
+    file << "{\n";
+    file << "  \"version\": " << baseline_version << ",\n";
+    file << "  \"metrics\": {\n";
+
+    for(size_t i = 0; i < metrics.size(); ++i)
+    {
+        auto const &m = metrics[i];
+
+        file << "    " << json_quote(m.name) << ": {\"unit\": " << json_quote(m.unit) << ", \"median\": " << median(m.samples) << ", \"samples\": [";
+        for(size_t j = 0; j < m.samples.size(); ++j)
+            file << (j == 0 ? "" : ", ") << m.samples[j];
+        file << "]}" << (i + 1 == metrics.size() ? "\n" : ",\n");
+    }
+
+    file << "  }\n";
+    file << "}\n";
+
+    if(!file)
+        throw std::runtime_error("could not write the baseline '" + path + "'.");
+}
+
+/**
+ * @brief Reads the metrics of a baseline file.
+ * @param[in] path The path to the baseline file.
+ * @return The metrics.
+ * @throws std::runtime_error if the file cannot be read or has another format.
+ */
+static std::vector<metric> read_baseline(std::string const &path)
+{
+    std::ifstream file(path);
+    std::stringstream ss;
+    ss << file.rdbuf();
+
+    if(!file)
+        throw std::runtime_error("could not read the baseline '" + path + "'.");
+
+    auto const root = parse_json(ss.str());
+    if(root.at("version").number != baseline_version)
+        throw std::runtime_error("the baseline '" + path + "' has another format version, record it again.");
+
+    std::vector<metric> result;
+
+    auto const &metrics = root.at("metrics");
+    for(size_t i = 0; i < metrics.keys.size(); ++i)
+    {
+        metric m {metrics.keys[i], metrics.items[i].at("unit").string, {}};
+        for(auto const &sample : metrics.items[i].at("samples").items)
+            m.samples.push_back(sample.number);
+
+        result.push_back(std::move(m));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Compares the metrics with the baseline and prints the report.
+ * @param[in] options The settings.
+ * @param[in] current The measured metrics.
+ * @param[in] baseline The baseline metrics.
+ * @return True if any metric regressed.
+ */
+static bool compare(perf_options const &options, std::vector<metric> const &current, std::vector<metric> const &baseline)
+{
+    std::vector<std::string> regressed;
+    std::vector<std::string> regressed_stages;
+
+    std::cout << std::left << std::setw(18) << "metric" << std::setw(6) << "unit" << std::right << std::setw(12) << "baseline" << std::setw(12) << "current" << std::setw(10) << "change" << std::setw(10) << "p" << "  verdict\n";
+
+    for(auto const &m : current)
+    {
+        double const now = median(m.samples);
+
+        auto const base = std::find_if(baseline.begin(), baseline.end(), [&](metric const &b) { return b.name == m.name; });
+        if(base == baseline.end() || base->samples.empty() || base->unit != m.unit)
+        {
+            std::cout << std::left << std::setw(18) << m.name << std::setw(6) << m.unit << std::right << std::setw(12) << "-" << std::fixed << std::setprecision(2) << std::setw(12) << now << std::setw(10) << "-" << std::setw(10) << "-" << "  new\n";
+            continue;
+        }
+
+        double const before = median(base->samples);
+        double const change = before == 0.0 ? 0.0 : now / before - 1.0;
+        double const p      = mann_whitney_p(base->samples, m.samples);
+
+        std::stringstream percent;
+        percent << std::showpos << std::fixed << std::setprecision(1) << change * 100.0 << "%";
+
+        // A change counts if it is both statistically significant and larger than the tolerance
+        std::string verdict = "ok";
+        if(p < options.alpha && change > options.tolerance)
+        {
+            verdict = "REGRESSED";
+            regressed.push_back(m.name);
+
+            if(m.name.rfind("stage.", 0) == 0)
+                regressed_stages.push_back(m.name.substr(6) + " (" + percent.str() + ")");
+        }
+        else if(p < options.alpha && change < -options.tolerance)
+        {
+            verdict = "faster";
+        }
+
+        std::cout << std::left << std::setw(18) << m.name << std::setw(6) << m.unit << std::right << std::fixed << std::setprecision(2) << std::setw(12) << before << std::setw(12) << now << std::setw(10) << percent.str() << std::setprecision(4) << std::setw(10) << p << "  " << verdict << "\n";
+    }
+
+    std::cout << "\n";
+
+    if(regressed.empty())
+    {
+        std::cout << std::defaultfloat << "No regression (alpha " << options.alpha << ", tolerance " << options.tolerance * 100.0 << "%)." << std::endl;
+        return false;
+    }
+
+    // Point out the stages that explain a slower pipeline
+    if(!regressed_stages.empty())
+    {
+        std::cout << "Regressed stages:";
+        for(auto const &s : regressed_stages)
+            std::cout << " " << s;
+        std::cout << "\n";
+    }
+    else if(std::find(regressed.begin(), regressed.end(), "e2e.wall") != regressed.end())
+    {
+        std::cout << "The end-to-end time regressed, but no stage of a single image did: look at the threading (thread_classify, tsqueue) and the startup.\n";
+    }
+
+    std::cout << regressed.size() << " metric(s) regressed." << std::endl;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        auto const options = parse_perf_arguments(argc, argv);
+
+        // A gate without a baseline would pass every run, so it fails until one is recorded
+        if(!options.write_baseline && !std::filesystem::exists(options.baseline))
+        {
+            std::cerr << "yolo-cls-perf: there is no baseline '" << options.baseline << "', record one with --write-baseline (make perf-baseline) on the reference machine." << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // A small corpus: 8 images per format at VGA resolution
+        corpus_options corpus;
+        corpus.count   = 8;
+        corpus.formats = {"jpg", "png", "webp"};
+
+        auto const paths = write_corpus((std::filesystem::path(options.work_dir) / "corpus").string(), corpus);
+
+        auto const metrics = measure(options, paths);
+
+        if(options.write_baseline)
+        {
+            write_baseline(options.baseline, metrics);
+            std::cout << "Wrote the baseline of " << metrics.size() << " metrics to " << options.baseline << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        return compare(options, metrics, read_baseline(options.baseline)) ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    catch(std::exception const &e)
+    {
+        std::stringstream ss;
+        ss << "yolo-cls-perf: " << e.what() << std::endl;
+        std::cerr << ss.str();
+
+        return EXIT_FAILURE;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file yolo-cls-tiny-model.cpp
+ * @brief Writes the tiny ONNX classification model of the end-to-end benchmarks.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "synthetic.h"
+#include "xgetopt/xgetopt.h"
+
+/**
+ * @brief Prints the usage.
+ */
+static void print_usage()
+{
+    std::cout << R"(Usage: yolo-cls-tiny-model [options] <model.onnx> <classes.txt>
+
+Writes a tiny ONNX classification model (GlobalAveragePool, Flatten, Gemm, Softmax)
+with a dynamic batch dimension and its class names file.
+
+Options:
+  -n, --classes <int>    Number of classes. [default: 10]
+  -s, --size <int>       Spatial input size. [default: 224]
+  -h, --help             Display this help message and exit.
+)";
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        int classes = 10;
+        int size    = 224;
+
+        // clang-format off
+        std::array<xoption, 4> long_options =
+            {{
+                {"classes", xrequired_argument, nullptr, 'n'},
+                {"size",    xrequired_argument, nullptr, 's'},
+                {"help",    xno_argument,       nullptr, 'h'},
+                {0, 0, 0, 0} // Sentinel
+            }};
+        // clang-format on
+
+        while(true)
+        {
+            auto const opt = xgetopt_long(argc, argv, "n:s:h", long_options.data(), nullptr);
+
+            if(opt == -1)
+                break;
+
+            // clang-format off
+            switch(opt)
+            {
+                case 'n': classes = std::stoi(xoptarg); break;
+                case 's': size = std::stoi(xoptarg); break;
+                case 'h': print_usage(); return EXIT_SUCCESS;
+                default: throw std::runtime_error("could not parse parameters, use --help for usage.");
+            }
+            // clang-format on
+        }
+
+        if(argc - xoptind != 2)
+            throw std::runtime_error("expected the model and the class names paths, use --help for usage.");
+
+        write_tiny_model(argv[xoptind], argv[xoptind + 1], classes, size);
+    }
+    catch(std::exception const &e)
+    {
+        std::stringstream ss;
+        ss << "yolo-cls-tiny-model: " << e.what() << std::endl;
+        std::cerr << ss.str();
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file admission.cpp
+ * @brief Defines the latency-SLO admission control of the daemon.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "admission.h"
+
+#include <algorithm>
+
+/**
+ * @brief Constructs the admission control of a queue.
+ * @param tsq_in The thread-safe input queue of the worker threads.
+ * @param stats The statistics of the worker threads.
+ * @param[in] can_downgrade True if the classifier has a cascade to downgrade to its first stage.
+ * @param[in] c The application configuration.
+ */
+admission_control::admission_control(tsqueue<job> &tsq_in, serving_stats &stats, bool can_downgrade, configuration const &c) : tsq_in(tsq_in), stats(stats), can_downgrade(can_downgrade), c(c)
+{
+}
+
+/**
+ * @brief Queues a job for the worker threads, or answers it with `job_status::busy`.
+ * @param[in] request The job. `job::reply` must be set.
+ * @return False if the job was rejected.
+ */
+bool admission_control::submit(job request)
+{
+    if(c.slo.count() > 0)
+    {
+        auto const latency = estimate(request.priority);
+
+        if(latency > c.slo)
+        {
+            if(can_downgrade && c.slo_downgrade && request.priority == job_priority::interactive)
+            {
+                request.downgraded = true;
+                ++stats.downgraded;
+            }
+            else
+            {
+                ++stats.rejected;
+                request.reply(job_status::busy, "could not process the file '" + request.name + "': Busy, the estimated latency of " + std::to_string(latency.count() / 1000) + "ms exceeds the SLO.");
+                return false;
+            }
+        }
+    }
+
+    size_t const level = static_cast<size_t>(request.priority);
+    tsq_in.push(std::move(request), level);
+
+    return true;
+}
+
+/**
+ * @brief Estimates the latency of a job queued now.
+ * @param[in] priority The priority class of the job.
+ * @return The estimated time until the job is classified, 0 before the first batch has run.
+ */
+std::chrono::microseconds admission_control::estimate(job_priority priority) const
+{
+    uint64_t const capacity = std::max<uint64_t>(1, static_cast<uint64_t>(c.batch_size) * c.threads);
+    uint64_t const ahead    = tsq_in.size(static_cast<size_t>(priority));
+
+    // The batches that run before the job, and its own batch
+    uint64_t rounds = ahead / capacity + 1;
+
+    // With every worker thread busy the job also waits for a running batch
+    if(stats.busy_workers.load(std::memory_order_relaxed) >= c.threads)
+        ++rounds;
+
+    return stats.compute_estimate() * static_cast<int64_t>(rounds);
+}
\ No newline at end of file
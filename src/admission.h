@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file admission.h
+ * @brief Defines the latency-SLO admission control of the daemon.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "utils.h"
+#include "stats.h"
+
+#include <chrono>
+
+/**
+ * @class admission_control
+ * @brief Queues the jobs of the daemon, rejecting or downgrading them when the latency SLO would be violated.
+ *
+ * The latency of a new job is estimated from the jobs queued ahead of it (same or higher priority),
+ * the busy worker threads and the moving average of the batch inference time.
+ * Over `configuration::slo`, an interactive job is downgraded to the first stage of the cascade
+ * if `configuration::slo_downgrade` is set, any other job is answered with `job_status::busy` right away.
+ */
+class admission_control
+{
+public:
+    /**
+     * @brief Constructs the admission control of a queue.
+     * @param tsq_in The thread-safe input queue of the worker threads.
+     * @param stats The statistics of the worker threads.
+     * @param[in] can_downgrade True if the classifier has a cascade to downgrade to its first stage.
+     * @param[in] c The application configuration.
+     */
+    admission_control(tsqueue<job> &tsq_in, serving_stats &stats, bool can_downgrade, configuration const &c);
+
+    /**
+     * @brief Queues a job for the worker threads, or answers it with `job_status::busy`.
+     * @param[in] request The job. `job::reply` must be set.
+     * @return False if the job was rejected.
+     */
+    bool submit(job request);
+
+    /**
+     * @brief Estimates the latency of a job queued now.
+     * @param[in] priority The priority class of the job.
+     * @return The estimated time until the job is classified, 0 before the first batch has run.
+     */
+    std::chrono::microseconds estimate(job_priority priority) const;
+
+private:
+    tsqueue<job> &tsq_in;       ///< The input queue of the worker threads.
+    serving_stats &stats;       ///< The statistics of the worker threads.
+    bool can_downgrade = false; ///< True if jobs can be downgraded.
+    configuration const &c;     ///< The application configuration.
+};
+
+#endif // ADMISSION_H
\ No newline at end of file
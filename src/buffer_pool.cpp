@@ -20,57 +20,56 @@
  * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
 */
 /**
- * @file tsqueue.cpp
- * @brief Defines a simple thread-safe queue.
+ * @file buffer_pool.cpp
+ * @brief Implements a bounded pool of reusable byte buffers for images read from a stream.
  * @author Savelii Pototskii
- * @date 2025-08-16
+ * @date 2026-10-16
  * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
  * @copyright SPDX-License-Identifier: GPL-3.0-or-later
 */
-#include "tsqueue.h"
+#include "buffer_pool.h"
+
+#include <algorithm>
 
 /**
- * @brief Pushes a string onto the queue in a thread-safe manner.
- * @param[in] value The string to push.
+ * @brief Constructs an empty pool.
+ * @param[in] max_buffers The maximum number of buffers acquired at the same time.
  */
-void tsqueue::push(std::string const &value)
-{
-    {
-        std::lock_guard<std::mutex> lock(mutex);
-        queue.push(value);
-    }
-    cv.notify_one();
-}
+buffer_pool::buffer_pool(size_t max_buffers) : max_buffers(std::max<size_t>(max_buffers, 1)) {}
 
 /**
- * @brief Pops a string from the queue. This operation is blocking.
-          It will wait until an item is available or until the queue is closed.
- * @return An `std::optional<std::string>` containing the value if one was popped, or `std::nullopt` if the queue is empty and has been closed.
+ * @brief Takes an empty buffer from the pool, waiting while `max_buffers` buffers are acquired. This operation is blocking.
+ * @return The buffer. It may have the capacity of a previous image.
  */
-std::optional<std::string> tsqueue::pop()
+std::vector<uchar> buffer_pool::acquire()
 {
     std::unique_lock<std::mutex> lock(mutex);
-    cv.wait(lock, [this] { return !queue.empty() || done; });
+    cv.wait(lock, [this] { return acquired < max_buffers; });
 
-    if(queue.empty())
-    {
-        return std::nullopt;
-    }
+    ++acquired;
+
+    if(buffers.empty())
+        return {};
 
-    std::string value = std::move(queue.front());
-    queue.pop();
-    return value;
+    std::vector<uchar> buffer = std::move(buffers.back());
+    buffers.pop_back();
+
+    return buffer;
 }
 
 /**
- * @brief Closes the queue, signaling that no more items will be pushed. This will unblock any threads waiting on `pop()`.
+ * @brief Returns a buffer to the pool.
+ * @param[in] buffer The buffer.
  */
-void tsqueue::close()
+void buffer_pool::release(std::vector<uchar> &&buffer)
 {
+    buffer.clear();
+
     {
         std::lock_guard<std::mutex> lock(mutex);
-        done = true;
+        buffers.push_back(std::move(buffer));
+        --acquired;
     }
 
-    cv.notify_all();
+    cv.notify_one();
 }
\ No newline at end of file
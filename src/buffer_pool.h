@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file buffer_pool.h
+ * @brief Defines a bounded pool of reusable byte buffers for images read from a stream.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class buffer_pool
+ * @brief A thread-safe pool of byte buffers that keeps their capacity between images.
+ *
+ * The reader of a stream acquires a buffer per image and the worker thread releases it once the image is decoded,
+ * so a steady stream of images runs without allocations. The number of acquired buffers is bounded,
+ * which also stops the reader from queueing more images than the worker threads can keep up with.
+ */
+class buffer_pool
+{
+public:
+    /**
+     * @brief Constructs an empty pool.
+     * @param[in] max_buffers The maximum number of buffers acquired at the same time.
+     */
+    explicit buffer_pool(size_t max_buffers);
+
+    /**
+     * @brief Takes an empty buffer from the pool, waiting while `max_buffers` buffers are acquired. This operation is blocking.
+     * @return The buffer. It may have the capacity of a previous image.
+     */
+    std::vector<uchar> acquire();
+
+    /**
+     * @brief Returns a buffer to the pool.
+     * @param[in] buffer The buffer.
+     */
+    void release(std::vector<uchar> &&buffer);
+
+private:
+    std::vector<std::vector<uchar>> buffers; ///< The free buffers.
+    size_t max_buffers = 1;                  ///< The maximum number of acquired buffers.
+    size_t acquired    = 0;                  ///< The number of acquired buffers.
+    std::mutex mutex;                        ///< Mutex to protect access to the buffers.
+    std::condition_variable cv;              ///< Signals that a buffer has been released.
+};
+
+#endif // BUFFER_POOL_H
\ No newline at end of file
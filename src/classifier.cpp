@@ -0,0 +1,321 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file classifier.cpp
+ * @brief Defines the classifier that fans an image out to several models, each optionally a confidence-gated cascade.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "classifier.h"
+
+#include <algorithm>
+#include <iterator>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @brief Constructs a classifier with a single model.
+ * @param[in] model The initialized model.
+ */
+classifier::classifier(yolo &&model)
+{
+    add_head("", std::move(model));
+}
+
+/**
+ * @brief Adds a head with a single model.
+ * @param[in] name The name of the head used to label its predictions (e.g., the model file stem).
+ * @param[in] model The initialized model.
+ */
+void classifier::add_head(std::string const &name, yolo &&model)
+{
+    heads.push_back({name, {}});
+    add_stage(name, std::move(model), 0.0f);
+}
+
+/**
+ * @brief Appends a stage to the cascade of the last head. Creates the head if there is none.
+ * @param[in] name The name of the stage used in the report (e.g., the model file name).
+ * @param[in] model The initialized model. It should apply softmax so that the threshold is a probability.
+ * @param[in] threshold The minimum top-1 confidence to accept the stage result. Ignored for the last stage.
+ */
+void classifier::add_stage(std::string const &name, yolo &&model, float threshold)
+{
+    if(heads.empty())
+        heads.push_back({"", {}});
+
+    auto s       = std::make_unique<stage>();
+    s->name      = name;
+    s->model     = std::move(model);
+    s->threshold = threshold;
+
+    heads.back().stages.push_back(std::move(s));
+}
+
+/**
+ * @brief Classifies an image with every head.
+ * @param[in] image The decoded image.
+ * @param[in] top_k The number of top predictions to return per head.
+ * @return One vector of `prediction` structs per head, sorted by confidence in descending order.
+ * @throws std::runtime_error if the classifier has no heads.
+ */
+classification classifier::predict(cv::Mat const &image, size_t top_k)
+{
+    return predict_batch({image}, top_k).front();
+}
+
+/**
+ * @brief Classifies several images with every head.
+ * @details Every stage classifies all images that reach it in a single `yolo::predict_batch` call.
+ *          Preprocessed input tensors (see `yolo::is_input_tensor`) are passed to the models as they are.
+ * @param[in] images The decoded images.
+ * @param[in] top_k The number of top predictions to return per head.
+ * @param[in] first_stage_only Per image, if true, the first stage of a cascade accepts the image regardless of the threshold.
+ *            May be empty.
+ * @return One `classification` per image.
+ * @throws std::runtime_error if the classifier has no heads.
+ */
+std::vector<classification> classifier::predict_batch(std::vector<cv::Mat> const &images, size_t top_k, std::vector<bool> const &first_stage_only)
+{
+    if(heads.empty())
+        throw std::runtime_error("The classifier has no models.");
+
+    // Every image resized once per distinct model input size
+    std::vector<std::vector<std::pair<cv::Size, cv::Mat>>> resized(images.size());
+
+    auto resized_for = [&](yolo const &model, std::vector<size_t> const &indices)
+    {
+        cv::Size const size = model.input_size();
+
+        std::vector<cv::Mat> batch;
+        batch.reserve(indices.size());
+
+        for(size_t index : indices)
+        {
+            if(model.is_input_tensor(images[index]))
+            {
+                batch.push_back(images[index]);
+                continue;
+            }
+
+            auto &cache = resized[index];
+            auto it     = std::find_if(cache.begin(), cache.end(), [&size](auto const &r) { return r.first == size; });
+
+            if(it == cache.end())
+            {
+                cv::Mat r;
+                if(images[index].size() == size)
+                    r = images[index];
+                else
+                {
+                    stage_scope scope(pipeline_stage::preprocess);
+                    cv::resize(images[index], r, size);
+                }
+                cache.emplace_back(size, std::move(r));
+                it = std::prev(cache.end());
+            }
+
+            batch.push_back(it->second);
+        }
+
+        return batch;
+    };
+
+    std::vector<classification> result(images.size(), classification(heads.size()));
+
+    std::vector<size_t> all(images.size());
+    for(size_t i = 0; i < all.size(); ++i)
+        all[i] = i;
+
+    for(size_t h = 0; h < heads.size(); ++h)
+    {
+        auto &stages = heads[h].stages;
+
+        // At least the top-1 prediction is required for the confidence gate
+        size_t const k = stages.size() > 1 ? std::max<size_t>(top_k, 1) : top_k;
+
+        // The images that have not been accepted by a stage yet
+        std::vector<size_t> pending = all;
+
+        for(size_t i = 0; i < stages.size() && !pending.empty(); ++i)
+        {
+            stage &s        = *stages[i];
+            bool const last = i + 1 == stages.size();
+
+            auto predictions = s.model.predict_batch(resized_for(s.model, pending), k);
+
+            std::vector<size_t> rejected;
+            for(size_t j = 0; j < pending.size(); ++j)
+            {
+                auto &p = predictions[j];
+
+                bool const forced = i == 0 && pending[j] < first_stage_only.size() && first_stage_only[pending[j]];
+
+                if(last || forced || (!p.empty() && p.front().confidence >= s.threshold))
+                {
+                    s.handled.fetch_add(1, std::memory_order_relaxed);
+                    p.resize(std::min(p.size(), top_k));
+                    result[pending[j]][h] = std::move(p);
+                }
+                else
+                {
+                    rejected.push_back(pending[j]);
+                }
+            }
+
+            pending = std::move(rejected);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Formats the predictions of all heads as a single record.
+ * @details With more than one head every class name is prefixed with the head name (e.g., `nsfw/safe 0.98`).
+ * @param[in] predictions The predictions returned by `predict`.
+ * @return The formatted predictions.
+ */
+std::string classifier::format(classification const &predictions) const
+{
+    std::string result;
+
+    for(size_t i = 0; i < predictions.size(); ++i)
+    {
+        std::string const prefix = (heads.size() > 1 && i < heads.size()) ? heads[i].name + "/" : "";
+
+        for(auto const &p : predictions[i])
+        {
+            if(!result.empty())
+                result += ", ";
+
+            result += prefix + p.class_name + " " + std::to_string(p.confidence);
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Runs every model once on a blank image of its input size,
+ *        so that the first request does not pay for the lazy initialization of the session.
+ */
+void classifier::warm_up()
+{
+    for(auto &h : heads)
+    {
+        for(auto &s : h.stages)
+            s->model.predict(cv::Mat(s->model.input_size(), CV_8UC3, cv::Scalar(0)), 1);
+    }
+}
+
+/**
+ * @brief Returns the input size shared by every model.
+ * @return The input size, or an empty size if the models have different input sizes.
+ */
+cv::Size classifier::input_size() const
+{
+    cv::Size result;
+
+    for(auto const &h : heads)
+    {
+        for(auto const &s : h.stages)
+        {
+            if(result.empty())
+                result = s->model.input_size();
+            else if(result != s->model.input_size())
+                return cv::Size();
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief Checks whether any head runs more than one stage.
+ * @return True if there is a cascade.
+ */
+bool classifier::is_cascade() const
+{
+    return std::any_of(heads.begin(), heads.end(), [](head const &h) { return h.stages.size() > 1; });
+}
+
+/**
+ * @brief Formats the share of images handled by every cascade stage.
+ * @return The report, one line per stage.
+ */
+std::string classifier::report() const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+
+    for(auto const &h : heads)
+    {
+        if(h.stages.size() < 2)
+            continue;
+
+        uint64_t total = 0;
+        for(auto const &s : h.stages)
+            total += s->handled.load(std::memory_order_relaxed);
+
+        for(size_t i = 0; i < h.stages.size(); ++i)
+        {
+            stage const &s   = *h.stages[i];
+            uint64_t handled = s.handled.load(std::memory_order_relaxed);
+            double share     = total == 0 ? 0.0 : 100.0 * static_cast<double>(handled) / static_cast<double>(total);
+
+            ss << "cascade stage " << i + 1 << " (" << s.name;
+            if(i + 1 != h.stages.size())
+                ss << ", threshold " << std::setprecision(2) << s.threshold << std::setprecision(1);
+            ss << "): " << handled << " images (" << share << "%)" << std::endl;
+        }
+    }
+
+    return ss.str();
+}
+
+/**
+ * @brief Ends the ONNX Runtime profiling of every model and writes the profiles.
+ * @return The profiles of the models that are profiled, named after their stage.
+ */
+std::vector<session_profile> classifier::end_profiling()
+{
+    std::vector<session_profile> result;
+
+    for(auto &h : heads)
+    {
+        for(auto &s : h.stages)
+        {
+            uint64_t const start_ns = s->model.profiling_start_ns();
+            std::string path        = s->model.end_profiling();
+
+            if(!path.empty())
+                result.push_back({s->name, std::move(path), start_ns});
+        }
+    }
+
+    return result;
+}
\ No newline at end of file
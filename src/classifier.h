@@ -0,0 +1,172 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file classifier.h
+ * @brief Defines the classifier that fans an image out to several models, each optionally a confidence-gated cascade.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "yolo.h"
+#include "stage_stats.h"
+
+/// The predictions of every head of a classifier for a single image.
+using classification = std::vector<std::vector<prediction>>;
+
+/**
+ * @class classifier
+ * @brief Classifies decoded images with one or more heads, every head is a single model or a cascade of models.
+ *
+ * Every head classifies the same decoded image and produces its own list of predictions.
+ * The image is resized once per distinct model input size and the resized image is shared by all heads and stages.
+ *
+ * In a cascade the stages are ordered from the cheapest to the most expensive model.
+ * An image is passed to the next stage only if the top-1 confidence of the current stage
+ * is below the stage threshold. The last stage always accepts the image.
+ */
+class classifier
+{
+public:
+    /**
+     * @brief Default constructor. The classifier has no heads and cannot predict.
+     */
+    classifier() = default;
+
+    /**
+     * @brief Constructs a classifier with a single model.
+     * @param[in] model The initialized model.
+     */
+    explicit classifier(yolo &&model);
+
+    /**
+     * @brief Adds a head with a single model.
+     * @param[in] name The name of the head used to label its predictions (e.g., the model file stem).
+     * @param[in] model The initialized model.
+     */
+    void add_head(std::string const &name, yolo &&model);
+
+    /**
+     * @brief Appends a stage to the cascade of the last head. Creates the head if there is none.
+     * @param[in] name The name of the stage used in the report (e.g., the model file name).
+     * @param[in] model The initialized model. It should apply softmax so that the threshold is a probability.
+     * @param[in] threshold The minimum top-1 confidence to accept the stage result. Ignored for the last stage.
+     */
+    void add_stage(std::string const &name, yolo &&model, float threshold);
+
+    /**
+     * @brief Classifies an image with every head.
+     * @param[in] image The decoded image.
+     * @param[in] top_k The number of top predictions to return per head.
+     * @return One vector of `prediction` structs per head, sorted by confidence in descending order.
+     * @throws std::runtime_error if the classifier has no heads.
+     */
+    classification predict(cv::Mat const &image, size_t top_k);
+
+    /**
+     * @brief Classifies several images with every head.
+     * @details Every stage classifies all images that reach it in a single `yolo::predict_batch` call.
+     *          Preprocessed input tensors (see `yolo::is_input_tensor`) are passed to the models as they are.
+     * @param[in] images The decoded images.
+     * @param[in] top_k The number of top predictions to return per head.
+     * @param[in] first_stage_only Per image, if true, the first stage of a cascade accepts the image regardless of the threshold.
+     *            May be empty.
+     * @return One `classification` per image.
+     * @throws std::runtime_error if the classifier has no heads.
+     */
+    std::vector<classification> predict_batch(std::vector<cv::Mat> const &images, size_t top_k, std::vector<bool> const &first_stage_only = {});
+
+    /**
+     * @brief Formats the predictions of all heads as a single record.
+     * @details With more than one head every class name is prefixed with the head name (e.g., `nsfw/safe 0.98`).
+     * @param[in] predictions The predictions returned by `predict`.
+     * @return The formatted predictions.
+     */
+    std::string format(classification const &predictions) const;
+
+    /**
+     * @brief Runs every model once on a blank image of its input size,
+     *        so that the first request does not pay for the lazy initialization of the session.
+     */
+    void warm_up();
+
+    /**
+     * @brief Returns the input size shared by every model.
+     * @return The input size, or an empty size if the models have different input sizes.
+     */
+    cv::Size input_size() const;
+
+    /**
+     * @brief Checks whether any head runs more than one stage.
+     * @return True if there is a cascade.
+     */
+    bool is_cascade() const;
+
+    /**
+     * @brief Formats the share of images handled by every cascade stage.
+     * @return The report, one line per stage.
+     */
+    std::string report() const;
+
+    /**
+     * @brief Ends the ONNX Runtime profiling of every model and writes the profiles.
+     * @return The profiles of the models that are profiled, named after their stage.
+     */
+    std::vector<session_profile> end_profiling();
+
+private:
+    /**
+     * @struct stage
+     * @brief A single stage of a cascade.
+     */
+    struct stage
+    {
+        std::string name;                 ///< The name of the stage.
+        yolo model;                       ///< The model of the stage.
+        float threshold = 0.0f;           ///< The minimum top-1 confidence to accept the result.
+        std::atomic<uint64_t> handled{0}; ///< The number of images accepted by the stage.
+    };
+
+    /**
+     * @struct head
+     * @brief A head, a cascade of one or more stages.
+     */
+    struct head
+    {
+        std::string name;                          ///< The name of the head.
+        std::vector<std::unique_ptr<stage>> stages; ///< The stages from the cheapest to the most expensive model.
+    };
+
+    std::vector<head> heads; ///< The heads, every head classifies every image.
+};
+
+#endif // CLASSIFIER_H
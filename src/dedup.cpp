@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file dedup.cpp
+ * @brief Defines an in-memory cache that coalesces classification of byte-identical images.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "dedup.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Constructs an empty cache.
+ * @param[in] capacity The maximum number of entries, at least 1.
+ */
+dedup_cache::dedup_cache(size_t capacity) : capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+/**
+ * @brief Looks up the content key and registers the caller as the owner if the key is new.
+ * @param[in] variant The model variant the content is classified by (see `model_router::route`).
+ * @param[in] size The size of the content in bytes.
+ * @param[in] digest The SHA-256 digest of the content.
+ * @param[in] generation The generation the caller started with (see `generation`).
+ *                       If the cache has been cleared since, the caller still owns a new entry, but it is not stored.
+ * @return An `entry`. If `entry::owner` is set, the caller must fulfill it, otherwise the caller should wait on `entry::result`.
+ */
+dedup_cache::entry dedup_cache::lookup(size_t variant, uint64_t size, sha256_digest const &digest, uint64_t generation)
+{
+    entry result;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = entries.find({variant, size, digest});
+    if(it != entries.end())
+    {
+        // Move the key to the front of the recency list
+        recency.splice(recency.begin(), recency, it->second.position);
+
+        result.result = it->second.result;
+        return result;
+    }
+
+    result.owner  = std::make_shared<std::promise<std::string>>();
+    result.result = result.owner->get_future().share();
+
+    // The caller runs on models that have been swapped out, its result must not be reused
+    if(generation != current)
+        return result;
+
+    // Evict the least recently used entry, requests already waiting on it keep their future
+    if(entries.size() >= capacity)
+    {
+        entries.erase(recency.back());
+        recency.pop_back();
+    }
+
+    recency.push_front(key {variant, size, digest});
+    entries.emplace(recency.front(), value {result.result, recency.begin()});
+
+    return result;
+}
+
+/**
+ * @brief Removes the entry of a content, e.g., after its owner failed, so that the next request classifies it again.
+ * @details Requests already waiting on the entry keep their future and receive what the owner publishes.
+ * @param[in] variant The model variant the content is classified by.
+ * @param[in] size The size of the content in bytes.
+ * @param[in] digest The SHA-256 digest of the content.
+ * @param[in] generation The generation the owner started with, nothing is removed if the cache has been cleared since.
+ */
+void dedup_cache::erase(size_t variant, uint64_t size, sha256_digest const &digest, uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if(generation != current)
+        return;
+
+    auto it = entries.find({variant, size, digest});
+    if(it == entries.end())
+        return;
+
+    recency.erase(it->second.position);
+    entries.erase(it);
+}
+
+/**
+ * @brief Returns the current generation, incremented by every `clear`.
+ * @return The generation.
+ */
+uint64_t dedup_cache::generation() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+/**
+ * @brief Removes all entries and starts a new generation, e.g., after the models have been reloaded.
+ * @details Pending entries are still fulfilled by their owners for the requests already waiting on them.
+ */
+void dedup_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    recency.clear();
+    ++current;
+}
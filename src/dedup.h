@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file dedup.h
+ * @brief Defines an in-memory cache that coalesces classification of byte-identical images.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "sha256.h"
+
+/**
+ * @class dedup_cache
+ * @brief A thread-safe cache of classification results keyed by the model variant, the content size and its SHA-256 digest.
+ *
+ * The variants of a canary rollout return different results for the same content, so every variant has its own entries.
+ * The first request for a given content becomes the owner of the entry and has to publish
+ * the result (or the exception) through the returned promise. Every other request with the same
+ * content receives a shared future and waits on it instead of running the inference again.
+ *
+ * The cache holds at most `capacity` entries, the least recently used entry is evicted first.
+ * A hit requires the whole 256-bit digest to match, so a client cannot craft bytes that receive
+ * the result of another image, without the cache keeping the bytes themselves.
+ *
+ * Every `clear` starts a new generation. A caller passes the generation it read before taking its model snapshot,
+ * so a batch still running on models that were swapped out meanwhile does not store its results.
+ */
+class dedup_cache
+{
+public:
+    /**
+     * @struct entry
+     * @brief The result of a cache lookup.
+     */
+    struct entry
+    {
+        std::shared_future<std::string> result;           ///< The shared result of the first request with the same content.
+        std::shared_ptr<std::promise<std::string>> owner; ///< Non-null if the caller is the first request and must publish the result.
+    };
+
+    /// The default maximum number of entries.
+    static constexpr size_t default_capacity = 262144;
+
+    /**
+     * @brief Constructs an empty cache.
+     * @param[in] capacity The maximum number of entries, at least 1.
+     */
+    explicit dedup_cache(size_t capacity = default_capacity);
+
+    /**
+     * @brief Looks up the content key and registers the caller as the owner if the key is new.
+     * @param[in] variant The model variant the content is classified by (see `model_router::route`).
+     * @param[in] size The size of the content in bytes.
+     * @param[in] digest The SHA-256 digest of the content.
+     * @param[in] generation The generation the caller started with (see `generation`).
+     *                       If the cache has been cleared since, the caller still owns a new entry, but it is not stored.
+     * @return An `entry`. If `entry::owner` is set, the caller must fulfill it, otherwise the caller should wait on `entry::result`.
+     */
+    entry lookup(size_t variant, uint64_t size, sha256_digest const &digest, uint64_t generation);
+
+    /**
+     * @brief Removes the entry of a content, e.g., after its owner failed, so that the next request classifies it again.
+     * @details Requests already waiting on the entry keep their future and receive what the owner publishes.
+     * @param[in] variant The model variant the content is classified by.
+     * @param[in] size The size of the content in bytes.
+     * @param[in] digest The SHA-256 digest of the content.
+     * @param[in] generation The generation the owner started with, nothing is removed if the cache has been cleared since.
+     */
+    void erase(size_t variant, uint64_t size, sha256_digest const &digest, uint64_t generation);
+
+    /**
+     * @brief Returns the current generation, incremented by every `clear`.
+     * @return The generation.
+     */
+    uint64_t generation() const;
+
+    /**
+     * @brief Removes all entries and starts a new generation, e.g., after the models have been reloaded.
+     * @details Pending entries are still fulfilled by their owners for the requests already waiting on them.
+     */
+    void clear();
+
+private:
+    /**
+     * @struct key
+     * @brief The content key, the model variant, the size and the digest of the content.
+     */
+    struct key
+    {
+        size_t variant;       ///< The model variant the content is classified by.
+        uint64_t size;        ///< The size of the content in bytes.
+        sha256_digest digest; ///< The SHA-256 digest of the content.
+
+        bool operator==(key const &other) const
+        {
+            return variant == other.variant && size == other.size && digest == other.digest;
+        }
+    };
+
+    /**
+     * @struct key_hash
+     * @brief Hash functor for `key`.
+     */
+    struct key_hash
+    {
+        size_t operator()(key const &k) const
+        {
+            // The digest is uniformly distributed, its first bytes are a good hash
+            uint64_t prefix;
+            std::memcpy(&prefix, k.digest.data(), sizeof(prefix));
+            return static_cast<size_t>(prefix ^ (k.size * 0x9E3779B97F4A7C15ULL) ^ k.variant);
+        }
+    };
+
+    /**
+     * @struct value
+     * @brief A cached result and its position in the recency list.
+     */
+    struct value
+    {
+        std::shared_future<std::string> result; ///< The (possibly pending) result.
+        std::list<key>::iterator position;      ///< The position of the key in `recency`.
+    };
+
+    size_t capacity;                                     ///< The maximum number of entries.
+    uint64_t current = 0;                                ///< The current generation.
+    std::list<key> recency;                              ///< The keys from the most to the least recently used.
+    std::unordered_map<key, value, key_hash> entries;    ///< Known contents and their (possibly pending) results.
+    mutable std::mutex mutex;                            ///< Mutex to protect access to the entries.
+};
+
+#endif // DEDUP_H
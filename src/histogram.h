@@ -0,0 +1,334 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file histogram.h
+ * @brief Defines the log-linear histogram of durations shared by the serving and the per-stage statistics.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @class log_linear_histogram
+ * @brief A log-linear histogram of durations.
+ *
+ * Values below `2 * 2^SubBucketBits` units have their own buckets, larger values are split into `2^SubBucketBits`
+ * buckets per power of two up to `2^MaxExponent` units, so a percentile is reported with a relative error
+ * below `2^-SubBucketBits`. The exact sum and maximum are kept besides the buckets.
+ *
+ * A concurrent histogram is lock-free and may be recorded by any thread. Otherwise recording is a few
+ * arithmetic instructions and non-atomic increments, and histograms of different threads are combined with `merge`.
+ *
+ * @tparam Duration The `std::chrono::duration` of a unit.
+ * @tparam SubBucketBits The number of bits below the highest set bit that select a bucket.
+ * @tparam MaxExponent Larger values are counted in the last bucket.
+ * @tparam Concurrent If true, the counters are atomic.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+class log_linear_histogram
+{
+public:
+    /**
+     * @brief Records a duration.
+     * @param[in] duration The duration, negative durations are recorded as 0.
+     */
+    void record(Duration duration);
+
+    /**
+     * @brief Adds the values of another histogram.
+     * @param[in] other The histogram.
+     */
+    void merge(log_linear_histogram const &other);
+
+    /**
+     * @brief Returns the number of recorded durations.
+     * @return The number of recorded durations.
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Returns the sum of the recorded durations.
+     * @return The sum of the recorded durations.
+     */
+    Duration sum() const;
+
+    /**
+     * @brief Returns the longest recorded duration.
+     * @return The exact longest duration, or 0 if nothing has been recorded.
+     */
+    Duration max() const;
+
+    /**
+     * @brief Returns a percentile of the recorded durations.
+     * @param[in] quantile The quantile in [0, 1] (e.g., 0.99).
+     * @return The upper bound of the bucket that contains the percentile (at most `max`), or 0 if nothing has been recorded.
+     */
+    Duration percentile(double quantile) const;
+
+private:
+    /// The counter type, atomic if the histogram is shared by threads.
+    using counter = std::conditional_t<Concurrent, std::atomic<uint64_t>, uint64_t>;
+
+    /// The number of buckets per power of two above `linear_buckets`.
+    static constexpr size_t sub_buckets = size_t {1} << SubBucketBits;
+
+    /// The number of exactly represented small values, a power of two.
+    static constexpr size_t linear_buckets = 2 * sub_buckets;
+
+    /// The exponent of the highest set bit of the first value past the linear buckets.
+    static constexpr size_t first_exponent = SubBucketBits + 1;
+
+    /// The number of buckets, enough for `2^MaxExponent` units.
+    static constexpr size_t bucket_count = linear_buckets + (MaxExponent - first_exponent) * sub_buckets;
+
+    static_assert(MaxExponent > first_exponent && MaxExponent < 64, "The exponent range is empty or too large.");
+
+    /**
+     * @brief Returns the bucket of a value.
+     * @param[in] value The value in units.
+     * @return The bucket index.
+     */
+    static size_t bucket_of(uint64_t value);
+
+    /**
+     * @brief Returns the largest value of a bucket.
+     * @param[in] bucket The bucket index.
+     * @return The value in units.
+     */
+    static uint64_t upper_bound_of(size_t bucket);
+
+    /**
+     * @brief Reads a counter.
+     * @param[in] c The counter.
+     * @return The value.
+     */
+    static uint64_t load(counter const &c);
+
+    /**
+     * @brief Adds to a counter.
+     * @param c The counter.
+     * @param[in] value The value to add.
+     */
+    static void add(counter &c, uint64_t value);
+
+    /**
+     * @brief Raises a counter to a value if it is smaller.
+     * @param c The counter.
+     * @param[in] value The value.
+     */
+    static void raise(counter &c, uint64_t value);
+
+    std::array<counter, bucket_count> buckets {}; ///< The number of values per bucket.
+    counter total {0};                            ///< The number of recorded values.
+    counter sum_units {0};                        ///< The sum of the recorded values.
+    counter largest {0};                          ///< The largest recorded value.
+};
+
+/**
+ * @brief Records a duration.
+ * @param[in] duration The duration, negative durations are recorded as 0.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+void log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::record(Duration duration)
+{
+    uint64_t const value = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+
+    add(buckets[bucket_of(value)], 1);
+    add(total, 1);
+    add(sum_units, value);
+    raise(largest, value);
+}
+
+/**
+ * @brief Adds the values of another histogram.
+ * @param[in] other The histogram.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+void log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::merge(log_linear_histogram const &other)
+{
+    for(size_t i = 0; i < bucket_count; ++i)
+        add(buckets[i], load(other.buckets[i]));
+
+    add(total, load(other.total));
+    add(sum_units, load(other.sum_units));
+    raise(largest, load(other.largest));
+}
+
+/**
+ * @brief Returns the number of recorded durations.
+ * @return The number of recorded durations.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+uint64_t log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::count() const
+{
+    return load(total);
+}
+
+/**
+ * @brief Returns the sum of the recorded durations.
+ * @return The sum of the recorded durations.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+Duration log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::sum() const
+{
+    return Duration(load(sum_units));
+}
+
+/**
+ * @brief Returns the longest recorded duration.
+ * @return The exact longest duration, or 0 if nothing has been recorded.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+Duration log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::max() const
+{
+    return Duration(load(largest));
+}
+
+/**
+ * @brief Returns a percentile of the recorded durations.
+ * @param[in] quantile The quantile in [0, 1] (e.g., 0.99).
+ * @return The upper bound of the bucket that contains the percentile (at most `max`), or 0 if nothing has been recorded.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+Duration log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::percentile(double quantile) const
+{
+    uint64_t const n = count();
+    if(n == 0)
+        return Duration(0);
+
+    // The rank of the percentile, starting at 1
+    uint64_t const rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(n))));
+    uint64_t const high = load(largest);
+
+    uint64_t seen = 0;
+    for(size_t i = 0; i < bucket_count; ++i)
+    {
+        seen += load(buckets[i]);
+
+        if(seen >= rank)
+            return Duration(std::min(upper_bound_of(i), high));
+    }
+
+    return Duration(high);
+}
+
+/**
+ * @brief Returns the bucket of a value.
+ * @param[in] value The value in units.
+ * @return The bucket index.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+size_t log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::bucket_of(uint64_t value)
+{
+    if(value < linear_buckets)
+        return static_cast<size_t>(value);
+
+    // The position of the highest set bit, at least `first_exponent`
+    size_t exponent = first_exponent;
+    while((value >> (exponent + 1)) != 0)
+        ++exponent;
+
+    // The bits below the highest one select the sub-bucket
+    size_t const bucket = linear_buckets + (exponent - first_exponent) * sub_buckets + static_cast<size_t>((value >> (exponent - SubBucketBits)) & (sub_buckets - 1));
+
+    return std::min(bucket, bucket_count - 1);
+}
+
+/**
+ * @brief Returns the largest value of a bucket.
+ * @param[in] bucket The bucket index.
+ * @return The value in units.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+uint64_t log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::upper_bound_of(size_t bucket)
+{
+    if(bucket < linear_buckets)
+        return bucket;
+
+    size_t const exponent = first_exponent + (bucket - linear_buckets) / sub_buckets;
+    size_t const sub      = (bucket - linear_buckets) % sub_buckets;
+
+    return ((uint64_t {sub_buckets} + sub + 1) << (exponent - SubBucketBits)) - 1;
+}
+
+/**
+ * @brief Reads a counter.
+ * @param[in] c The counter.
+ * @return The value.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+uint64_t log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::load(counter const &c)
+{
+    if constexpr(Concurrent)
+        return c.load(std::memory_order_relaxed);
+    else
+        return c;
+}
+
+/**
+ * @brief Adds to a counter.
+ * @param c The counter.
+ * @param[in] value The value to add.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+void log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::add(counter &c, uint64_t value)
+{
+    if constexpr(Concurrent)
+        c.fetch_add(value, std::memory_order_relaxed);
+    else
+        c += value;
+}
+
+/**
+ * @brief Raises a counter to a value if it is smaller.
+ * @param c The counter.
+ * @param[in] value The value.
+ */
+template<typename Duration, size_t SubBucketBits, size_t MaxExponent, bool Concurrent>
+void log_linear_histogram<Duration, SubBucketBits, MaxExponent, Concurrent>::raise(counter &c, uint64_t value)
+{
+    if constexpr(Concurrent)
+    {
+        uint64_t current = c.load(std::memory_order_relaxed);
+        while(current < value && !c.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+    else
+    {
+        c = std::max(c, value);
+    }
+}
+
+#endif // HISTOGRAM_H
\ No newline at end of file
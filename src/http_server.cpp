@@ -0,0 +1,987 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file http_server.cpp
+ * @brief Defines a minimal HTTP/1.1 endpoint of the daemon.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "http_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+#ifdef __linux__
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+/// The maximum size of the request line and the headers.
+static constexpr size_t max_header_size = 64 * 1024;
+
+/**
+ * @brief Compares two strings ignoring the ASCII case.
+ * @param[in] a The first string.
+ * @param[in] b The second string.
+ * @return True if the strings are equal.
+ */
+static bool iequals(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+}
+
+/**
+ * @brief Removes the leading and trailing spaces and tabs.
+ * @param[in] value The string.
+ * @return The trimmed string.
+ */
+static std::string_view trim(std::string_view value)
+{
+    while(!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+        value.remove_prefix(1);
+
+    while(!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+        value.remove_suffix(1);
+
+    return value;
+}
+
+/**
+ * @brief Parses the request line and the headers at the start of the received bytes of a connection.
+ * @param[in] data The received bytes, starting with a request.
+ * @param[in] max_body_size Larger bodies are rejected with `413`.
+ * @param[out] request Receives the request line and the headers.
+ * @param[out] error Receives the body of the error response.
+ * @return 0 if the headers are not complete yet, 200 if the request was parsed, or the status of the error response,
+ *         after which the connection is closed.
+ */
+int parse_http_request(std::string_view data, uint64_t max_body_size, http_request &request, std::string &error)
+{
+    request = http_request();
+
+    size_t const header_end = data.find("\r\n\r\n");
+    if(header_end == std::string_view::npos)
+    {
+        if(data.size() <= max_header_size)
+            return 0;
+
+        error = "Request header fields too large.\n";
+        return 431;
+    }
+
+    // Request line
+    std::string_view head = data.substr(0, header_end);
+    size_t line_end       = head.find("\r\n");
+    std::string_view line = head.substr(0, line_end);
+
+    size_t const method_end = line.find(' ');
+    size_t const target_end = line.rfind(' ');
+
+    if(method_end == std::string_view::npos || target_end <= method_end)
+    {
+        error = "Malformed request line.\n";
+        return 400;
+    }
+
+    std::string_view const version = line.substr(target_end + 1);
+    request.method                 = line.substr(0, method_end);
+    request.target                 = line.substr(method_end + 1, target_end - method_end - 1);
+    request.target                 = request.target.substr(0, request.target.find('?'));
+
+    if(version != "HTTP/1.1" && version != "HTTP/1.0")
+    {
+        error = "Unsupported HTTP version.\n";
+        return 400;
+    }
+
+    // Headers
+    request.keep_alive    = (version == "HTTP/1.1");
+    bool chunked          = false;
+    size_t length_headers = 0;
+    bool invalid_length   = false;
+
+    head = (line_end == std::string_view::npos) ? std::string_view() : head.substr(line_end + 2);
+
+    while(!head.empty())
+    {
+        line_end = head.find("\r\n");
+        line     = head.substr(0, line_end);
+        head     = (line_end == std::string_view::npos) ? std::string_view() : head.substr(line_end + 2);
+
+        size_t const colon = line.find(':');
+        if(colon == std::string_view::npos)
+            continue;
+
+        std::string_view const name  = line.substr(0, colon);
+        std::string_view const value = trim(line.substr(colon + 1));
+
+        if(iequals(name, "Content-Length"))
+        {
+            // Only digits, no overflow and a single header, a lenient parser would frame the body differently than a proxy
+            auto const length = parse_integer(value, 0, std::numeric_limits<int64_t>::max());
+            ++length_headers;
+
+            invalid_length         = invalid_length || !length || length_headers > 1;
+            request.content_length = length ? static_cast<uint64_t>(*length) : 0;
+        }
+        else if(iequals(name, "Transfer-Encoding"))
+            chunked = !iequals(value, "identity");
+        else if(iequals(name, "Connection"))
+            request.keep_alive = iequals(value, "close") ? false : (iequals(value, "keep-alive") ? true : request.keep_alive);
+        else if(iequals(name, "Content-Type"))
+            request.content_type = value;
+        else if(iequals(name, "Expect"))
+            request.expect_continue = iequals(value, "100-continue");
+        else if(iequals(name, "X-Deadline-Ms"))
+        {
+            auto const ms       = parse_integer(value, 0, max_deadline_ms);
+            request.deadline_ms = ms ? *ms : -1;
+        }
+        else if(iequals(name, "X-Priority"))
+            request.priority = iequals(value, "bulk") ? job_priority::bulk : job_priority::interactive;
+    }
+
+    if(invalid_length)
+    {
+        error = "Invalid Content-Length header.\n";
+        return 400;
+    }
+
+    if(chunked)
+    {
+        error = "Chunked request bodies are not supported, send Content-Length.\n";
+        return 501;
+    }
+
+    // The body is not read, so the connection is closed after the response
+    if(request.deadline_ms < 0)
+    {
+        error = "Invalid X-Deadline-Ms header, expected milliseconds from 0 to " + std::to_string(max_deadline_ms) + ".\n";
+        return 400;
+    }
+
+    if(request.content_length > max_body_size)
+    {
+        error = "File is too large.\n";
+        return 413;
+    }
+
+    request.body_begin = header_end + 4;
+
+    return 200;
+}
+
+#ifdef __linux__
+
+/// The maximum number of requests of a connection that are parsed before their responses are sent.
+static constexpr size_t max_pipelined = 64;
+
+/**
+ * @struct http_response
+ * @brief A response slot. Slots are sent in request order once they are ready.
+ */
+struct http_response
+{
+    std::string data;   ///< The serialized response.
+    bool ready = false; ///< True once `data` is complete.
+    bool close = false; ///< True if the connection is closed after the response.
+};
+
+/**
+ * @struct http_server::connection
+ * @brief The state of a client connection.
+ */
+struct http_server::connection
+{
+    int fd                 = -1;                          ///< The socket.
+    uint32_t events        = 0;                           ///< The epoll events the socket is registered for.
+    std::string input;                                    ///< Received bytes that have not been parsed yet.
+    std::string output;                                   ///< Response bytes that have not been written yet.
+    size_t output_position = 0;                           ///< The number of bytes of `output` already written.
+    std::deque<std::shared_ptr<http_response>> responses; ///< The responses in request order.
+    std::mutex mutex;                                     ///< Protects the contents of the response slots.
+    size_t index           = 0;                           ///< The number of received requests.
+    bool peer_closed       = false;                       ///< True once the client has closed its write side.
+    bool closing           = false;                       ///< True if no further requests are parsed.
+    bool continue_sent     = false;                       ///< True if `100 Continue` was sent for the current request.
+    bool closed            = false;                       ///< True once the connection has been closed.
+};
+
+/**
+ * @brief Throws the error of the last failed system call.
+ * @param[in] what The description of the failed operation.
+ * @throws std::system_error always.
+ */
+[[noreturn]] static void throw_errno(std::string const &what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief Returns the reason phrase of a status code.
+ * @param[in] status The status code.
+ * @return The reason phrase.
+ */
+static char const *reason_phrase(int status)
+{
+    switch(status)
+    {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 431: return "Request Header Fields Too Large";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "Internal Server Error";
+    }
+}
+
+/**
+ * @brief Serializes a response.
+ * @param[in] status The status code.
+ * @param[in] content_type The media type of the body.
+ * @param[in] body The body.
+ * @param[in] keep_alive If false, the response announces that the connection is closed.
+ * @return The serialized response.
+ */
+static std::string make_response(int status, std::string_view content_type, std::string_view body, bool keep_alive)
+{
+    std::string response;
+    response.reserve(128 + body.size());
+
+    response += "HTTP/1.1 ";
+    response += std::to_string(status);
+    response += ' ';
+    response += reason_phrase(status);
+    response += "\r\nContent-Type: ";
+    response += content_type;
+    response += "\r\nContent-Length: ";
+    response += std::to_string(body.size());
+    response += keep_alive ? "\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    response += body;
+
+    return response;
+}
+
+/**
+ * @brief Finds the first file of a `multipart/form-data` body.
+ * @param[in] body The body.
+ * @param[in] boundary The boundary from the `Content-Type` header.
+ * @param[out] content The content of the file.
+ * @param[out] filename The file name of the file.
+ * @return False if the body has no file.
+ */
+static bool parse_multipart(std::string_view body, std::string_view boundary, std::string_view &content, std::string &filename)
+{
+    std::string const delimiter = "\r\n--" + std::string(boundary);
+
+    // The first delimiter may be at the very beginning of the body
+    size_t position = (body.substr(0, delimiter.size() - 2) == std::string_view(delimiter).substr(2)) ? 0 : body.find(delimiter);
+    if(position == std::string_view::npos)
+        return false;
+
+    position += (position == 0) ? delimiter.size() - 2 : delimiter.size();
+
+    while(body.substr(position, 2) == "\r\n")
+    {
+        size_t const headers_begin = position + 2;
+        size_t const headers_end   = body.find("\r\n\r\n", headers_begin);
+        if(headers_end == std::string_view::npos)
+            return false;
+
+        size_t const content_begin = headers_end + 4;
+        size_t const next          = body.find(delimiter, content_begin);
+        if(next == std::string_view::npos)
+            return false;
+
+        std::string_view const headers = body.substr(headers_begin, headers_end - headers_begin);
+        size_t const name              = headers.find("filename=\"");
+
+        if(name != std::string_view::npos)
+        {
+            size_t const name_begin = name + 10;
+            size_t const name_end   = headers.find('"', name_begin);
+
+            filename = std::string(headers.substr(name_begin, name_end == std::string_view::npos ? std::string_view::npos : name_end - name_begin));
+            content  = body.substr(content_begin, next - content_begin);
+            return true;
+        }
+
+        position = next + delimiter.size();
+    }
+
+    return false;
+}
+
+/**
+ * @brief Creates the listening socket.
+ * @param[in] address The address to listen on as `<host>:<port>` (e.g., `127.0.0.1:8080`, `[::1]:8080` or `:8080`).
+ * @param admission The admission control that queues the jobs for the worker threads.
+ * @param router The models, reloaded by `POST /reload`.
+ * @param[in] stats The statistics of the worker threads, reported by `GET /metrics`.
+ * @param[in] c The application configuration.
+ * @throws std::invalid_argument if the address is invalid.
+ * @throws std::system_error if the socket cannot be created.
+ * @throws std::runtime_error if the endpoint is not supported on this platform.
+ */
+http_server::http_server(std::string const &address, admission_control &admission, model_router &router, serving_stats const &stats, configuration const &c) : admission(admission), router(router), stats(stats), c(c)
+{
+    size_t const colon = address.rfind(':');
+    if(colon == std::string::npos)
+        throw std::invalid_argument("Invalid HTTP address '" + address + "', expected <host>:<port>.");
+
+    std::string host       = address.substr(0, colon);
+    std::string const port = address.substr(colon + 1);
+
+    if(host.size() >= 2 && host.front() == '[' && host.back() == ']')
+        host = host.substr(1, host.size() - 2);
+
+    addrinfo hints {};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_PASSIVE;
+
+    addrinfo *result = nullptr;
+    if(int const error = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result); error != 0)
+        throw std::invalid_argument("Invalid HTTP address '" + address + "': " + ::gai_strerror(error));
+
+    std::unique_ptr<addrinfo, decltype(&::freeaddrinfo)> info(result, &::freeaddrinfo);
+
+    listen_fd = ::socket(info->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(listen_fd < 0)
+        throw_errno("could not create a socket");
+
+    int const enable = 1;
+    ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    if(::bind(listen_fd, info->ai_addr, info->ai_addrlen) != 0 || ::listen(listen_fd, SOMAXCONN) != 0)
+    {
+        int const error = errno;
+        ::close(listen_fd);
+        throw std::system_error(error, std::generic_category(), "could not listen on '" + address + "'");
+    }
+
+    epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    event_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if(epoll_fd < 0 || event_fd < 0)
+    {
+        int const error = errno;
+        ::close(listen_fd);
+
+        if(epoll_fd >= 0)
+            ::close(epoll_fd);
+
+        throw std::system_error(error, std::generic_category(), "could not create the event loop");
+    }
+
+    epoll_event event {};
+    event.events  = EPOLLIN;
+    event.data.fd = listen_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+
+    event.data.fd = event_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &event);
+
+    std::stringstream ss;
+    ss << "yolo-cls: listening on 'http://" << address << "'" << std::endl;
+    std::cerr << ss.str();
+}
+
+/**
+ * @brief Closes the sockets.
+ */
+http_server::~http_server()
+{
+    for(auto &[fd, conn] : connections)
+        ::close(fd);
+
+    if(listen_fd >= 0)
+        ::close(listen_fd);
+
+    ::close(event_fd);
+    ::close(epoll_fd);
+}
+
+/**
+ * @brief Runs the event loop until `stop_fd` becomes readable,
+ *        then stops accepting and returns once every received request has been answered.
+ * @param[in] stop_fd The file descriptor that becomes readable when the daemon is stopped.
+ * @throws std::system_error if the event loop fails.
+ */
+void http_server::run(int stop_fd)
+{
+    epoll_event event {};
+    event.events  = EPOLLIN;
+    event.data.fd = stop_fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &event);
+
+    bool stopping = false;
+    epoll_event events[64];
+
+    while(true)
+    {
+        // The worker threads hold references to this object until every image is answered
+        if(stopping && connections.empty())
+        {
+            std::lock_guard<std::mutex> lock(completed_mutex);
+            if(in_flight == 0)
+                break;
+        }
+
+        int const count = ::epoll_wait(epoll_fd, events, 64, -1);
+
+        if(count < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            throw_errno("could not wait for events");
+        }
+
+        for(int i = 0; i < count; ++i)
+        {
+            int const fd = events[i].data.fd;
+
+            if(fd == stop_fd)
+            {
+                // Stop accepting, answer the requests that have already been received
+                stopping = true;
+
+                ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, stop_fd, nullptr);
+                ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, listen_fd, nullptr);
+                ::close(listen_fd);
+                listen_fd = -1;
+
+                std::vector<std::shared_ptr<connection>> open;
+                for(auto const &[conn_fd, conn] : connections)
+                    open.push_back(conn);
+
+                for(auto const &conn : open)
+                {
+                    conn->closing = true;
+                    flush_connection(conn);
+                }
+            }
+            else if(fd == listen_fd)
+            {
+                accept_connections();
+            }
+            else if(fd == event_fd)
+            {
+                uint64_t value = 0;
+                [[maybe_unused]] auto const received = ::read(event_fd, &value, sizeof(value));
+
+                std::vector<std::shared_ptr<connection>> ready;
+                {
+                    std::lock_guard<std::mutex> lock(completed_mutex);
+                    ready.swap(completed);
+                }
+
+                for(auto const &conn : ready)
+                {
+                    if(!conn->closed)
+                        flush_connection(conn);
+                }
+            }
+            else
+            {
+                auto it = connections.find(fd);
+                if(it == connections.end())
+                    continue;
+
+                auto const conn = it->second;
+
+                // The client is gone, the responses cannot be delivered
+                if(events[i].events & (EPOLLHUP | EPOLLERR))
+                {
+                    close_connection(conn);
+                    continue;
+                }
+
+                if(events[i].events & EPOLLIN)
+                    read_connection(conn);
+
+                if(!conn->closed && (events[i].events & EPOLLOUT))
+                    flush_connection(conn);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Accepts the pending connections.
+ */
+void http_server::accept_connections()
+{
+    while(true)
+    {
+        int const fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0)
+            return;
+
+        // Responses are small and latency matters more than the number of packets
+        int const enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        auto conn    = std::make_shared<connection>();
+        conn->fd     = fd;
+        conn->events = EPOLLIN;
+
+        epoll_event event {};
+        event.events  = conn->events;
+        event.data.fd = fd;
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+
+        connections.emplace(fd, std::move(conn));
+    }
+}
+
+/**
+ * @brief Reads from a connection and handles the complete requests.
+ * @param conn The connection.
+ */
+void http_server::read_connection(std::shared_ptr<connection> const &conn)
+{
+    char buffer[64 * 1024];
+
+    while(!conn->peer_closed)
+    {
+        ssize_t const received = ::recv(conn->fd, buffer, sizeof(buffer), 0);
+
+        if(received > 0)
+        {
+            conn->input.append(buffer, static_cast<size_t>(received));
+
+            if(static_cast<size_t>(received) < sizeof(buffer))
+                break;
+        }
+        else if(received == 0)
+        {
+            conn->peer_closed = true;
+        }
+        else if(errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else if(errno != EINTR)
+        {
+            close_connection(conn);
+            return;
+        }
+    }
+
+    flush_connection(conn);
+}
+
+/**
+ * @brief Parses and dispatches the complete requests in the input buffer of a connection.
+ * @param conn The connection.
+ */
+void http_server::handle_requests(std::shared_ptr<connection> const &conn)
+{
+    size_t consumed = 0;
+
+    // Queues a response that is ready immediately
+    auto respond = [&](int status, std::string_view body, bool keep_alive, std::string_view content_type = "text/plain; charset=utf-8")
+    {
+        auto slot   = std::make_shared<http_response>();
+        slot->data  = make_response(status, content_type, body, keep_alive);
+        slot->ready = true;
+        slot->close = !keep_alive;
+        conn->responses.push_back(std::move(slot));
+
+        if(!keep_alive)
+            conn->closing = true;
+    };
+
+    while(!conn->closing && conn->responses.size() < max_pipelined)
+    {
+        std::string_view const data = std::string_view(conn->input).substr(consumed);
+
+        http_request request;
+        std::string error;
+
+        int const status = parse_http_request(data, c.max_filesize, request, error);
+        if(status == 0)
+            break;
+
+        if(status != 200)
+        {
+            respond(status, error, false);
+            break;
+        }
+
+        std::string_view const method       = request.method;
+        std::string_view const target       = request.target;
+        std::string_view const content_type = request.content_type;
+        bool const keep_alive               = request.keep_alive;
+
+        size_t const total = request.body_begin + request.content_length;
+
+        if(data.size() < total)
+        {
+            // The client waits for the interim response before sending a large body
+            if(request.expect_continue && !conn->continue_sent && conn->responses.empty() && conn->output.empty())
+            {
+                conn->output += "HTTP/1.1 100 Continue\r\n\r\n";
+                conn->continue_sent = true;
+            }
+
+            break;
+        }
+
+        std::string_view const body = data.substr(request.body_begin, request.content_length);
+
+        conn->continue_sent = false;
+        consumed += total;
+        ++conn->index;
+        ++requests_total;
+
+        // Routes
+        if(target == "/classify")
+        {
+            if(method != "POST")
+            {
+                respond(405, "Use POST.\n", keep_alive);
+                continue;
+            }
+
+            std::string_view image = body;
+            std::string name       = "bytes:" + std::to_string(conn->index);
+
+            if(content_type.rfind("multipart/form-data", 0) == 0)
+            {
+                size_t const parameter = content_type.find("boundary=");
+                std::string_view boundary;
+
+                if(parameter != std::string_view::npos)
+                {
+                    boundary = content_type.substr(parameter + 9);
+                    boundary = boundary.substr(0, boundary.find(';'));
+
+                    if(boundary.size() >= 2 && boundary.front() == '"' && boundary.back() == '"')
+                        boundary = boundary.substr(1, boundary.size() - 2);
+                }
+
+                std::string filename;
+                if(boundary.empty() || !parse_multipart(body, boundary, image, filename))
+                {
+                    respond(400, "The multipart body has no file.\n", keep_alive);
+                    continue;
+                }
+
+                if(!filename.empty())
+                    name = std::move(filename);
+            }
+
+            if(image.empty())
+            {
+                respond(400, "The request has no image.\n", keep_alive);
+                continue;
+            }
+
+            auto slot   = std::make_shared<http_response>();
+            slot->close = !keep_alive;
+            conn->responses.push_back(slot);
+
+            if(!keep_alive)
+                conn->closing = true;
+
+            job image_job {name, "", std::vector<uchar>(image.begin(), image.end())};
+
+            if(request.deadline_ms > 0)
+                image_job.deadline = image_job.received + std::chrono::milliseconds(request.deadline_ms);
+
+            image_job.priority = request.priority;
+
+            image_job.reply = [this, conn, slot, keep_alive](job_status status, std::string const &result)
+            {
+                int code = 422;
+
+                // clang-format off
+                switch(status)
+                {
+                    case job_status::done: code = 200; break;
+                    case job_status::failed: code = 422; break;
+                    case job_status::expired: code = 504; break;
+                    case job_status::busy: code = 503; break;
+                }
+                // clang-format on
+
+                ++(status == job_status::done ? classified_total : failed_total);
+
+                complete(conn, slot, make_response(code, "text/plain; charset=utf-8", result + '\n', keep_alive));
+            };
+
+            // A rejected image is answered through the callback right away
+            ++in_flight;
+            admission.submit(std::move(image_job));
+        }
+        else if(target == "/reload")
+        {
+            if(method != "POST")
+            {
+                respond(405, "Use POST.\n", keep_alive);
+                continue;
+            }
+
+            auto slot   = std::make_shared<http_response>();
+            slot->close = !keep_alive;
+            conn->responses.push_back(slot);
+
+            if(!keep_alive)
+                conn->closing = true;
+
+            // Answered by the reload thread once the new models serve
+            ++in_flight;
+            router.reload([this, conn, slot, keep_alive](bool success, std::string const &message) { complete(conn, slot, make_response(success ? 200 : 500, "text/plain; charset=utf-8", message + '\n', keep_alive)); });
+        }
+        else if(target == "/healthz" || target == "/metrics")
+        {
+            if(method != "GET")
+                respond(405, "Use GET.\n", keep_alive);
+            else if(target == "/healthz")
+                respond(200, "ok\n", keep_alive);
+            else
+                respond(200, metrics(), keep_alive, "text/plain; version=0.0.4");
+        }
+        else
+        {
+            respond(404, "Not found.\n", keep_alive);
+        }
+    }
+
+    conn->input.erase(0, consumed);
+
+    if(conn->closing)
+        conn->input.clear();
+}
+
+/**
+ * @brief Fills a response slot from another thread and wakes up the event loop to send it.
+ * @param conn The connection.
+ * @param slot The response slot of the request.
+ * @param[in] response The serialized response.
+ */
+void http_server::complete(std::shared_ptr<connection> const &conn, std::shared_ptr<http_response> const &slot, std::string response)
+{
+    {
+        std::lock_guard<std::mutex> lock(conn->mutex);
+        slot->data  = std::move(response);
+        slot->ready = true;
+    }
+
+    // Under the lock, so that the event loop cannot return before the notification is written
+    std::lock_guard<std::mutex> lock(completed_mutex);
+    completed.push_back(conn);
+    --in_flight;
+
+    uint64_t const value = 1;
+    [[maybe_unused]] auto const written = ::write(event_fd, &value, sizeof(value));
+}
+
+/**
+ * @brief Moves the completed responses, in request order, to the output buffer and writes it.
+ *        Closes the connection once it has nothing more to do.
+ * @param conn The connection.
+ */
+void http_server::flush_connection(std::shared_ptr<connection> const &conn)
+{
+    // Parsing stops at `max_pipelined` responses, so continue while responses are sent
+    while(true)
+    {
+        handle_requests(conn);
+
+        bool moved = false;
+        {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+
+            while(!conn->responses.empty() && conn->responses.front()->ready)
+            {
+                conn->output += conn->responses.front()->data;
+                conn->responses.pop_front();
+                moved = true;
+            }
+        }
+
+        if(!moved || conn->closing)
+            break;
+    }
+
+    while(conn->output_position < conn->output.size())
+    {
+        ssize_t const sent = ::send(conn->fd, conn->output.data() + conn->output_position, conn->output.size() - conn->output_position, MSG_NOSIGNAL);
+
+        if(sent > 0)
+        {
+            conn->output_position += static_cast<size_t>(sent);
+        }
+        else if(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else if(sent < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            close_connection(conn);
+            return;
+        }
+    }
+
+    if(conn->output_position == conn->output.size())
+    {
+        conn->output.clear();
+        conn->output_position = 0;
+    }
+
+    // Done once the client will not send more requests (or must not) and everything has been answered
+    if((conn->peer_closed || conn->closing) && conn->responses.empty() && conn->output.empty())
+    {
+        close_connection(conn);
+        return;
+    }
+
+    update_events(conn);
+}
+
+/**
+ * @brief Updates the epoll events of a connection to match its state.
+ * @param conn The connection.
+ */
+void http_server::update_events(std::shared_ptr<connection> const &conn)
+{
+    uint32_t events = 0;
+
+    if(!conn->peer_closed && !conn->closing && conn->responses.size() < max_pipelined)
+        events |= EPOLLIN;
+
+    if(!conn->output.empty())
+        events |= EPOLLOUT;
+
+    if(events == conn->events)
+        return;
+
+    conn->events = events;
+
+    epoll_event event {};
+    event.events  = events;
+    event.data.fd = conn->fd;
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+/**
+ * @brief Closes a connection. Responses that are still being computed are discarded.
+ * @param conn The connection.
+ */
+void http_server::close_connection(std::shared_ptr<connection> const &conn)
+{
+    if(conn->closed)
+        return;
+
+    conn->closed = true;
+
+    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, nullptr);
+    ::close(conn->fd);
+    connections.erase(conn->fd);
+}
+
+/**
+ * @brief Formats the counters and the statistics in the Prometheus text format.
+ * @return The metrics.
+ */
+std::string http_server::metrics() const
+{
+    std::stringstream ss;
+
+    ss << "# HELP yolo_cls_http_requests_total HTTP requests received.\n";
+    ss << "# TYPE yolo_cls_http_requests_total counter\n";
+    ss << "yolo_cls_http_requests_total " << requests_total << "\n";
+    ss << "# HELP yolo_cls_classified_total Images classified.\n";
+    ss << "# TYPE yolo_cls_classified_total counter\n";
+    ss << "yolo_cls_classified_total " << classified_total << "\n";
+    ss << "# HELP yolo_cls_failed_total Images that could not be classified.\n";
+    ss << "# TYPE yolo_cls_failed_total counter\n";
+    ss << "yolo_cls_failed_total " << failed_total << "\n";
+    ss << "# HELP yolo_cls_in_flight Images waiting for the worker threads.\n";
+    ss << "# TYPE yolo_cls_in_flight gauge\n";
+    ss << "yolo_cls_in_flight " << in_flight << "\n";
+    ss << "# HELP yolo_cls_http_connections Open HTTP connections.\n";
+    ss << "# TYPE yolo_cls_http_connections gauge\n";
+    ss << "yolo_cls_http_connections " << connections.size() << "\n";
+    ss << stats.prometheus();
+
+    return ss.str();
+}
+
+#else
+
+/**
+ * @brief Creates the listening socket. The endpoint is not supported on this platform.
+ * @param[in] address The address to listen on.
+ * @param admission The admission control that queues the jobs for the worker threads.
+ * @param router The models, reloaded by `POST /reload`.
+ * @param[in] stats The statistics of the worker threads.
+ * @param[in] c The application configuration.
+ * @throws std::runtime_error always.
+ */
+http_server::http_server(std::string const &, admission_control &admission, model_router &router, serving_stats const &stats, configuration const &c) : admission(admission), router(router), stats(stats), c(c)
+{
+    throw std::runtime_error("--http is not supported on this platform.");
+}
+
+/**
+ * @brief Closes the sockets.
+ */
+http_server::~http_server() = default;
+
+/**
+ * @brief Runs the event loop. The endpoint is not supported on this platform.
+ * @param[in] stop_fd The file descriptor that becomes readable when the daemon is stopped.
+ */
+void http_server::run(int)
+{
+}
+
+#endif
\ No newline at end of file
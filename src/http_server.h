@@ -0,0 +1,199 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file http_server.h
+ * @brief Defines a minimal HTTP/1.1 endpoint of the daemon.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include "utils.h"
+#include "stats.h"
+#include "admission.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct http_response;
+
+/**
+ * @struct http_request
+ * @brief The request line and the headers of an HTTP request. The views point into the received bytes.
+ */
+struct http_request
+{
+    std::string_view method;                             ///< The method (e.g., `POST`).
+    std::string_view target;                             ///< The request target without the query.
+    std::string_view content_type;                       ///< The `Content-Type` header.
+    uint64_t content_length = 0;                         ///< The size of the body in bytes.
+    size_t body_begin       = 0;                         ///< The offset of the body in the received bytes.
+    int64_t deadline_ms     = 0;                         ///< The `X-Deadline-Ms` header, 0 if there is none.
+    job_priority priority   = job_priority::interactive; ///< The `X-Priority` header.
+    bool keep_alive         = true;                      ///< False if the connection is closed after the response.
+    bool expect_continue    = false;                     ///< True if the client waits for `100 Continue` before sending the body.
+};
+
+/**
+ * @brief Parses the request line and the headers at the start of the received bytes of a connection.
+ * @param[in] data The received bytes, starting with a request.
+ * @param[in] max_body_size Larger bodies are rejected with `413`.
+ * @param[out] request Receives the request line and the headers.
+ * @param[out] error Receives the body of the error response.
+ * @return 0 if the headers are not complete yet, 200 if the request was parsed, or the status of the error response,
+ *         after which the connection is closed.
+ */
+int parse_http_request(std::string_view data, uint64_t max_body_size, http_request &request, std::string &error);
+
+/**
+ * @class http_server
+ * @brief A minimal HTTP/1.1 endpoint of the daemon, driven by a single epoll event loop.
+ *
+ * Routes:
+ *   - `POST /classify` with the encoded image as the body, or as the first file of a `multipart/form-data` body.
+ *     The response is the result line (`200`) or the error message (`422`) as plain text.
+ *   - `POST /reload` reloads the models in the background, answered once the new models serve (`200`) or failed (`500`).
+ *   - `GET /healthz` returns `ok`.
+ *   - `GET /metrics` returns the request counters and the latency percentiles in the Prometheus text format.
+ *
+ * An `X-Deadline-Ms` request header drops the image with `504` if its inference cannot start in time.
+ * An `X-Priority: bulk` request header queues the image behind interactive requests.
+ * Images rejected by the admission control are answered with `503`.
+ *
+ * Connections are kept alive and pipelined requests are answered in order.
+ * The event loop parses the requests and writes the responses, the classification runs on the worker threads.
+ */
+class http_server
+{
+public:
+    /**
+     * @brief Creates the listening socket.
+     * @param[in] address The address to listen on as `<host>:<port>` (e.g., `127.0.0.1:8080`, `[::1]:8080` or `:8080`).
+     * @param admission The admission control that queues the jobs for the worker threads.
+     * @param router The models, reloaded by `POST /reload`.
+     * @param[in] stats The statistics of the worker threads, reported by `GET /metrics`.
+     * @param[in] c The application configuration.
+     * @throws std::invalid_argument if the address is invalid.
+     * @throws std::system_error if the socket cannot be created.
+     * @throws std::runtime_error if the endpoint is not supported on this platform.
+     */
+    http_server(std::string const &address, admission_control &admission, model_router &router, serving_stats const &stats, configuration const &c);
+
+    /**
+     * @brief Closes the sockets.
+     */
+    ~http_server();
+
+    http_server(http_server const &)            = delete;
+    http_server &operator=(http_server const &) = delete;
+
+    /**
+     * @brief Runs the event loop until `stop_fd` becomes readable,
+     *        then stops accepting and returns once every received request has been answered.
+     * @param[in] stop_fd The file descriptor that becomes readable when the daemon is stopped.
+     * @throws std::system_error if the event loop fails.
+     */
+    void run(int stop_fd);
+
+private:
+    struct connection;
+
+    admission_control &admission; ///< Queues the jobs for the worker threads.
+    model_router &router;         ///< Reloads the models.
+    serving_stats const &stats;   ///< The statistics of the worker threads.
+    configuration const &c;       ///< The application configuration.
+    int listen_fd = -1;           ///< The listening socket.
+    int epoll_fd  = -1;           ///< The epoll instance.
+    int event_fd  = -1;           ///< Signals that the worker threads have completed responses.
+
+    std::unordered_map<int, std::shared_ptr<connection>> connections; ///< The open connections by socket.
+
+    std::mutex completed_mutex;                          ///< Protects `completed`.
+    std::vector<std::shared_ptr<connection>> completed;  ///< The connections with new responses.
+
+    // Counters reported by `GET /metrics`
+    std::atomic<uint64_t> requests_total {0};   ///< All parsed requests.
+    std::atomic<uint64_t> classified_total {0}; ///< Classified images.
+    std::atomic<uint64_t> failed_total {0};     ///< Images that could not be classified.
+    std::atomic<uint64_t> in_flight {0};        ///< Images waiting for the worker threads and pending reloads.
+
+    /**
+     * @brief Accepts the pending connections.
+     */
+    void accept_connections();
+
+    /**
+     * @brief Reads from a connection and handles the complete requests.
+     * @param conn The connection.
+     */
+    void read_connection(std::shared_ptr<connection> const &conn);
+
+    /**
+     * @brief Parses and dispatches the complete requests in the input buffer of a connection.
+     * @param conn The connection.
+     */
+    void handle_requests(std::shared_ptr<connection> const &conn);
+
+    /**
+     * @brief Fills a response slot from another thread and wakes up the event loop to send it.
+     * @param conn The connection.
+     * @param slot The response slot of the request.
+     * @param[in] response The serialized response.
+     */
+    void complete(std::shared_ptr<connection> const &conn, std::shared_ptr<http_response> const &slot, std::string response);
+
+    /**
+     * @brief Moves the completed responses, in request order, to the output buffer and writes it.
+     *        Closes the connection once it has nothing more to do.
+     * @param conn The connection.
+     */
+    void flush_connection(std::shared_ptr<connection> const &conn);
+
+    /**
+     * @brief Updates the epoll events of a connection to match its state.
+     * @param conn The connection.
+     */
+    void update_events(std::shared_ptr<connection> const &conn);
+
+    /**
+     * @brief Closes a connection. Responses that are still being computed are discarded.
+     * @param conn The connection.
+     */
+    void close_connection(std::shared_ptr<connection> const &conn);
+
+    /**
+     * @brief Formats the counters and the statistics in the Prometheus text format.
+     * @return The metrics.
+     */
+    std::string metrics() const;
+};
+
+#endif // HTTP_SERVER_H
\ No newline at end of file
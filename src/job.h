@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file job.h
+ * @brief Defines a classification request passed to the worker threads.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef JOB_H
+#define JOB_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+class buffer_pool;
+
+/**
+ * @enum job_status
+ * @brief The outcome of a job passed to `job::reply`.
+ */
+enum class job_status
+{
+    done,    ///< The image has been classified, the line is the result.
+    failed,  ///< The image could not be classified, the line is the error message.
+    expired, ///< The deadline passed before the inference started, the line is the error message.
+    busy,    ///< The job was rejected by the admission control, the line is the error message.
+};
+
+/**
+ * @enum job_priority
+ * @brief The priority class of a job. Queued interactive jobs are classified before queued bulk jobs.
+ */
+enum class job_priority : size_t
+{
+    interactive = 0, ///< Latency-sensitive requests (the default).
+    bulk        = 1, ///< Backfill jobs that may wait and may be rejected under load.
+};
+
+/// The number of priority classes, the number of levels of the input queue.
+inline constexpr size_t job_priority_levels = 2;
+
+/// The longest deadline a client can request in milliseconds (a day), so that the deadline time point cannot overflow.
+inline constexpr int64_t max_deadline_ms = 86'400'000;
+
+/**
+ * @struct job
+ * @brief A single image to classify.
+ *
+ * The image is either read from `path`, decoded from the in-memory `data` or `encoded`, or already decoded in `image`.
+ * The result is printed to standard output unless `reply` is set.
+ */
+struct job
+{
+    std::string name;           ///< The name printed with the result (the path as given by the user).
+    std::string path;           ///< The path to the image file. Ignored if `data`, `encoded` or `image` is not empty.
+    std::vector<uchar> data {}; ///< The encoded image bytes.
+    cv::Mat image {};           ///< The decoded BGR image. It may wrap memory of the producer, which must stay valid until `reply`.
+    buffer_pool *pool = nullptr; ///< If set, `data` is returned to this pool once the image is decoded (or classified, if `image` wraps it).
+
+    cv::Mat encoded {};                   ///< Encoded image bytes (a single row of `CV_8UC1`) that wrap memory kept alive by `owner`.
+    std::shared_ptr<void const> owner {}; ///< Keeps the memory of `encoded` valid, e.g., a mapped record file.
+
+    /// If not empty, the crop of every box is classified instead of the image, with one result per box.
+    std::vector<cv::Rect> boxes {};
+
+    /// If not empty, these frames (or pages) of a multi-frame image file are classified instead of the image, with one result per frame.
+    std::vector<int> frames {};
+
+    /// The time the job was received.
+    std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now();
+
+    /// The job is dropped if its inference cannot start before this time.
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    job_priority priority = job_priority::interactive; ///< The priority class.
+    bool downgraded       = false;                     ///< If true, only the first stage of a cascade classifies the image.
+
+    /**
+     * @brief Receives the result instead of the standard output and error.
+     * @details Called by a worker thread with the status and the formatted result line or the error message.
+     */
+    std::function<void(job_status, std::string const &)> reply {};
+};
+
+#endif // JOB_H
\ No newline at end of file
@@ -0,0 +1,439 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file json.cpp
+ * @brief Implements a minimal JSON reader and writer helpers (benchmark results, traces).
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "json.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+/**
+ * @brief Looks up a member of an object.
+ * @param[in] key The key.
+ * @return The value, or nullptr if this is not an object or has no such member.
+ */
+json_value const *json_value::find(std::string const &key) const
+{
+    if(type != kind::object)
+        return nullptr;
+
+    for(size_t i = 0; i < keys.size(); ++i)
+    {
+        if(keys[i] == key)
+            return &items[i];
+    }
+
+    return nullptr;
+}
+
+/**
+ * @brief Returns a member of an object.
+ * @param[in] key The key.
+ * @return The value.
+ * @throws std::invalid_argument if this is not an object or has no such member.
+ */
+json_value const &json_value::at(std::string const &key) const
+{
+    auto const *value = find(key);
+    if(value == nullptr)
+        throw std::invalid_argument("The JSON member '" + key + "' is missing.");
+
+    return *value;
+}
+
+/**
+ * @class json_parser
+ * @brief A recursive descent parser of JSON documents.
+ */
+class json_parser
+{
+public:
+    /**
+     * @brief Constructs a parser of a document.
+     * @param[in] text The document, which must outlive the parser.
+     */
+    explicit json_parser(std::string_view text) : text(text)
+    {
+    }
+
+    /**
+     * @brief Parses the whole document.
+     * @return The root value.
+     * @throws std::invalid_argument if the document is not valid JSON.
+     */
+    json_value parse_document()
+    {
+        json_value result = parse_value();
+
+        skip_whitespace();
+        if(position != text.size())
+            fail("unexpected data after the value");
+
+        return result;
+    }
+
+private:
+    std::string_view text; ///< The document.
+    size_t position = 0;   ///< The offset of the next character.
+
+    /**
+     * @brief Throws a parse error at the current position.
+     * @param[in] message The description of the error.
+     * @throws std::invalid_argument always.
+     */
+    [[noreturn]] void fail(std::string const &message) const
+    {
+        throw std::invalid_argument("Invalid JSON at offset " + std::to_string(position) + ": " + message + ".");
+    }
+
+    /**
+     * @brief Skips whitespace.
+     */
+    void skip_whitespace()
+    {
+        while(position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+            ++position;
+    }
+
+    /**
+     * @brief Consumes a character after optional whitespace.
+     * @param[in] ch The expected character.
+     * @return True if the character was next and has been consumed.
+     */
+    bool consume(char ch)
+    {
+        skip_whitespace();
+        if(position < text.size() && text[position] == ch)
+        {
+            ++position;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Consumes a character after optional whitespace, which must be next.
+     * @param[in] ch The expected character.
+     * @throws std::invalid_argument if another character is next.
+     */
+    void expect(char ch)
+    {
+        if(!consume(ch))
+            fail(std::string("expected '") + ch + "'");
+    }
+
+    /**
+     * @brief Consumes a literal (e.g., `true`), which must be next.
+     * @param[in] literal The literal.
+     * @throws std::invalid_argument if the literal is not next.
+     */
+    void expect_literal(std::string_view literal)
+    {
+        if(text.substr(position, literal.size()) != literal)
+            fail("expected '" + std::string(literal) + "'");
+
+        position += literal.size();
+    }
+
+    /**
+     * @brief Parses a value.
+     * @return The value.
+     */
+    json_value parse_value()
+    {
+        json_value result;
+
+        skip_whitespace();
+        if(position == text.size())
+            fail("unexpected end of the document");
+
+        char const ch = text[position];
+        if(ch == '{')
+        {
+            ++position;
+            result.type = json_value::kind::object;
+
+            if(consume('}'))
+                return result;
+
+            do
+            {
+                skip_whitespace();
+                result.keys.push_back(parse_string());
+                expect(':');
+                result.items.push_back(parse_value());
+            } while(consume(','));
+
+            expect('}');
+        }
+        else if(ch == '[')
+        {
+            ++position;
+            result.type = json_value::kind::array;
+
+            if(consume(']'))
+                return result;
+
+            do
+            {
+                result.items.push_back(parse_value());
+            } while(consume(','));
+
+            expect(']');
+        }
+        else if(ch == '"')
+        {
+            result.type   = json_value::kind::string;
+            result.string = parse_string();
+        }
+        else if(ch == 't' || ch == 'f')
+        {
+            result.type    = json_value::kind::boolean;
+            result.boolean = ch == 't';
+            expect_literal(result.boolean ? "true" : "false");
+        }
+        else if(ch == 'n')
+        {
+            expect_literal("null");
+        }
+        else
+        {
+            result.type   = json_value::kind::number;
+            result.number = parse_number();
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Parses a number.
+     * @return The value.
+     */
+    double parse_number()
+    {
+        size_t const start = position;
+        while(position < text.size() && (std::isdigit(static_cast<unsigned char>(text[position])) || std::string_view("+-.eE").find(text[position]) != std::string_view::npos))
+            ++position;
+
+        std::string const number(text.substr(start, position - start));
+        char *end          = nullptr;
+        double const value = std::strtod(number.c_str(), &end);
+
+        if(number.empty() || end != number.c_str() + number.size())
+        {
+            position = start;
+            fail("expected a value");
+        }
+
+        return value;
+    }
+
+    /**
+     * @brief Parses a string, the opening quote must be next.
+     * @return The unescaped string. Escaped code points are encoded as UTF-8.
+     */
+    std::string parse_string()
+    {
+        if(position == text.size() || text[position] != '"')
+            fail("expected a string");
+        ++position;
+
+        std::string result;
+        while(true)
+        {
+            if(position == text.size())
+                fail("unterminated string");
+
+            char const ch = text[position++];
+            if(ch == '"')
+                return result;
+
+            if(ch != '\\')
+            {
+                result += ch;
+                continue;
+            }
+
+            if(position == text.size())
+                fail("unterminated string");
+
+            // clang-format off
+            switch(char const escaped = text[position++])
+            {
+                case '"': case '\\': case '/': result += escaped; break;
+                case 'b': result += '\b'; break;
+                case 'f': result += '\f'; break;
+                case 'n': result += '\n'; break;
+                case 'r': result += '\r'; break;
+                case 't': result += '\t'; break;
+                case 'u': append_utf8(result, parse_hex4()); break;
+                default: fail("invalid escape sequence");
+            }
+            // clang-format on
+        }
+    }
+
+    /**
+     * @brief Parses the four hexadecimal digits of a `\u` escape sequence.
+     * @return The code unit.
+     */
+    unsigned parse_hex4()
+    {
+        if(text.size() - position < 4)
+            fail("invalid escape sequence");
+
+        std::string const digits(text.substr(position, 4));
+        char *end             = nullptr;
+        unsigned const result = static_cast<unsigned>(std::strtoul(digits.c_str(), &end, 16));
+        if(end != digits.c_str() + 4)
+            fail("invalid escape sequence");
+
+        position += 4;
+        return result;
+    }
+
+    /**
+     * @brief Appends a code point encoded as UTF-8. Surrogate pairs are not combined.
+     * @param[in,out] result The string.
+     * @param[in] code_point The code point.
+     */
+    static void append_utf8(std::string &result, unsigned code_point)
+    {
+        if(code_point < 0x80)
+        {
+            result += static_cast<char>(code_point);
+        }
+        else if(code_point < 0x800)
+        {
+            result += static_cast<char>(0xc0 | (code_point >> 6));
+            result += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+        else
+        {
+            result += static_cast<char>(0xe0 | (code_point >> 12));
+            result += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+            result += static_cast<char>(0x80 | (code_point & 0x3f));
+        }
+    }
+};
+
+/**
+ * @brief Parses a JSON document.
+ * @param[in] text The document.
+ * @return The root value.
+ * @throws std::invalid_argument if the document is not valid JSON.
+ */
+json_value parse_json(std::string_view text)
+{
+    return json_parser(text).parse_document();
+}
+
+/**
+ * @brief Serializes a JSON value.
+ * @param[in] value The value.
+ * @return The compact JSON text, integral numbers are written without a fraction.
+ */
+std::string dump_json(json_value const &value)
+{
+    switch(value.type)
+    {
+        case json_value::kind::null: return "null";
+        case json_value::kind::boolean: return value.boolean ? "true" : "false";
+        case json_value::kind::string: return json_quote(value.string);
+        case json_value::kind::number:
+        {
+            if(!std::isfinite(value.number))
+                return "null";
+
+            char number[32];
+            if(value.number == std::floor(value.number) && std::fabs(value.number) < 1e15)
+                std::snprintf(number, sizeof(number), "%.0f", value.number);
+            else
+                std::snprintf(number, sizeof(number), "%.17g", value.number);
+
+            return number;
+        }
+        case json_value::kind::array:
+        {
+            std::string result = "[";
+            for(size_t i = 0; i < value.items.size(); ++i)
+                result += (i == 0 ? "" : ",") + dump_json(value.items[i]);
+
+            return result + "]";
+        }
+        case json_value::kind::object:
+        {
+            std::string result = "{";
+            for(size_t i = 0; i < value.items.size(); ++i)
+                result += (i == 0 ? "" : ",") + json_quote(value.keys[i]) + ":" + dump_json(value.items[i]);
+
+            return result + "}";
+        }
+    }
+
+    return "null";
+}
+
+/**
+ * @brief Quotes a string as a JSON string literal.
+ * @param[in] value The string.
+ * @return The quoted and escaped string.
+ */
+std::string json_quote(std::string const &value)
+{
+    std::string result = "\"";
+
+    for(char ch : value)
+    {
+        switch(ch)
+        {
+            case '"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(ch) < 0x20)
+                {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(ch));
+                    result += escaped;
+                }
+                else
+                {
+                    result += ch;
+                }
+        }
+    }
+
+    return result + "\"";
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file json.h
+ * @brief Declares a minimal JSON reader and writer helpers (benchmark results, traces).
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct json_value
+ * @brief A parsed JSON value.
+ */
+struct json_value
+{
+    /**
+     * @brief The type of a JSON value.
+     */
+    enum class kind
+    {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object,
+    };
+
+    kind type     = kind::null;    ///< The type of the value.
+    bool boolean  = false;         ///< The value of a boolean.
+    double number = 0.0;           ///< The value of a number.
+    std::string string;            ///< The value of a string.
+    std::vector<std::string> keys; ///< The keys of an object, in the order of `items`.
+    std::vector<json_value> items; ///< The elements of an array or the values of an object.
+
+    /**
+     * @brief Looks up a member of an object.
+     * @param[in] key The key.
+     * @return The value, or nullptr if this is not an object or has no such member.
+     */
+    json_value const *find(std::string const &key) const;
+
+    /**
+     * @brief Returns a member of an object.
+     * @param[in] key The key.
+     * @return The value.
+     * @throws std::invalid_argument if this is not an object or has no such member.
+     */
+    json_value const &at(std::string const &key) const;
+};
+
+/**
+ * @brief Parses a JSON document.
+ * @param[in] text The document.
+ * @return The root value.
+ * @throws std::invalid_argument if the document is not valid JSON.
+ */
+json_value parse_json(std::string_view text);
+
+/**
+ * @brief Serializes a JSON value.
+ * @param[in] value The value.
+ * @return The compact JSON text, integral numbers are written without a fraction.
+ */
+std::string dump_json(json_value const &value);
+
+/**
+ * @brief Quotes a string as a JSON string literal.
+ * @param[in] value The string.
+ * @return The quoted and escaped string.
+ */
+std::string json_quote(std::string const &value);
+
+#endif // JSON_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file mapped_file.cpp
+ * @brief Implements a read-only memory mapping of a file.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * @brief Maps a file.
+ * @param[in] path The path to the file.
+ * @param[in] advice How the mapping is going to be read.
+ * @throws std::runtime_error if the file cannot be opened, is empty or cannot be mapped.
+ */
+mapped_file::mapped_file(std::string const &path, access advice)
+{
+#ifdef _WIN32
+    DWORD const flags = advice == access::sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    HANDLE const file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("could not open the file '" + path + "'.");
+
+    LARGE_INTEGER file_size;
+    if(!::GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        ::CloseHandle(file);
+        throw std::runtime_error("could not map the file '" + path + "'.");
+    }
+
+    mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(file);
+
+    if(!mapping)
+        throw std::runtime_error("could not map the file '" + path + "'.");
+
+    base   = static_cast<uchar const *>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    length = static_cast<size_t>(file_size.QuadPart);
+
+    if(!base)
+    {
+        ::CloseHandle(mapping);
+        throw std::runtime_error("could not map the file '" + path + "'.");
+    }
+#else
+    int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        throw std::runtime_error("could not open the file '" + path + "'.");
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("could not map the file '" + path + "'.");
+    }
+
+    length     = static_cast<size_t>(st.st_size);
+    void *data = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if(data == MAP_FAILED)
+        throw std::runtime_error("could not map the file '" + path + "'.");
+
+    base = static_cast<uchar const *>(data);
+
+    ::madvise(data, length, advice == access::sequential ? MADV_SEQUENTIAL : MADV_WILLNEED);
+#endif
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+mapped_file::~mapped_file()
+{
+#ifdef _WIN32
+    ::UnmapViewOfFile(base);
+    ::CloseHandle(mapping);
+#else
+    ::munmap(const_cast<uchar *>(base), length);
+#endif
+}
+
+/**
+ * @brief Returns the mapped bytes.
+ * @return The first byte of the file.
+ */
+uchar const *mapped_file::data() const
+{
+    return base;
+}
+
+/**
+ * @brief Returns the size of the mapping.
+ * @return The size of the file in bytes.
+ */
+size_t mapped_file::size() const
+{
+    return length;
+}
\ No newline at end of file
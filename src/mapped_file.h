@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file mapped_file.h
+ * @brief Defines a read-only memory mapping of a file.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class mapped_file
+ * @brief A read-only memory mapping of a whole file.
+ */
+class mapped_file
+{
+public:
+    /**
+     * @brief How the mapping is going to be read, passed to the kernel with `madvise`.
+     */
+    enum class access
+    {
+        sequential, ///< Read once, in order (`MADV_SEQUENTIAL`): read ahead aggressively and drop the pages behind.
+        whole,      ///< Read entirely right away (`MADV_WILLNEED`).
+    };
+
+    /**
+     * @brief Maps a file.
+     * @param[in] path The path to the file.
+     * @param[in] advice How the mapping is going to be read.
+     * @throws std::runtime_error if the file cannot be opened, is empty or cannot be mapped.
+     */
+    explicit mapped_file(std::string const &path, access advice = access::sequential);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~mapped_file();
+
+    mapped_file(mapped_file const &)            = delete;
+    mapped_file &operator=(mapped_file const &) = delete;
+
+    /**
+     * @brief Returns the mapped bytes.
+     * @return The first byte of the file.
+     */
+    uchar const *data() const;
+
+    /**
+     * @brief Returns the size of the mapping.
+     * @return The size of the file in bytes.
+     */
+    size_t size() const;
+
+private:
+    uchar const *base = nullptr; ///< The mapping.
+    size_t length     = 0;       ///< The size of the mapping in bytes.
+    void *mapping     = nullptr; ///< The file mapping handle (Windows only).
+};
+
+#endif // MAPPED_FILE_H
\ No newline at end of file
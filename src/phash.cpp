@@ -0,0 +1,217 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file phash.cpp
+ * @brief Defines a perceptual image hash and a BK-tree index for near-duplicate lookup.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "phash.h"
+
+#include <algorithm>
+#include <bitset>
+#include <mutex>
+
+/**
+ * @brief Computes the 64-bit difference hash (dHash) of an image.
+ * @details The image is downscaled to 9x8 pixels, converted to grayscale and every bit of the hash
+ *          tells whether a pixel is brighter than its right neighbour. Re-encoded copies
+ *          of the same picture produce hashes within a small Hamming distance.
+ *          Only the 72 downscaled pixels are converted, so the cost is a single pass over the image.
+ * @param[in] image The decoded image (BGR, BGRA or grayscale).
+ * @return The hash value.
+ */
+uint64_t difference_hash(cv::Mat const &image)
+{
+    cv::Mat small;
+    cv::resize(image, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    if(small.channels() == 3)
+        cv::cvtColor(small, small, cv::COLOR_BGR2GRAY);
+    else if(small.channels() == 4)
+        cv::cvtColor(small, small, cv::COLOR_BGRA2GRAY);
+
+    uint64_t hash = 0;
+    for(int y = 0; y < 8; ++y)
+    {
+        uchar const *row = small.ptr<uchar>(y);
+        for(int x = 0; x < 8; ++x)
+        {
+            hash <<= 1;
+            if(row[x] > row[x + 1])
+                hash |= 1;
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Computes the Hamming distance between two 64-bit hashes.
+ * @param[in] a The first hash.
+ * @param[in] b The second hash.
+ * @return The number of differing bits.
+ */
+int hamming_distance(uint64_t a, uint64_t b)
+{
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+/**
+ * @brief Constructs an empty index.
+ * @param[in] capacity The maximum number of hashes, at least 1.
+ */
+phash_index::phash_index(size_t capacity) : capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+/**
+ * @brief Finds the stored result with the nearest hash within the given Hamming distance.
+ * @param[in] variant The model variant the image is classified by (see `model_router::route`).
+ * @param[in] hash The hash to look up.
+ * @param[in] max_distance The maximum allowed Hamming distance.
+ * @return The stored result, or `std::nullopt` if there is no hash close enough.
+ */
+std::optional<std::string> phash_index::find(size_t variant, uint64_t hash, int max_distance) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+
+    if(variant >= trees.size() || trees[variant].empty())
+        return std::nullopt;
+
+    auto const &nodes = trees[variant];
+
+    size_t best          = nodes.size();
+    int best_distance    = max_distance + 1;
+    std::vector<size_t> pending = {0};
+
+    while(!pending.empty())
+    {
+        size_t index = pending.back();
+        pending.pop_back();
+
+        node const &n = nodes[index];
+        int distance  = hamming_distance(hash, n.hash);
+
+        if(distance < best_distance)
+        {
+            best          = index;
+            best_distance = distance;
+
+            if(distance == 0)
+                break;
+        }
+
+        // By the triangle inequality only the children within [distance - max, distance + max] can match
+        for(auto const &child : n.children)
+        {
+            if(child.first >= distance - max_distance && child.first <= distance + max_distance)
+                pending.push_back(child.second);
+        }
+    }
+
+    if(best == nodes.size())
+        return std::nullopt;
+
+    return nodes[best].value;
+}
+
+/**
+ * @brief Inserts a hash and its result into the index.
+ * @param[in] variant The model variant that classified the image.
+ * @param[in] hash The hash.
+ * @param[in] value The result to store with the hash.
+ * @param[in] generation The generation the caller started with (see `generation`), nothing is stored if the index has been cleared since.
+ */
+void phash_index::insert(size_t variant, uint64_t hash, std::string const &value, uint64_t generation)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+
+    // The result comes from models that have been swapped out
+    if(generation != current)
+        return;
+
+    // The full index starts over, a BK-tree has no cheap way to drop its oldest nodes
+    if(count >= capacity)
+    {
+        trees.clear();
+        count = 0;
+    }
+
+    if(variant >= trees.size())
+        trees.resize(variant + 1);
+
+    auto &nodes = trees[variant];
+
+    if(nodes.empty())
+    {
+        nodes.push_back({hash, value, {}});
+        ++count;
+        return;
+    }
+
+    size_t index = 0;
+    while(true)
+    {
+        int distance = hamming_distance(hash, nodes[index].hash);
+
+        // The same hash is already stored
+        if(distance == 0)
+            return;
+
+        auto &children = nodes[index].children;
+        auto it        = std::find_if(children.begin(), children.end(), [distance](auto const &child) { return child.first == distance; });
+
+        if(it == children.end())
+        {
+            children.emplace_back(distance, nodes.size());
+            nodes.push_back({hash, value, {}});
+            ++count;
+            return;
+        }
+
+        index = it->second;
+    }
+}
+
+/**
+ * @brief Returns the current generation, incremented by every `clear`.
+ * @return The generation.
+ */
+uint64_t phash_index::generation() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return current;
+}
+
+/**
+ * @brief Removes all hashes and starts a new generation, e.g., after the models have been reloaded.
+ */
+void phash_index::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    trees.clear();
+    count = 0;
+    ++current;
+}
@@ -0,0 +1,134 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file phash.h
+ * @brief Defines a perceptual image hash and a BK-tree index for near-duplicate lookup.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef PHASH_H
+#define PHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief Computes the 64-bit difference hash (dHash) of an image.
+ * @details The image is downscaled to 9x8 pixels, converted to grayscale and every bit of the hash
+ *          tells whether a pixel is brighter than its right neighbour. Re-encoded copies
+ *          of the same picture produce hashes within a small Hamming distance.
+ *          Only the 72 downscaled pixels are converted, so the cost is a single pass over the image.
+ * @param[in] image The decoded image (BGR, BGRA or grayscale).
+ * @return The hash value.
+ */
+uint64_t difference_hash(cv::Mat const &image);
+
+/**
+ * @brief Computes the Hamming distance between two 64-bit hashes.
+ * @param[in] a The first hash.
+ * @param[in] b The second hash.
+ * @return The number of differing bits.
+ */
+int hamming_distance(uint64_t a, uint64_t b);
+
+/**
+ * @class phash_index
+ * @brief A thread-safe BK-tree of perceptual hashes and the results stored with them, one tree per model variant.
+ *
+ * The variants of a canary rollout return different results for the same image, so a result is only found
+ * by the variant that classified it.
+ *
+ * The index holds at most `capacity` hashes. A BK-tree cannot evict single nodes cheaply, so once it is full
+ * all trees are dropped and filled again with the results that follow.
+ * Every `clear` starts a new generation. A caller passes the generation it read before taking its model snapshot
+ * to `insert`, so a batch still running on models that were swapped out meanwhile does not store its results.
+ */
+class phash_index
+{
+public:
+    /// The default maximum number of hashes, the same as `dedup_cache::default_capacity`.
+    static constexpr size_t default_capacity = 262144;
+
+    /**
+     * @brief Constructs an empty index.
+     * @param[in] capacity The maximum number of hashes, at least 1.
+     */
+    explicit phash_index(size_t capacity = default_capacity);
+
+    /**
+     * @brief Finds the stored result with the nearest hash within the given Hamming distance.
+     * @param[in] variant The model variant the image is classified by (see `model_router::route`).
+     * @param[in] hash The hash to look up.
+     * @param[in] max_distance The maximum allowed Hamming distance.
+     * @return The stored result, or `std::nullopt` if there is no hash close enough.
+     */
+    std::optional<std::string> find(size_t variant, uint64_t hash, int max_distance) const;
+
+    /**
+     * @brief Inserts a hash and its result into the index.
+     * @param[in] variant The model variant that classified the image.
+     * @param[in] hash The hash.
+     * @param[in] value The result to store with the hash.
+     * @param[in] generation The generation the caller started with (see `generation`), nothing is stored if the index has been cleared since.
+     */
+    void insert(size_t variant, uint64_t hash, std::string const &value, uint64_t generation);
+
+    /**
+     * @brief Returns the current generation, incremented by every `clear`.
+     * @return The generation.
+     */
+    uint64_t generation() const;
+
+    /**
+     * @brief Removes all hashes and starts a new generation, e.g., after the models have been reloaded.
+     */
+    void clear();
+
+private:
+    /**
+     * @struct node
+     * @brief A node of the BK-tree.
+     */
+    struct node
+    {
+        uint64_t hash;                                 ///< The hash stored in the node.
+        std::string value;                             ///< The result stored with the hash.
+        std::vector<std::pair<int, size_t>> children;  ///< Child nodes as (distance to this node, node index) pairs.
+    };
+
+    size_t capacity;                      ///< The maximum number of hashes.
+    size_t count = 0;                     ///< The number of hashes in all trees.
+    std::vector<std::vector<node>> trees; ///< The nodes of the tree of every variant, the first node is the root.
+    uint64_t current = 0;                 ///< The current generation.
+    mutable std::shared_mutex mutex;      ///< Mutex to protect access to the nodes.
+};
+
+#endif // PHASH_H
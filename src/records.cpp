@@ -0,0 +1,231 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file records.cpp
+ * @brief Implements the packed record file (.ycr) of encoded images and the pack subcommand.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "records.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Maps a record file and validates its index.
+ * @details The kernel is told that the file is read sequentially (`madvise(MADV_SEQUENTIAL)`).
+ * @param[in] path The path to the record file.
+ * @throws std::runtime_error if the file cannot be mapped or is not a valid record file.
+ */
+record_file::record_file(std::string const &path) : file(path, mapped_file::access::sequential)
+{
+    size_t const length = file.size();
+    auto const invalid  = std::runtime_error("'" + path + "' is not a valid record file.");
+
+    if(length < sizeof(records_header))
+        throw invalid;
+
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if(std::memcmp(header.magic, records_magic, sizeof(records_magic)) != 0 || header.version != records_version)
+        throw invalid;
+
+    // Every offset must stay inside the mapping
+    if(header.index_offset > length || header.count > (length - header.index_offset) / sizeof(records_entry) || header.index_offset % alignof(records_entry) != 0)
+        throw invalid;
+
+    if(header.paths_offset > length || header.paths_size > length - header.paths_offset)
+        throw invalid;
+
+    index = reinterpret_cast<records_entry const *>(file.data() + header.index_offset);
+
+    for(uint64_t i = 0; i < header.count; ++i)
+    {
+        records_entry const &e = index[i];
+
+        if(e.offset > length || e.size > length - e.offset || e.path_offset > header.paths_size || e.path_size > header.paths_size - e.path_offset)
+            throw invalid;
+    }
+}
+
+/**
+ * @brief Returns the number of records.
+ * @return The number of records.
+ */
+size_t record_file::size() const
+{
+    return static_cast<size_t>(header.count);
+}
+
+/**
+ * @brief Returns a record.
+ * @param[in] index The index of the record.
+ * @return The record.
+ */
+record_file::record record_file::operator[](size_t i) const
+{
+    records_entry const &e = index[i];
+    auto const *paths      = reinterpret_cast<char const *>(file.data() + header.paths_offset);
+
+    return {std::string_view(paths + e.path_offset, static_cast<size_t>(e.path_size)), file.data() + e.offset, static_cast<size_t>(e.size)};
+}
+
+/**
+ * @brief Writes bytes to the record file.
+ * @param[in] file The record file.
+ * @param[in] data The bytes.
+ * @param[in] size The number of bytes.
+ * @param[in,out] offset The offset of the file, advanced by `size`.
+ * @throws std::runtime_error if the bytes cannot be written.
+ */
+static void write_bytes(std::FILE *file, void const *data, size_t size, uint64_t &offset)
+{
+    if(size != 0 && std::fwrite(data, 1, size, file) != size)
+        throw std::runtime_error("could not write the record file.");
+
+    offset += size;
+}
+
+/**
+ * @brief Pads the record file with zero bytes to a multiple of the alignment.
+ * @param[in] file The record file.
+ * @param[in] alignment The alignment in bytes.
+ * @param[in,out] offset The offset of the file.
+ * @throws std::runtime_error if the bytes cannot be written.
+ */
+static void write_padding(std::FILE *file, uint64_t alignment, uint64_t &offset)
+{
+    static char const zeros[records_alignment] = {};
+
+    size_t const padding = static_cast<size_t>((alignment - offset % alignment) % alignment);
+    write_bytes(file, zeros, padding, offset);
+}
+
+/**
+ * @brief Runs the `pack` subcommand: writes the images from the command-line arguments or the standard input
+ *        (one path per line) into the record file `configuration::output_path`.
+ * @param[in] c The application configuration.
+ * @return The exit code.
+ * @throws std::runtime_error if the record file cannot be written.
+ */
+int run_pack(configuration const &c)
+{
+    std::FILE *file = std::fopen(c.output_path.c_str(), "wb");
+    if(!file)
+        throw std::runtime_error("could not create the record file '" + c.output_path + "'.");
+
+    std::vector<records_entry> entries;
+    std::string paths;
+    std::vector<uchar> buffer;
+    uint64_t offset = 0;
+    int status      = EXIT_SUCCESS;
+
+    auto add = [&](std::string const &path)
+    {
+        if(!c.disable_extension_check && !is_supported_image(std::filesystem::path(path).extension().string()))
+            return;
+
+        try
+        {
+            if(!std::filesystem::is_regular_file(path))
+                throw std::filesystem::filesystem_error("Path is not a regular file or does not exist", path, std::make_error_code(std::errc::no_such_file_or_directory));
+
+            std::uintmax_t const file_sz = std::filesystem::file_size(path);
+            if(file_sz == 0)
+                throw std::length_error("File is empty.");
+            else if(file_sz > c.max_filesize)
+                throw std::length_error("File is too large.");
+
+            buffer = read_file(path, file_sz);
+        }
+        catch(std::exception const &e)
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: could not process the file \'" << path << "\': " << e.what() << std::endl;
+            std::cerr << ss.str();
+
+            status = EXIT_FAILURE;
+            return;
+        }
+
+        write_padding(file, records_alignment, offset);
+        entries.push_back({offset, buffer.size(), paths.size(), path.size()});
+        write_bytes(file, buffer.data(), buffer.size(), offset);
+        paths += path;
+    };
+
+    try
+    {
+        // The header is rewritten last, once the offsets are known
+        records_header header {};
+        write_bytes(file, &header, sizeof(header), offset);
+
+        if(!c.image_files.empty())
+        {
+            for(auto const &path : c.image_files)
+                add(path);
+        }
+        else
+        {
+            std::string line;
+            while(std::getline(std::cin, line))
+                add(line);
+        }
+
+        std::memcpy(header.magic, records_magic, sizeof(records_magic));
+        header.version   = records_version;
+        header.alignment = records_alignment;
+        header.count     = entries.size();
+
+        write_padding(file, alignof(records_entry), offset);
+        header.index_offset = offset;
+        write_bytes(file, entries.data(), entries.size() * sizeof(records_entry), offset);
+
+        header.paths_offset = offset;
+        header.paths_size   = paths.size();
+        write_bytes(file, paths.data(), paths.size(), offset);
+
+        if(std::fseek(file, 0, SEEK_SET) != 0 || std::fwrite(&header, sizeof(header), 1, file) != 1)
+            throw std::runtime_error("could not write the record file.");
+    }
+    catch(...)
+    {
+        std::fclose(file);
+        std::filesystem::remove(c.output_path);
+        throw;
+    }
+
+    if(std::fclose(file) != 0)
+        throw std::runtime_error("could not write the record file '" + c.output_path + "'.");
+
+    std::stringstream ss;
+    ss << "yolo-cls: packed " << entries.size() << " images (" << offset / (1024 * 1024) << " MiB) into '" << c.output_path << "'" << std::endl;
+    std::cerr << ss.str();
+
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file records.h
+ * @brief Defines the packed record file (.ycr) of encoded images and the pack subcommand.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef RECORDS_H
+#define RECORDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+#include "utils.h"
+
+/*
+    A record file stores encoded images for repeated classification without opening every file.
+    All integers are little-endian (the native byte order of the supported platforms).
+        records_header                  At offset 0, padded to `alignment`.
+        image blobs                     Every blob starts at a multiple of `alignment`.
+        records_entry[count]            The index, at `index_offset`.
+        paths                           The original paths, concatenated, at `paths_offset`.
+*/
+
+/// Identifies a record file.
+inline constexpr char records_magic[8] = {'Y', 'C', 'R', 'E', 'C', 'O', 'R', 'D'};
+
+/// The version of the layout.
+inline constexpr uint32_t records_version = 1;
+
+/// The alignment of the image blobs written by `yolo-cls pack`, a page.
+inline constexpr uint32_t records_alignment = 4096;
+
+/**
+ * @struct records_header
+ * @brief The header at the start of a record file.
+ */
+struct records_header
+{
+    char magic[8];         ///< `records_magic`.
+    uint32_t version;      ///< `records_version`.
+    uint32_t alignment;    ///< The alignment of the image blobs in bytes.
+    uint64_t count;        ///< The number of records.
+    uint64_t index_offset; ///< The offset of the index.
+    uint64_t paths_offset; ///< The offset of the path table.
+    uint64_t paths_size;   ///< The size of the path table in bytes.
+};
+
+/**
+ * @struct records_entry
+ * @brief An entry of the index of a record file.
+ */
+struct records_entry
+{
+    uint64_t offset;      ///< The offset of the image blob.
+    uint64_t size;        ///< The size of the image blob in bytes.
+    uint64_t path_offset; ///< The offset of the path in the path table.
+    uint64_t path_size;   ///< The size of the path in bytes.
+};
+
+/**
+ * @class record_file
+ * @brief A read-only memory mapping of a record file.
+ */
+class record_file
+{
+public:
+    /**
+     * @struct record
+     * @brief An image of the record file. The memory belongs to the mapping.
+     */
+    struct record
+    {
+        std::string_view path; ///< The original path of the image.
+        uchar const *data;     ///< The encoded image bytes.
+        size_t size;           ///< The size of the image in bytes.
+    };
+
+    /**
+     * @brief Maps a record file and validates its index.
+     * @details The kernel is told that the file is read sequentially (`madvise(MADV_SEQUENTIAL)`).
+     * @param[in] path The path to the record file.
+     * @throws std::runtime_error if the file cannot be mapped or is not a valid record file.
+     */
+    explicit record_file(std::string const &path);
+
+    record_file(record_file const &)            = delete;
+    record_file &operator=(record_file const &) = delete;
+
+    /**
+     * @brief Returns the number of records.
+     * @return The number of records.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns a record.
+     * @param[in] index The index of the record.
+     * @return The record.
+     */
+    record operator[](size_t index) const;
+
+private:
+    mapped_file file;                     ///< The mapping.
+    records_header header      = {};      ///< The header.
+    records_entry const *index = nullptr; ///< The index.
+};
+
+/**
+ * @brief Runs the `pack` subcommand: writes the images from the command-line arguments or the standard input
+ *        (one path per line) into the record file `configuration::output_path`.
+ * @param[in] c The application configuration.
+ * @return The exit code.
+ * @throws std::runtime_error if the record file cannot be written.
+ */
+int run_pack(configuration const &c);
+
+#endif // RECORDS_H
\ No newline at end of file
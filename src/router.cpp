@@ -0,0 +1,269 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file router.cpp
+ * @brief Implements the model router that hot-reloads the models and splits the images between a primary and a canary model.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "router.h"
+
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Loads the models of every variant and starts the reload thread.
+ * @param[in] weights The relative share of the images routed to every variant (e.g., `{0.9, 0.1}`).
+ * @param[in] load Builds the classifier of a variant, it is called again on every reload.
+ * @param[in] swapped Called on the reload thread after the models are swapped (e.g., to drop cached results). May be empty.
+ * @throws std::exception if a model cannot be loaded.
+ */
+model_router::model_router(std::vector<double> const &weights, loader load, std::function<void()> swapped) : load(std::move(load)), swapped(std::move(swapped))
+{
+    if(weights.empty())
+        throw std::invalid_argument("No model variant provided.");
+
+    double const total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    if(!(total > 0.0))
+        throw std::invalid_argument("The weights of the model variants must be positive.");
+
+    double sum = 0.0;
+    for(double w : weights)
+    {
+        sum += w;
+        cumulative.push_back(sum / total);
+    }
+
+    // The first load is synchronous, so that a broken model stops the application
+    for(size_t i = 0; i < weights.size(); ++i)
+        current.push_back(std::make_shared<classifier>(this->load(i)));
+
+    reloader = std::thread(&model_router::reload_loop, this);
+}
+
+/**
+ * @brief Stops the reload and watch threads.
+ */
+model_router::~model_router()
+{
+    {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        stopping = true;
+    }
+    watch_cv.notify_all();
+
+    if(watcher.joinable())
+        watcher.join();
+
+    requests.close();
+    reloader.join();
+}
+
+/**
+ * @brief Returns the current classifiers, one per variant.
+ * @return The snapshot of the classifiers, valid even if the models are swapped meanwhile.
+ */
+std::vector<std::shared_ptr<classifier>> model_router::models() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+/**
+ * @brief Picks the variant of an image by the weights.
+ * @return The index of the variant.
+ */
+size_t model_router::route() const
+{
+    if(cumulative.size() == 1)
+        return 0;
+
+    thread_local std::mt19937 generator {std::random_device {}()};
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    double const r = distribution(generator);
+    for(size_t i = 0; i + 1 < cumulative.size(); ++i)
+    {
+        if(r < cumulative[i])
+            return i;
+    }
+
+    return cumulative.size() - 1;
+}
+
+/**
+ * @brief Requests a reload of all models.
+ * @details Requests that arrive while a reload is running are served by the next reload together.
+ * @param[in] done Called on the reload thread when the reload has finished. May be empty.
+ */
+void model_router::reload(reload_callback done)
+{
+    requests.push(std::move(done));
+}
+
+/**
+ * @brief Starts a thread that reloads the models when any of the files changes.
+ * @details A reload starts once the modification times have been stable for one interval,
+ *          so that a model file that is still being written is not loaded. A failed reload is retried every interval.
+ * @param[in] paths The model and class files to watch.
+ * @param[in] interval The polling interval.
+ */
+void model_router::watch(std::vector<std::string> const &paths, std::chrono::milliseconds interval)
+{
+    watcher = std::thread(&model_router::watch_loop, this, paths, interval);
+}
+
+/**
+ * @brief The reload thread function. Reloads the models until the queue of requests is closed.
+ */
+void model_router::reload_loop()
+{
+    while(true)
+    {
+        // All requests queued so far are served by a single reload
+        auto callbacks = requests.pop_batch(std::numeric_limits<size_t>::max());
+        if(callbacks.empty())
+            break;
+
+        bool success = false;
+        std::string message;
+
+        try
+        {
+            auto const start = std::chrono::steady_clock::now();
+
+            // Build and warm up the new models while the old ones keep serving
+            std::vector<std::shared_ptr<classifier>> next;
+            for(size_t i = 0; i < cumulative.size(); ++i)
+            {
+                next.push_back(std::make_shared<classifier>(load(i)));
+                next.back()->warm_up();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                current.swap(next);
+            }
+
+            if(swapped)
+                swapped();
+
+            // The old models are released here, or by the last batch still using them
+            next.clear();
+
+            auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+            std::stringstream ss;
+            ss << "reloaded " << cumulative.size() << (cumulative.size() == 1 ? " model" : " models") << " in " << elapsed.count() << "ms";
+
+            success = true;
+            message = ss.str();
+        }
+        catch(std::exception const &e)
+        {
+            message = std::string("could not reload the models: ") + e.what();
+        }
+
+        for(auto const &done : callbacks)
+        {
+            if(done)
+                done(success, message);
+        }
+    }
+}
+
+/**
+ * @brief The watch thread function. Polls the modification times of the files until the router is destroyed.
+ * @param[in] paths The files to watch.
+ * @param[in] interval The polling interval.
+ */
+void model_router::watch_loop(std::vector<std::string> paths, std::chrono::milliseconds interval)
+{
+    auto modification_times = [&paths]()
+    {
+        std::vector<std::filesystem::file_time_type> result;
+        for(auto const &path : paths)
+        {
+            std::error_code ec;
+            result.push_back(std::filesystem::last_write_time(path, ec));
+        }
+
+        return result;
+    };
+
+    /**
+     * @struct watch_state
+     * @brief The files of the served models, shared with the reload callback that may run after this thread has stopped.
+     */
+    struct watch_state
+    {
+        std::mutex mutex;                                    ///< Mutex to protect the state.
+        std::vector<std::filesystem::file_time_type> loaded; ///< The modification times of the files of the served models.
+        bool reloading = false;                              ///< True while a reload requested by this thread runs.
+    };
+
+    auto const state = std::make_shared<watch_state>();
+    state->loaded    = modification_times();
+    auto previous    = state->loaded;
+
+    std::unique_lock<std::mutex> lock(watch_mutex);
+    while(!watch_cv.wait_for(lock, interval, [this] { return stopping; }))
+    {
+        auto now = modification_times();
+
+        // Reload only after the files have stopped changing for one interval.
+        // The files count as loaded only once the reload succeeds, a failed reload is retried on the next interval.
+        bool changed = false;
+        {
+            std::lock_guard<std::mutex> state_lock(state->mutex);
+            changed = !state->reloading && now != state->loaded && now == previous;
+            if(changed)
+                state->reloading = true;
+        }
+
+        if(changed)
+        {
+            reload([state, now](bool success, std::string const &message)
+            {
+                {
+                    std::lock_guard<std::mutex> state_lock(state->mutex);
+                    state->reloading = false;
+                    if(success)
+                        state->loaded = now;
+                }
+
+                std::stringstream ss;
+                ss << "yolo-cls: " << message << std::endl;
+                std::cerr << ss.str();
+            });
+        }
+
+        previous = std::move(now);
+    }
+}
\ No newline at end of file
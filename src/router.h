@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file router.h
+ * @brief Defines the model router that hot-reloads the models and splits the images between a primary and a canary model.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "classifier.h"
+#include "tsqueue.h"
+
+/**
+ * @class model_router
+ * @brief Owns the classifiers of all model variants, reloads them in the background and routes images between them.
+ *
+ * Variant 0 is the primary model, any further variant (e.g., a canary) receives its weighted share of the images.
+ * A reload builds and warms up a new classifier for every variant on the reload thread while the worker threads
+ * keep using the old ones, then swaps all variants at once. A batch holds the snapshot returned by `models`,
+ * so the jobs in flight finish on the models they started with and the old models are freed after the last batch.
+ */
+class model_router
+{
+public:
+    /// Builds the classifier of a variant from the model files.
+    using loader = std::function<classifier(size_t variant)>;
+
+    /// Receives the result of a reload, true and a summary on success, false and the error otherwise.
+    using reload_callback = std::function<void(bool, std::string const &)>;
+
+    /**
+     * @brief Loads the models of every variant and starts the reload thread.
+     * @param[in] weights The relative share of the images routed to every variant (e.g., `{0.9, 0.1}`).
+     * @param[in] load Builds the classifier of a variant, it is called again on every reload.
+     * @param[in] swapped Called on the reload thread after the models are swapped (e.g., to drop cached results). May be empty.
+     * @throws std::exception if a model cannot be loaded.
+     */
+    model_router(std::vector<double> const &weights, loader load, std::function<void()> swapped = {});
+
+    /**
+     * @brief Stops the reload and watch threads.
+     */
+    ~model_router();
+
+    model_router(model_router const &)            = delete;
+    model_router &operator=(model_router const &) = delete;
+
+    /**
+     * @brief Returns the current classifiers, one per variant.
+     * @return The snapshot of the classifiers, valid even if the models are swapped meanwhile.
+     */
+    std::vector<std::shared_ptr<classifier>> models() const;
+
+    /**
+     * @brief Picks the variant of an image by the weights.
+     * @return The index of the variant.
+     */
+    size_t route() const;
+
+    /**
+     * @brief Requests a reload of all models.
+     * @details Requests that arrive while a reload is running are served by the next reload together.
+     * @param[in] done Called on the reload thread when the reload has finished. May be empty.
+     */
+    void reload(reload_callback done);
+
+    /**
+     * @brief Starts a thread that reloads the models when any of the files changes.
+     * @details A reload starts once the modification times have been stable for one interval,
+     *          so that a model file that is still being written is not loaded. A failed reload is retried every interval.
+     * @param[in] paths The model and class files to watch.
+     * @param[in] interval The polling interval.
+     */
+    void watch(std::vector<std::string> const &paths, std::chrono::milliseconds interval);
+
+private:
+    /**
+     * @brief The reload thread function. Reloads the models until the queue of requests is closed.
+     */
+    void reload_loop();
+
+    /**
+     * @brief The watch thread function. Polls the modification times of the files until the router is destroyed.
+     * @param[in] paths The files to watch.
+     * @param[in] interval The polling interval.
+     */
+    void watch_loop(std::vector<std::string> paths, std::chrono::milliseconds interval);
+
+    std::vector<double> cumulative;                   ///< The cumulative weights of the variants, normalized to 1.
+    loader load;                                      ///< Builds the classifier of a variant.
+    std::function<void()> swapped;                    ///< Called after the models are swapped.
+
+    mutable std::mutex mutex;                         ///< Mutex to protect access to the current models.
+    std::vector<std::shared_ptr<classifier>> current; ///< The current classifier of every variant.
+
+    tsqueue<reload_callback> requests;                ///< The pending reload requests.
+    std::thread reloader;                             ///< The reload thread.
+
+    std::mutex watch_mutex;                           ///< Mutex to protect `stopping`.
+    std::condition_variable watch_cv;                 ///< Wakes the watch thread on destruction.
+    bool stopping = false;                            ///< True once the router is being destroyed.
+    std::thread watcher;                              ///< The watch thread, if started.
+};
+
+#endif // ROUTER_H
\ No newline at end of file
@@ -0,0 +1,1128 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file server.cpp
+ * @brief Defines the daemon mode (`yolo-cls serve`) and its client.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "server.h"
+#include "http_server.h"
+#include "admission.h"
+#include "shm_ring.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#ifndef _WIN32
+    #include <csignal>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+#ifdef __linux__
+    #include <sys/eventfd.h>
+    #include <sys/mman.h>
+#endif
+
+#ifndef _WIN32
+
+/// The maximum number of concurrent connections of the Unix socket, every connection has a thread of its own.
+static constexpr size_t max_unix_connections = 256;
+
+/**
+ * @brief Throws the error of the last failed system call.
+ * @param[in] what The description of the failed operation.
+ * @throws std::system_error always.
+ */
+[[noreturn]] static void throw_errno(std::string const &what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief Creates the address of a Unix socket.
+ * @param[in] path The path to the socket.
+ * @return The address.
+ * @throws std::invalid_argument if the path is too long.
+ */
+static sockaddr_un make_address(std::string const &path)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if(path.empty() || path.size() >= sizeof(address.sun_path))
+        throw std::invalid_argument("Invalid socket path '" + path + "'.");
+
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+/**
+ * @brief Writes the whole buffer to a socket.
+ * @param[in] fd The socket.
+ * @param[in] data The data to write.
+ * @param[in] size The number of bytes to write.
+ * @return False if the peer has closed the connection.
+ */
+static bool send_all(int fd, char const *data, size_t size)
+{
+    while(size > 0)
+    {
+        ssize_t const sent = ::send(fd, data, size, MSG_NOSIGNAL);
+
+        if(sent < 0 && errno == EINTR)
+            continue;
+
+        if(sent <= 0)
+            return false;
+
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+
+    return true;
+}
+
+/**
+ * @class socket_reader
+ * @brief A buffered reader of a socket.
+ */
+class socket_reader
+{
+public:
+    /**
+     * @brief Constructs a reader of the socket.
+     * @param[in] fd The socket.
+     */
+    explicit socket_reader(int fd) : fd(fd) {}
+
+    /**
+     * @brief Returns the next byte without consuming it.
+     * @return The byte, or -1 at the end of the stream.
+     */
+    int peek()
+    {
+        if(position == end && !fill())
+            return -1;
+
+        return static_cast<unsigned char>(buffer[position]);
+    }
+
+    /**
+     * @brief Reads a line without the trailing newline. The last line of the stream may lack the newline.
+     * @param[out] line The line.
+     * @return False at the end of the stream.
+     */
+    bool read_line(std::string &line)
+    {
+        line.clear();
+
+        while(position < end || fill())
+        {
+            char const *begin   = buffer + position;
+            char const *newline = static_cast<char const *>(std::memchr(begin, '\n', end - position));
+
+            if(newline)
+            {
+                line.append(begin, newline);
+                position += static_cast<size_t>(newline - begin) + 1;
+                return true;
+            }
+
+            line.append(begin, end - position);
+            position = end;
+        }
+
+        return !line.empty();
+    }
+
+    /**
+     * @brief Reads exactly `size` bytes.
+     * @param[out] data The destination, or nullptr to discard the bytes.
+     * @param[in] size The number of bytes to read.
+     * @return False if the stream ended before `size` bytes were read.
+     */
+    bool read(void *data, size_t size)
+    {
+        auto *out = static_cast<char *>(data);
+
+        while(size > 0)
+        {
+            if(position == end && !fill())
+                return false;
+
+            size_t const count = std::min(size, end - position);
+
+            if(out)
+            {
+                std::memcpy(out, buffer + position, count);
+                out += count;
+            }
+
+            position += count;
+            size -= count;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Discards the buffered data.
+     */
+    void discard()
+    {
+        position = end;
+    }
+
+    /**
+     * @brief Checks whether data has been read from the socket but not consumed yet.
+     * @return True if the next read does not need the socket.
+     */
+    bool buffered() const
+    {
+        return position < end;
+    }
+
+private:
+    /**
+     * @brief Reads more data from the socket into the empty buffer.
+     * @return False at the end of the stream.
+     */
+    bool fill()
+    {
+        while(true)
+        {
+            ssize_t const received = ::recv(fd, buffer, sizeof(buffer), 0);
+
+            if(received < 0 && errno == EINTR)
+                continue;
+
+            if(received <= 0)
+                return false;
+
+            position = 0;
+            end      = static_cast<size_t>(received);
+            return true;
+        }
+    }
+
+    int fd;
+    char buffer[64 * 1024];
+    size_t position = 0;
+    size_t end      = 0;
+};
+
+/**
+ * @struct connection
+ * @brief A client connection of the daemon, shared by the reader thread and the reply callbacks of its jobs.
+ */
+struct connection
+{
+    int fd = -1;                        ///< The socket.
+    std::mutex write_mutex;             ///< Serializes the response lines.
+    std::mutex mutex;                   ///< Protects `pending`.
+    std::condition_variable cv;         ///< Signals that a job has been answered.
+    size_t pending = 0;                 ///< The number of jobs that have not been answered yet.
+    std::atomic<bool> finished = false; ///< True once the reader thread is done with the connection.
+
+    /**
+     * @brief Closes the socket.
+     */
+    ~connection()
+    {
+        if(fd >= 0)
+            ::close(fd);
+    }
+
+    /**
+     * @brief Sends a response line.
+     * @param[in] status `+` for a result, `-` for an error.
+     * @param[in] line The response without the status and the newline.
+     */
+    void send_line(char status, std::string const &line)
+    {
+        std::string response;
+        response.reserve(line.size() + 2);
+        response += status;
+        response += line;
+        response += '\n';
+
+        // A client that has gone away simply does not get its results
+        std::lock_guard<std::mutex> lock(write_mutex);
+        send_all(fd, response.data(), response.size());
+    }
+};
+
+#ifdef __linux__
+
+/**
+ * @struct shm_session
+ * @brief The shared-memory ring of a connection, shared by the connection thread and the reply callbacks of its jobs.
+ */
+struct shm_session
+{
+    int memory_fd         = -1;      ///< The memfd of the ring.
+    int submit_fd         = -1;      ///< The submission doorbell.
+    int complete_fd       = -1;      ///< The completion doorbell.
+    unsigned char *base   = nullptr; ///< The mapped ring.
+    size_t size           = 0;       ///< The size of the ring in bytes.
+    uint32_t slots        = 0;       ///< The number of slots.
+    uint32_t slot_size    = 0;       ///< The payload size of a slot in bytes.
+    std::mutex complete_mutex;       ///< Serializes the worker threads appending to the completion queue.
+
+    /**
+     * @brief Unmaps the ring and closes the file descriptors.
+     */
+    ~shm_session()
+    {
+        if(base)
+            ::munmap(base, size);
+
+        for(int fd : {memory_fd, submit_fd, complete_fd})
+        {
+            if(fd >= 0)
+                ::close(fd);
+        }
+    }
+
+    /**
+     * @brief Returns the header of the ring.
+     * @return The header.
+     */
+    shm_ring_header *header() const
+    {
+        return reinterpret_cast<shm_ring_header *>(base);
+    }
+
+    /**
+     * @brief Returns the header of a slot.
+     * @param[in] index The index of the slot.
+     * @return The header, followed by the payload.
+     */
+    shm_slot_header *slot(uint32_t index) const
+    {
+        return reinterpret_cast<shm_slot_header *>(base + shm_slot_offset(slots, slot_size, index));
+    }
+
+    /**
+     * @brief Writes the result into a slot and appends the slot to the completion queue.
+     * @param[in] index The index of the slot.
+     * @param[in] status The status of the job.
+     * @param[in] line The result line or the error message.
+     */
+    void complete(uint32_t index, job_status status, std::string const &line)
+    {
+        shm_slot_header *s = slot(index);
+        s->status          = static_cast<int32_t>(status);
+        s->result_size     = static_cast<uint32_t>(std::min(line.size(), shm_result_size));
+        std::memcpy(s->result, line.data(), s->result_size);
+
+        {
+            std::lock_guard<std::mutex> lock(complete_mutex);
+
+            auto *queue         = reinterpret_cast<uint32_t *>(base + shm_complete_offset(slots));
+            uint32_t const head = header()->complete_head.load(std::memory_order_relaxed);
+
+            queue[head % slots] = index;
+            header()->complete_head.store(head + 1, std::memory_order_release);
+        }
+
+        uint64_t const value = 1;
+        [[maybe_unused]] auto const written = ::write(complete_fd, &value, sizeof(value));
+    }
+};
+
+/**
+ * @brief Creates the shared memory and the doorbells of a ring.
+ * @param[in] slots The number of slots.
+ * @param[in] slot_size The payload size of a slot in bytes.
+ * @return The session.
+ * @throws std::system_error if the shared memory or the doorbells cannot be created.
+ */
+static std::shared_ptr<shm_session> create_shm_session(uint32_t slots, uint32_t slot_size)
+{
+    auto session       = std::make_shared<shm_session>();
+    session->slots     = slots;
+    session->slot_size = slot_size;
+    session->size      = shm_ring_size(slots, slot_size);
+
+    session->memory_fd = ::memfd_create("yolo-cls-ring", MFD_CLOEXEC);
+    if(session->memory_fd < 0)
+        throw_errno("could not create the shared memory");
+
+    if(::ftruncate(session->memory_fd, static_cast<off_t>(session->size)) != 0)
+        throw_errno("could not resize the shared memory");
+
+    void *base = ::mmap(nullptr, session->size, PROT_READ | PROT_WRITE, MAP_SHARED, session->memory_fd, 0);
+    if(base == MAP_FAILED)
+        throw_errno("could not map the shared memory");
+
+    session->base = static_cast<unsigned char *>(base);
+
+    session->submit_fd   = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    session->complete_fd = ::eventfd(0, EFD_CLOEXEC);
+    if(session->submit_fd < 0 || session->complete_fd < 0)
+        throw_errno("could not create an eventfd");
+
+    // The memfd is zero-filled, so the queues start empty
+    shm_ring_header *header = new(session->base) shm_ring_header();
+    header->magic           = shm_ring_magic;
+    header->version         = shm_ring_version;
+    header->slot_count      = slots;
+    header->slot_size       = slot_size;
+
+    return session;
+}
+
+/**
+ * @brief Sends a response line with file descriptors attached (SCM_RIGHTS).
+ * @param conn The connection.
+ * @param[in] line The response, including the status and the newline.
+ * @param[in] fds The file descriptors to pass.
+ * @return False if the peer has closed the connection.
+ */
+static bool send_fds(connection &conn, std::string const &line, std::vector<int> const &fds)
+{
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+
+    iovec io {const_cast<char *>(line.data()), line.size()};
+    msghdr message {};
+    message.msg_iov        = &io;
+    message.msg_iovlen     = 1;
+    message.msg_control    = control.data();
+    message.msg_controllen = control.size();
+
+    cmsghdr *header    = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type  = SCM_RIGHTS;
+    header->cmsg_len   = CMSG_LEN(sizeof(int) * fds.size());
+    std::memcpy(CMSG_DATA(header), fds.data(), sizeof(int) * fds.size());
+
+    std::lock_guard<std::mutex> lock(conn.write_mutex);
+
+    ssize_t sent = 0;
+    do
+    {
+        sent = ::sendmsg(conn.fd, &message, MSG_NOSIGNAL);
+    } while(sent < 0 && errno == EINTR);
+
+    // The descriptors travel with the first byte, the rest of the line may follow separately
+    if(sent <= 0)
+        return false;
+
+    return send_all(conn.fd, line.data() + sent, line.size() - static_cast<size_t>(sent));
+}
+
+/**
+ * @brief Serves the shared-memory ring of a connection (see `shm_ring.h`) until the producer closes the socket.
+ * @param conn The connection.
+ * @param reader The reader of the connection, anything the producer sends after `!shm` is discarded.
+ * @param[in] arguments The arguments of the `!shm` command, the number of slots and the payload size of a slot (e.g., `16 8mb`).
+ * @param[in] submit Queues a job of the connection, the reply of the job is set.
+ * @param[in] c The application configuration.
+ */
+static void run_shm_ring(std::shared_ptr<connection> const &conn, socket_reader &reader, std::string const &arguments, std::function<void(job)> const &submit, configuration const &c)
+{
+    std::shared_ptr<shm_session> session;
+
+    try
+    {
+        std::stringstream ss(arguments);
+        std::string slots_str;
+        std::string slot_size_str;
+        ss >> slots_str >> slot_size_str;
+
+        if(slots_str.empty() || slot_size_str.empty() || slots_str.find_first_not_of("0123456789") != std::string::npos)
+            throw std::invalid_argument("Invalid ring '" + arguments + "', expected !shm <slots> <slot_size>.");
+
+        unsigned long long const slots = std::stoull(slots_str);
+        uint64_t const slot_size       = string_unit_to_numeric(slot_size_str);
+
+        if(slots == 0 || slots > 65536 || slot_size == 0 || slot_size > c.max_filesize || slot_size > std::numeric_limits<uint32_t>::max())
+            throw std::invalid_argument("Invalid ring '" + arguments + "', up to 65536 slots of up to --max-filesize bytes.");
+
+        session = create_shm_session(static_cast<uint32_t>(slots), static_cast<uint32_t>(slot_size));
+    }
+    catch(std::exception const &e)
+    {
+        conn->send_line('-', e.what());
+        return;
+    }
+
+    std::string const reply = "+shm " + std::to_string(session->slots) + " " + std::to_string(session->slot_size) + "\n";
+    if(!send_fds(*conn, reply, {session->memory_fd, session->submit_fd, session->complete_fd}))
+        return;
+
+    shm_ring_header *header = session->header();
+    auto const *queue       = reinterpret_cast<uint32_t const *>(session->base + shm_submit_offset());
+    uint32_t tail           = 0;
+
+    auto submit_slot = [&](uint32_t index)
+    {
+        shm_slot_header *slot = session->slot(index);
+        unsigned char *data   = shm_slot_payload(slot);
+        std::string const name = "shm:" + std::to_string(index);
+
+        job request {name, ""};
+
+        // The producer can rewrite the header at any time, every field is read once and only the copies are used
+        uint32_t const format = shm_read_once(slot->format);
+
+        if(format == static_cast<uint32_t>(shm_format::bgr))
+        {
+            uint32_t const width  = shm_read_once(slot->width);
+            uint32_t const height = shm_read_once(slot->height);
+            uint64_t const row    = static_cast<uint64_t>(width) * 3;
+            uint32_t const stride = shm_read_once(slot->step);
+            uint64_t const step   = stride ? stride : row;
+
+            if(width == 0 || height == 0 || step < row || step * height > session->slot_size)
+            {
+                session->complete(index, job_status::failed, "could not process the file '" + name + "': Invalid frame size.");
+                return;
+            }
+
+            // The worker thread classifies the pixels in place
+            request.image = cv::Mat(static_cast<int>(height), static_cast<int>(width), CV_8UC3, data, static_cast<size_t>(step));
+        }
+        else if(format == static_cast<uint32_t>(shm_format::encoded))
+        {
+            uint32_t const size = shm_read_once(slot->size);
+
+            if(size == 0 || size > session->slot_size)
+            {
+                session->complete(index, job_status::failed, "could not process the file '" + name + "': " + (size == 0 ? "File is empty." : "File is too large."));
+                return;
+            }
+
+            // The worker thread decodes the bytes in place, the session outlives the job
+            request.encoded = cv::Mat(1, static_cast<int>(size), CV_8UC1, data);
+            request.owner   = session;
+        }
+        else
+        {
+            session->complete(index, job_status::failed, "could not process the file '" + name + "': Unknown frame format.");
+            return;
+        }
+
+        request.reply = [session, index](job_status status, std::string const &line) { session->complete(index, status, line); };
+        submit(std::move(request));
+    };
+
+    while(true)
+    {
+        // The socket only tells that the producer is gone
+        if(reader.buffered())
+            reader.discard();
+
+        pollfd fds[2] = {{conn->fd, POLLIN, 0}, {session->submit_fd, POLLIN, 0}};
+
+        if(::poll(fds, 2, -1) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            break;
+        }
+
+        if(fds[0].revents != 0 && reader.peek() < 0)
+            break;
+
+        if((fds[1].revents & POLLIN) == 0)
+            continue;
+
+        // Reset the doorbell before reading the queue, so that no submission is missed
+        uint64_t value = 0;
+        [[maybe_unused]] auto const received = ::read(session->submit_fd, &value, sizeof(value));
+
+        uint32_t const head = header->submit_head.load(std::memory_order_acquire);
+
+        // A producer that breaks the protocol loses the ring
+        if(head - tail > session->slots)
+        {
+            conn->send_line('-', "invalid submission queue position");
+            break;
+        }
+
+        for(; tail != head; ++tail)
+        {
+            uint32_t const index = shm_read_once(queue[tail % session->slots]);
+
+            if(index < session->slots)
+                submit_slot(index);
+        }
+
+        header->submit_tail.store(tail, std::memory_order_release);
+    }
+}
+
+#endif
+
+/**
+ * @brief Reads the requests of a connection and pushes them to the input queue until the client closes its write side.
+ *        Returns once every request of the connection has been answered.
+ * @param conn The connection.
+ * @param admission The admission control that queues the jobs for the worker threads.
+ * @param router The models, reloaded by the `!reload` command.
+ * @param[in] stats The statistics of the worker threads.
+ * @param[in] c The application configuration.
+ */
+static void handle_connection(std::shared_ptr<connection> conn, admission_control &admission, model_router &router, serving_stats const &stats, configuration const &c)
+{
+    socket_reader reader(conn->fd);
+    std::filesystem::path directory;
+    std::chrono::milliseconds deadline {0};
+    job_priority priority = job_priority::interactive;
+    size_t index          = 0;
+
+    auto submit = [&](job request)
+    {
+        {
+            std::lock_guard<std::mutex> lock(conn->mutex);
+            ++conn->pending;
+        }
+
+        request.received = std::chrono::steady_clock::now();
+
+        if(deadline.count() > 0)
+            request.deadline = request.received + deadline;
+
+        request.priority = priority;
+
+        // A job of the shared-memory ring replies into the ring instead of the socket
+        request.reply = [conn, send = std::move(request.reply)](job_status status, std::string const &line)
+        {
+            if(send)
+                send(status, line);
+            else
+                conn->send_line(status == job_status::done ? '+' : '-', line);
+
+            {
+                std::lock_guard<std::mutex> lock(conn->mutex);
+                --conn->pending;
+            }
+            conn->cv.notify_all();
+        };
+
+        admission.submit(std::move(request));
+    };
+
+    while(true)
+    {
+        int const first = reader.peek();
+        if(first < 0)
+            break;
+
+        ++index;
+
+        // Encoded image bytes
+        if(first == '\0')
+        {
+            unsigned char header[5];
+            if(!reader.read(header, sizeof(header)))
+                break;
+
+            uint32_t const size = static_cast<uint32_t>(header[1]) | (static_cast<uint32_t>(header[2]) << 8) | (static_cast<uint32_t>(header[3]) << 16) | (static_cast<uint32_t>(header[4]) << 24);
+            std::string const name = "bytes:" + std::to_string(index);
+
+            if(size == 0 || size > c.max_filesize)
+            {
+                if(!reader.read(nullptr, size))
+                    break;
+
+                conn->send_line('-', "could not process the file '" + name + "': " + (size == 0 ? "File is empty." : "File is too large."));
+                continue;
+            }
+
+            job request {name, "", std::vector<uchar>(size)};
+            if(!reader.read(request.data.data(), size))
+                break;
+
+            submit(std::move(request));
+            continue;
+        }
+
+        std::string line;
+        if(!reader.read_line(line))
+            break;
+
+        if(line.empty())
+            continue;
+
+        // Commands
+        if(line.front() == '!')
+        {
+            if(line.rfind("!cwd ", 0) == 0)
+                directory = line.substr(5);
+            else if(line.rfind("!deadline-ms ", 0) == 0)
+            {
+                // An invalid deadline keeps the previous one
+                if(auto const ms = parse_integer(std::string_view(line).substr(13), 0, max_deadline_ms))
+                    deadline = std::chrono::milliseconds(*ms);
+                else
+                    conn->send_line('-', "invalid deadline '" + line.substr(13) + "', expected milliseconds from 0 to " + std::to_string(max_deadline_ms));
+            }
+            else if(line == "!priority interactive" || line == "!priority bulk")
+                priority = (line == "!priority bulk") ? job_priority::bulk : job_priority::interactive;
+            else if(line == "!stats")
+                conn->send_line('+', stats.report());
+            else if(line.rfind("!shm ", 0) == 0)
+            {
+#ifdef __linux__
+                run_shm_ring(conn, reader, line.substr(5), submit, c);
+                break;
+#else
+                conn->send_line('-', "shared memory rings are not supported on this platform");
+#endif
+            }
+            else if(line == "!reload")
+            {
+                {
+                    std::lock_guard<std::mutex> lock(conn->mutex);
+                    ++conn->pending;
+                }
+
+                router.reload(
+                    [conn](bool success, std::string const &message)
+                    {
+                        conn->send_line(success ? '+' : '-', message);
+
+                        {
+                            std::lock_guard<std::mutex> lock(conn->mutex);
+                            --conn->pending;
+                        }
+                        conn->cv.notify_all();
+                    });
+            }
+            else
+                conn->send_line('-', "unknown command '" + line + "'");
+
+            continue;
+        }
+
+        // Image paths
+        std::filesystem::path const path = line;
+        submit(job {line, (directory.empty() || path.is_absolute()) ? line : (directory / path).string()});
+    }
+
+    // Wait for the remaining results
+    std::unique_lock<std::mutex> lock(conn->mutex);
+    conn->cv.wait(lock, [&] { return conn->pending == 0; });
+
+    // The client reads until the end of the stream
+    ::shutdown(conn->fd, SHUT_WR);
+}
+
+/**
+ * @brief Creates the listening Unix socket of the daemon.
+ * @param[in] path The path to the socket, created with mode 0600. A socket left by a previous daemon is replaced.
+ * @return The listening socket.
+ * @throws std::system_error if the socket cannot be created.
+ */
+static int listen_unix_socket(std::string const &path)
+{
+    sockaddr_un const address = make_address(path);
+
+    int const listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(listen_fd < 0)
+        throw_errno("could not create a socket");
+
+    // Remove the socket left by a previous daemon
+    struct stat st;
+    if(::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        ::unlink(path.c_str());
+
+    // Only the owner may connect: the socket is created with mode 0600
+    mode_t const mask = ::umask(0177);
+    int const bound   = ::bind(listen_fd, reinterpret_cast<sockaddr const *>(&address), sizeof(address));
+    ::umask(mask);
+    if(bound != 0 || ::listen(listen_fd, SOMAXCONN) != 0)
+    {
+        int const error = errno;
+        ::close(listen_fd);
+        throw std::system_error(error, std::generic_category(), "could not listen on '" + path + "'");
+    }
+
+    std::stringstream ss;
+    ss << "yolo-cls: listening on '" << path << "'" << std::endl;
+    std::cerr << ss.str();
+
+    return listen_fd;
+}
+
+/**
+ * @brief Accepts connections on the Unix socket until `stop_fd` becomes readable,
+ *        then waits until every received request has been answered and removes the socket.
+ * @details Up to `max_unix_connections` connections are served at a time, further connections are refused with an error line.
+ * @param[in] listen_fd The listening socket, closed on return.
+ * @param[in] stop_fd The file descriptor that becomes readable when the daemon is stopped.
+ * @param admission The admission control that queues the jobs for the worker threads.
+ * @param router The models, reloaded by the `!reload` command.
+ * @param[in] stats The statistics of the worker threads.
+ * @param[in] c The application configuration.
+ */
+static void run_unix_socket(int listen_fd, int stop_fd, admission_control &admission, model_router &router, serving_stats const &stats, configuration const &c)
+{
+    std::list<std::pair<std::shared_ptr<connection>, std::thread>> connections;
+
+    while(true)
+    {
+        pollfd fds[2] = {{listen_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+
+        if(::poll(fds, 2, -1) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+
+            break;
+        }
+
+        if(fds[1].revents != 0)
+            break;
+
+        if((fds[0].revents & POLLIN) == 0)
+            continue;
+
+        int const fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if(fd < 0)
+            continue;
+
+        // Join the threads of closed connections
+        for(auto it = connections.begin(); it != connections.end();)
+        {
+            if(it->first->finished)
+            {
+                it->second.join();
+                it = connections.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        // A connection beyond the limit is refused instead of starting another thread
+        if(connections.size() >= max_unix_connections)
+        {
+            std::string const refusal = "-too many connections, at most " + std::to_string(max_unix_connections) + "\n";
+            send_all(fd, refusal.data(), refusal.size());
+            ::close(fd);
+            continue;
+        }
+
+        auto conn = std::make_shared<connection>();
+        conn->fd  = fd;
+
+        std::thread reader(
+            [conn, &admission, &router, &stats, &c]
+            {
+                handle_connection(conn, admission, router, stats, c);
+                conn->finished = true;
+            });
+
+        connections.emplace_back(std::move(conn), std::move(reader));
+    }
+
+    // Stop accepting, answer the requests that have already been received
+    ::close(listen_fd);
+    ::unlink(c.socket_path.c_str());
+
+    for(auto &[conn, reader] : connections)
+    {
+        ::shutdown(conn->fd, SHUT_RD);
+        reader.join();
+    }
+}
+
+/// The pipe that wakes up the listeners when a termination signal is received.
+static int stop_pipe[2] = {-1, -1};
+
+/**
+ * @brief Handles SIGINT and SIGTERM by waking up the listeners.
+ * @param signal The signal number.
+ */
+static void on_stop_signal(int)
+{
+    char const byte = 0;
+    [[maybe_unused]] auto const written = ::write(stop_pipe[1], &byte, 1);
+}
+
+/**
+ * @brief Runs the daemon: accepts connections on `configuration::socket_path` and `configuration::http_address`
+ *        and pushes the received requests to the input queue of the worker threads,
+ *        which send the results back over the connection.
+ * @details Returns after SIGINT or SIGTERM, once every accepted request has been answered.
+ * @param admission The admission control that queues the jobs for the worker threads.
+ * @param router The models, reloaded by the `!reload` command and `POST /reload`.
+ * @param[in] stats The statistics of the worker threads, reported by the `!stats` command and `GET /metrics`.
+ * @param[in] c The application configuration.
+ * @throws std::system_error if a socket cannot be created.
+ * @throws std::invalid_argument if an address is invalid.
+ * @throws std::runtime_error if the daemon is not supported on this platform.
+ */
+void serve(admission_control &admission, model_router &router, serving_stats const &stats, configuration const &c)
+{
+    int const unix_fd = c.socket_path.empty() ? -1 : listen_unix_socket(c.socket_path);
+
+    std::unique_ptr<http_server> http;
+
+    try
+    {
+        if(!c.http_address.empty())
+            http = std::make_unique<http_server>(c.http_address, admission, router, stats, c);
+
+        if(::pipe(stop_pipe) != 0)
+            throw_errno("could not create a pipe");
+    }
+    catch(...)
+    {
+        if(unix_fd >= 0)
+        {
+            ::close(unix_fd);
+            ::unlink(c.socket_path.c_str());
+        }
+
+        throw;
+    }
+
+    struct sigaction action {};
+    action.sa_handler = on_stop_signal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    // The stop pipe is never drained, so every listener sees it readable
+    std::thread http_thread;
+    if(http)
+    {
+        http_thread = std::thread(
+            [&http]
+            {
+                try
+                {
+                    http->run(stop_pipe[0]);
+                }
+                catch(std::exception const &e)
+                {
+                    std::stringstream ss;
+                    ss << "yolo-cls: " << e.what() << std::endl;
+                    std::cerr << ss.str();
+                }
+            });
+    }
+
+    if(unix_fd >= 0)
+    {
+        run_unix_socket(unix_fd, stop_pipe[0], admission, router, stats, c);
+    }
+    else
+    {
+        pollfd fds[1] = {{stop_pipe[0], POLLIN, 0}};
+        while(::poll(fds, 1, -1) < 0 && errno == EINTR)
+        {
+        }
+    }
+
+    if(http_thread.joinable())
+        http_thread.join();
+
+    action.sa_handler = SIG_DFL;
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    ::close(stop_pipe[0]);
+    ::close(stop_pipe[1]);
+}
+
+/**
+ * @brief Sends the image paths to the daemon at `configuration::connect_path` and prints the results.
+ * @details The paths are taken from the command-line arguments or from the standard input, as without a daemon.
+ *          Results are printed to standard output and errors to standard error, in the same format.
+ * @param[in] c The application configuration.
+ * @return The exit code.
+ * @throws std::system_error if the daemon cannot be reached.
+ * @throws std::runtime_error if Unix sockets are not supported on this platform.
+ */
+int run_client(configuration const &c)
+{
+    sockaddr_un const address = make_address(c.connect_path);
+
+    int const fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+        throw_errno("could not create a socket");
+
+    if(::connect(fd, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) != 0)
+    {
+        int const error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "could not connect to '" + c.connect_path + "'");
+    }
+
+    // Send the requests while the results are being received, so that neither side blocks the other
+    std::thread writer(
+        [fd, &c]
+        {
+            auto send_path = [&](std::string const &path)
+            {
+                if(!c.disable_extension_check && !is_supported_image(std::filesystem::path(path).extension().string()))
+                    return true;
+
+                std::string const request = path + '\n';
+                return send_all(fd, request.data(), request.size());
+            };
+
+            // Relative paths are resolved against the working directory of the client
+            std::error_code ec;
+            std::string const cwd = "!cwd " + std::filesystem::current_path(ec).string() + '\n';
+
+            if(!ec && !send_all(fd, cwd.data(), cwd.size()))
+                return;
+
+            if(isatty(STDIN_FILENO))
+            {
+                for(auto const &path : c.image_files)
+                {
+                    if(!send_path(path))
+                        break;
+                }
+            }
+            else if(c.input_format == stdin_format::frames)
+            {
+                // The records are forwarded as encoded image bytes, a single buffer is reused for all of them
+                std::vector<uchar> buffer;
+                std::setvbuf(stdin, nullptr, _IOFBF, 1024 * 1024);
+
+                try
+                {
+                    for(size_t index = 1;; ++index)
+                    {
+                        auto const size = read_frame(stdin, buffer, c.max_filesize);
+                        if(!size)
+                            break;
+
+                        if(buffer.empty())
+                        {
+                            std::stringstream ss;
+                            ss << "yolo-cls: could not process the file 'frame:" << index << "': " << (*size == 0 ? "File is empty." : "File is too large.") << std::endl;
+                            std::cerr << ss.str();
+                            continue;
+                        }
+
+                        char const header[5] = {'\0', static_cast<char>(*size & 0xFF), static_cast<char>((*size >> 8) & 0xFF), static_cast<char>((*size >> 16) & 0xFF), static_cast<char>((*size >> 24) & 0xFF)};
+
+                        if(!send_all(fd, header, sizeof(header)) || !send_all(fd, reinterpret_cast<char const *>(buffer.data()), buffer.size()))
+                            break;
+                    }
+                }
+                catch(std::exception const &e)
+                {
+                    std::stringstream ss;
+                    ss << "yolo-cls: " << e.what() << std::endl;
+                    std::cerr << ss.str();
+                }
+            }
+            else
+            {
+                std::string line;
+                while(std::getline(std::cin, line))
+                {
+                    if(!send_path(line))
+                        break;
+                }
+            }
+
+            ::shutdown(fd, SHUT_WR);
+        });
+
+    socket_reader reader(fd);
+    std::string line;
+
+    while(reader.read_line(line))
+    {
+        if(line.empty())
+            continue;
+
+        if(line.front() == '+')
+        {
+            std::cout << std::string_view(line).substr(1) << std::endl;
+        }
+        else
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: " << std::string_view(line).substr(1) << std::endl;
+            std::cerr << ss.str();
+        }
+    }
+
+    writer.join();
+    ::close(fd);
+
+    return EXIT_SUCCESS;
+}
+
+#else
+
+/**
+ * @brief Runs the daemon. The daemon is not supported on this platform.
+ * @param admission The admission control that queues the jobs for the worker threads.
+ * @param router The models.
+ * @param[in] stats The statistics of the worker threads.
+ * @param[in] c The application configuration.
+ * @throws std::runtime_error always.
+ */
+void serve(admission_control &, model_router &, serving_stats const &, configuration const &)
+{
+    throw std::runtime_error("serve is not supported on this platform.");
+}
+
+/**
+ * @brief Connects to the daemon. Unix sockets are not supported on this platform.
+ * @param[in] c The application configuration.
+ * @return Nothing.
+ * @throws std::runtime_error always.
+ */
+int run_client(configuration const &)
+{
+    throw std::runtime_error("--connect is not supported on this platform.");
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file server.h
+ * @brief Defines the daemon mode (`yolo-cls serve`) and its client.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "utils.h"
+#include "stats.h"
+#include "admission.h"
+
+/*
+    The daemon listens on a Unix stream socket. A client sends any mix of requests:
+        <path>\n                    Classify the image file. Relative paths are resolved against the `!cwd` directory.
+        \0 <u32 length> <bytes>     Classify the encoded image bytes (the length is little-endian).
+        !cwd <directory>\n          Set the directory for relative paths of this connection.
+        !deadline-ms <ms>\n         Drop the following requests if their inference cannot start within <ms> (0 to disable).
+        !priority <class>\n         Set the priority class of the following requests (`interactive` or `bulk`).
+        !stats\n                    Answer with the queueing and inference latency percentiles (`+queue p50 ...`).
+        !reload\n                   Reload the models in the background, answered once the new models serve (`+reloaded ...`).
+        !shm <slots> <size>\n       Switch the connection to a shared-memory ring of frames (see `shm_ring.h`), Linux only.
+    Every request except `!cwd`, `!deadline-ms` and `!priority` gets exactly one response line, in completion order:
+        +<result>\n                 The result line, as printed by `yolo-cls` (e.g., `fox.png, red_fox 0.91, ...`).
+        -<message>\n                The error message (e.g., `Busy` if the latency SLO would be violated).
+    The client closes its write side after the last request. The daemon closes the connection
+    after the last response.
+*/
+
+/**
+ * @brief Runs the daemon: accepts connections on `configuration::socket_path` and `configuration::http_address`
+ *        and pushes the received requests to the input queue of the worker threads,
+ *        which send the results back over the connection.
+ * @details Returns after SIGINT or SIGTERM, once every accepted request has been answered.
+ * @param admission The admission control that queues the jobs for the worker threads.
+ * @param router The models, reloaded by the `!reload` command and `POST /reload`.
+ * @param[in] stats The statistics of the worker threads, reported by the `!stats` command and `GET /metrics`.
+ * @param[in] c The application configuration.
+ * @throws std::system_error if a socket cannot be created.
+ * @throws std::invalid_argument if an address is invalid.
+ * @throws std::runtime_error if the daemon is not supported on this platform.
+ */
+void serve(admission_control &admission, model_router &router, serving_stats const &stats, configuration const &c);
+
+/**
+ * @brief Sends the image paths to the daemon at `configuration::connect_path` and prints the results.
+ * @details The paths are taken from the command-line arguments or from the standard input, as without a daemon.
+ *          Results are printed to standard output and errors to standard error, in the same format.
+ * @param[in] c The application configuration.
+ * @return The exit code.
+ * @throws std::system_error if the daemon cannot be reached.
+ * @throws std::runtime_error if Unix sockets are not supported on this platform.
+ */
+int run_client(configuration const &c);
+
+#endif // SERVER_H
\ No newline at end of file
@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file sha256.cpp
+ * @brief Defines the SHA-256 digest (FIPS 180-4) used to identify image contents.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "sha256.h"
+
+#include <cstring>
+
+/// The round constants, the first 32 bits of the fractional parts of the cube roots of the first 64 primes.
+static constexpr uint32_t round_constants[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+/**
+ * @brief Rotates a 32-bit value to the right.
+ * @param[in] x The value.
+ * @param[in] n The number of bits, 1 to 31.
+ * @return The rotated value.
+ */
+static inline uint32_t rotate_right(uint32_t x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+/**
+ * @brief Processes a 64-byte block.
+ * @param state The hash state, updated in place.
+ * @param[in] block The block.
+ */
+static void process_block(uint32_t state[8], unsigned char const *block)
+{
+    uint32_t w[64];
+
+    for(int i = 0; i < 16; ++i)
+        w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) | (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+
+    for(int i = 16; i < 64; ++i)
+    {
+        uint32_t const s0 = rotate_right(w[i - 15], 7) ^ rotate_right(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t const s1 = rotate_right(w[i - 2], 17) ^ rotate_right(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i]              = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for(int i = 0; i < 64; ++i)
+    {
+        uint32_t const s1     = rotate_right(e, 6) ^ rotate_right(e, 11) ^ rotate_right(e, 25);
+        uint32_t const choose = (e & f) ^ (~e & g);
+        uint32_t const t1     = h + s1 + choose + round_constants[i] + w[i];
+        uint32_t const s0     = rotate_right(a, 2) ^ rotate_right(a, 13) ^ rotate_right(a, 22);
+        uint32_t const major  = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t const t2     = s0 + major;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+/**
+ * @brief Computes the SHA-256 digest of a memory block.
+ * @details The digest is collision resistant, so two contents with the same digest
+ *          are treated as identical even if the bytes come from an untrusted client.
+ * @param[in] data Pointer to the first byte of the block.
+ * @param[in] size Size of the block in bytes.
+ * @return The digest.
+ */
+sha256_digest sha256(void const *data, size_t size)
+{
+    uint32_t state[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+
+    auto const *p = static_cast<unsigned char const *>(data);
+
+    // Whole blocks straight from the input
+    size_t const blocks = size / 64;
+    for(size_t i = 0; i < blocks; ++i)
+        process_block(state, p + i * 64);
+
+    // The remaining bytes, the 0x80 terminator and the length in bits fill one or two final blocks
+    unsigned char tail[128] = {};
+    size_t const remaining  = size % 64;
+    if(remaining != 0)
+        std::memcpy(tail, p + blocks * 64, remaining);
+    tail[remaining] = 0x80;
+
+    size_t const tail_size = remaining < 56 ? 64 : 128;
+    uint64_t const bits    = static_cast<uint64_t>(size) * 8;
+    for(int i = 0; i < 8; ++i)
+        tail[tail_size - 1 - i] = static_cast<unsigned char>(bits >> (i * 8));
+
+    process_block(state, tail);
+    if(tail_size == 128)
+        process_block(state, tail + 64);
+
+    sha256_digest result;
+    for(int i = 0; i < 8; ++i)
+    {
+        result[i * 4]     = static_cast<uint8_t>(state[i] >> 24);
+        result[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+        result[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+        result[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file sha256.h
+ * @brief Declares the SHA-256 digest used to identify image contents.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/// A SHA-256 digest.
+using sha256_digest = std::array<uint8_t, 32>;
+
+/**
+ * @brief Computes the SHA-256 digest of a memory block.
+ * @details The digest is collision resistant, so two contents with the same digest
+ *          are treated as identical even if the bytes come from an untrusted client.
+ * @param[in] data Pointer to the first byte of the block.
+ * @param[in] size Size of the block in bytes.
+ * @return The digest.
+ */
+sha256_digest sha256(void const *data, size_t size);
+
+#endif // SHA256_H
\ No newline at end of file
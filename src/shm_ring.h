@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file shm_ring.h
+ * @brief Defines the shared-memory ring layout used by co-located producers to submit frames to the daemon.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+    A producer on the same host sends `!shm <slots> <slot_size>\n` on the Unix socket of the daemon.
+    The daemon answers `+shm <slots> <slot_size>\n` with three file descriptors attached (SCM_RIGHTS):
+        the memfd of the ring, the submission doorbell and the completion doorbell (both eventfds).
+    From then on the connection only carries the ring, the session ends when the producer closes the socket.
+
+    The producer owns every free slot. To classify a frame it
+        1. writes the frame into the payload of a free slot and fills its `shm_slot_header`,
+        2. appends the slot index to the submission queue and publishes `submit_head` (release),
+        3. writes 1 to the submission doorbell.
+    The daemon decodes encoded images and classifies decoded BGR frames in place, without a copy,
+    so the payload must not change until the slot is completed.
+    For every slot the daemon writes `status` and `result` into the slot header, appends the slot index to the
+    completion queue, publishes `complete_head` (release) and writes 1 to the completion doorbell.
+    The producer consumes the completion queue up to `complete_head` (acquire) and advances `complete_tail`,
+    after which the slot is free again.
+
+    Memory layout (every part starts at a multiple of `shm_ring_alignment`):
+        shm_ring_header
+        uint32_t submit[slots]        The submission queue, indexed by position % slots.
+        uint32_t complete[slots]      The completion queue, indexed by position % slots.
+        slots x (shm_slot_header, payload[slot_size])
+*/
+
+/// Identifies the ring, "YLCR".
+inline constexpr uint32_t shm_ring_magic = 0x594C4352;
+
+/// The version of the layout.
+inline constexpr uint32_t shm_ring_version = 1;
+
+/// The alignment of the parts of the ring, a cache line.
+inline constexpr size_t shm_ring_alignment = 64;
+
+/// The maximum size of the result line of a slot, longer results are truncated.
+inline constexpr size_t shm_result_size = 1024;
+
+/**
+ * @enum shm_format
+ * @brief The format of the payload of a slot.
+ */
+enum class shm_format : uint32_t
+{
+    encoded = 0, ///< Encoded image bytes (e.g., JPEG or PNG), `size` bytes long.
+    bgr     = 1, ///< Decoded 8-bit BGR pixels, `height` rows of `step` bytes.
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "The ring needs lock-free 32-bit atomics.");
+
+/**
+ * @struct shm_ring_header
+ * @brief The header at the start of the ring. The positions only grow, they wrap around at 2^32.
+ */
+struct shm_ring_header
+{
+    uint32_t magic;      ///< `shm_ring_magic`.
+    uint32_t version;    ///< `shm_ring_version`.
+    uint32_t slot_count; ///< The number of slots.
+    uint32_t slot_size;  ///< The payload size of a slot in bytes.
+
+    alignas(shm_ring_alignment) std::atomic<uint32_t> submit_head;   ///< Written by the producer.
+    alignas(shm_ring_alignment) std::atomic<uint32_t> submit_tail;   ///< Written by the daemon.
+    alignas(shm_ring_alignment) std::atomic<uint32_t> complete_head; ///< Written by the daemon.
+    alignas(shm_ring_alignment) std::atomic<uint32_t> complete_tail; ///< Written by the producer.
+};
+
+/**
+ * @struct shm_slot_header
+ * @brief The header of a slot, followed by its payload.
+ */
+struct shm_slot_header
+{
+    uint32_t format;               ///< The `shm_format` of the payload, set by the producer.
+    uint32_t width;                ///< The width of a BGR frame in pixels, set by the producer.
+    uint32_t height;               ///< The height of a BGR frame in pixels, set by the producer.
+    uint32_t step;                 ///< The row size of a BGR frame in bytes (0 for `width * 3`), set by the producer.
+    uint32_t size;                 ///< The size of encoded bytes, set by the producer.
+    int32_t status;                ///< The `job_status` of the result, set by the daemon.
+    uint32_t result_size;          ///< The length of `result`, set by the daemon.
+    char result[shm_result_size];  ///< The result line or the error message (not terminated), set by the daemon.
+};
+
+/**
+ * @brief Rounds a size up to `shm_ring_alignment`.
+ * @param[in] size The size in bytes.
+ * @return The aligned size.
+ */
+inline constexpr size_t shm_ring_align(size_t size)
+{
+    return (size + shm_ring_alignment - 1) / shm_ring_alignment * shm_ring_alignment;
+}
+
+/**
+ * @brief Computes the offset of the submission queue.
+ * @return The offset in bytes from the start of the ring.
+ */
+inline constexpr size_t shm_submit_offset()
+{
+    return shm_ring_align(sizeof(shm_ring_header));
+}
+
+/**
+ * @brief Computes the offset of the completion queue.
+ * @param[in] slots The number of slots.
+ * @return The offset in bytes from the start of the ring.
+ */
+inline constexpr size_t shm_complete_offset(size_t slots)
+{
+    return shm_submit_offset() + shm_ring_align(slots * sizeof(uint32_t));
+}
+
+/**
+ * @brief Computes the distance between two slots.
+ * @param[in] slot_size The payload size of a slot in bytes.
+ * @return The size of a slot including its header.
+ */
+inline constexpr size_t shm_slot_stride(size_t slot_size)
+{
+    return shm_ring_align(sizeof(shm_slot_header)) + shm_ring_align(slot_size);
+}
+
+/**
+ * @brief Computes the offset of the header of a slot.
+ * @param[in] slots The number of slots.
+ * @param[in] slot_size The payload size of a slot in bytes.
+ * @param[in] index The index of the slot.
+ * @return The offset in bytes from the start of the ring.
+ */
+inline constexpr size_t shm_slot_offset(size_t slots, size_t slot_size, size_t index)
+{
+    return shm_complete_offset(slots) + shm_ring_align(slots * sizeof(uint32_t)) + index * shm_slot_stride(slot_size);
+}
+
+/**
+ * @brief Computes the size of the ring.
+ * @param[in] slots The number of slots.
+ * @param[in] slot_size The payload size of a slot in bytes.
+ * @return The size of the shared memory in bytes.
+ */
+inline constexpr size_t shm_ring_size(size_t slots, size_t slot_size)
+{
+    return shm_slot_offset(slots, slot_size, slots);
+}
+
+/**
+ * @brief Reads a field that the producer may change at any time exactly once.
+ * @details The caller validates and uses the returned copy, so that a producer that rewrites the field
+ *          between the check and the use cannot make the daemon read outside the slot.
+ * @param[in] field The field in the shared memory.
+ * @return The value of the field.
+ */
+inline uint32_t shm_read_once(uint32_t const &field)
+{
+    return *static_cast<uint32_t const volatile *>(&field);
+}
+
+/**
+ * @brief Returns the payload of a slot.
+ * @param[in] slot The header of the slot.
+ * @return The first byte of the payload.
+ */
+inline unsigned char *shm_slot_payload(shm_slot_header *slot)
+{
+    return reinterpret_cast<unsigned char *>(slot) + shm_ring_align(sizeof(shm_slot_header));
+}
+
+#endif // SHM_RING_H
\ No newline at end of file
@@ -0,0 +1,403 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file stage_stats.cpp
+ * @brief Implements per-stage timers of the classification pipeline.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "stage_stats.h"
+#include "json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Returns the name of a pipeline stage.
+ * @param[in] stage The stage.
+ * @return The name (e.g., `decode`).
+ */
+char const *pipeline_stage_name(pipeline_stage stage)
+{
+    static constexpr std::array<char const *, pipeline_stage_count> names = {"stat", "read", "decode", "preprocess", "run", "postprocess", "format", "output"};
+
+    return names[static_cast<size_t>(stage)];
+}
+
+/**
+ * @brief Constructs the statistics.
+ * @param[in] enabled If false, `attach` does nothing and nothing is recorded.
+ * @param[in] tracing If true (and `enabled`), the spans of every thread are recorded for `write_trace`.
+ */
+pipeline_stats::pipeline_stats(bool enabled, bool tracing)
+    : enabled(enabled)
+    , tracing(enabled && tracing)
+    , start(std::chrono::steady_clock::now())
+    , wall_start(std::chrono::high_resolution_clock::now())
+{
+}
+
+/**
+ * @brief Attaches a new recorder to the calling thread.
+ * @details Must be called by every thread of the pipeline before it records anything.
+ * @param[in] thread_name The name of the thread in the trace (e.g., `worker`), threads of the same name are numbered.
+ */
+void pipeline_stats::attach(std::string const &thread_name)
+{
+    if(!enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // A deque keeps the recorders of other threads in place
+    recorder              = &recorders.emplace_back();
+    recorder->thread_name = thread_name;
+    recorder->tracing     = tracing;
+}
+
+/**
+ * @brief Counts a classified image of the calling thread.
+ */
+void pipeline_stats::count_image()
+{
+    if(recorder)
+        ++recorder->images;
+}
+
+/**
+ * @brief Counts encoded image bytes read by the calling thread.
+ * @param[in] bytes The number of bytes.
+ */
+void pipeline_stats::count_bytes(uint64_t bytes)
+{
+    if(recorder)
+        recorder->bytes_read += bytes;
+}
+
+/**
+ * @brief Counts a failed image of the calling thread.
+ * @param[in] reason The reason of the failure.
+ */
+void pipeline_stats::count_error(std::string const &reason)
+{
+    if(recorder)
+        ++recorder->errors[reason];
+}
+
+/**
+ * @brief Sets the image processed by the calling thread, the following spans of the trace refer to it.
+ * @param[in] name The name of the image.
+ */
+void pipeline_stats::set_image(std::string const &name)
+{
+    if(!recorder || !recorder->tracing)
+        return;
+
+    recorder->image = static_cast<uint32_t>(recorder->image_names.size());
+    recorder->image_names.push_back(name);
+}
+
+/**
+ * @brief Clears the image processed by the calling thread.
+ */
+void pipeline_stats::clear_image()
+{
+    if(recorder)
+        recorder->image = stage_recorder::no_image;
+}
+
+/**
+ * @brief Merges the recorders of all threads.
+ * @return The merged statistics.
+ */
+pipeline_stats::totals pipeline_stats::merge() const
+{
+    totals t;
+    t.elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for(auto const &r : recorders)
+    {
+        for(size_t i = 0; i < pipeline_stage_count; ++i)
+            t.merged.stages[i].merge(r.stages[i]);
+
+        t.merged.images += r.images;
+        t.merged.bytes_read += r.bytes_read;
+
+        for(auto const &[reason, n] : r.errors)
+            t.merged.errors[reason] += n;
+    }
+
+    return t;
+}
+
+/**
+ * @brief Formats a duration with a unit that keeps three significant digits (e.g., `850ns`, `12.3us`, `4.56ms`).
+ * @param[in] duration The duration.
+ * @return The formatted duration.
+ */
+static std::string format_duration(std::chrono::nanoseconds duration)
+{
+    double const ns = static_cast<double>(duration.count());
+
+    std::stringstream ss;
+    ss << std::setprecision(3);
+
+    if(ns < 1e3)
+        ss << ns << "ns";
+    else if(ns < 1e6)
+        ss << ns / 1e3 << "us";
+    else if(ns < 1e9)
+        ss << ns / 1e6 << "ms";
+    else
+        ss << ns / 1e9 << "s";
+
+    return ss.str();
+}
+
+/**
+ * @brief Describes the merged statistics as a table.
+ * @details Lists count, throughput, p50/p90/p99/max and total time per stage, bytes read and errors by reason.
+ * @return The report, one line per entry.
+ */
+std::string pipeline_stats::report() const
+{
+    totals const t = merge();
+
+    uint64_t failed = 0;
+    for(auto const &e : t.merged.errors)
+        failed += e.second;
+
+    std::stringstream ss;
+
+    ss << std::fixed << std::setprecision(3) << "stats: " << t.merged.images << " images in " << t.elapsed_s << " s (";
+    ss << std::setprecision(1) << (t.elapsed_s > 0.0 ? static_cast<double>(t.merged.images) / t.elapsed_s : 0.0) << " images/s), ";
+    ss << t.merged.bytes_read << " bytes read, " << failed << " errors\n";
+
+    // The throughput of a stage is the number of operations per second of a thread busy in the stage
+    ss << std::left << std::setw(12) << "stage" << std::right << std::setw(10) << "count" << std::setw(12) << "ops/s";
+    ss << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "max" << std::setw(10) << "total" << "\n";
+
+    for(size_t i = 0; i < pipeline_stage_count; ++i)
+    {
+        hdr_histogram const &h = t.merged.stages[i];
+        if(h.count() == 0)
+            continue;
+
+        double const busy_s = std::chrono::duration<double>(h.sum()).count();
+
+        ss << std::left << std::setw(12) << pipeline_stage_name(static_cast<pipeline_stage>(i)) << std::right << std::setw(10) << h.count();
+        ss << std::setw(12) << std::setprecision(1) << (busy_s > 0.0 ? static_cast<double>(h.count()) / busy_s : 0.0);
+        ss << std::setw(10) << format_duration(h.percentile(0.5)) << std::setw(10) << format_duration(h.percentile(0.9));
+        ss << std::setw(10) << format_duration(h.percentile(0.99)) << std::setw(10) << format_duration(h.max());
+        ss << std::setw(10) << format_duration(h.sum()) << "\n";
+    }
+
+    for(auto const &[reason, n] : t.merged.errors)
+        ss << "errors: " << reason << ": " << n << "\n";
+
+    std::string report = ss.str();
+    report.pop_back();
+
+    return report;
+}
+
+/**
+ * @brief Describes the merged statistics as a JSON object.
+ * @return The JSON object (durations in microseconds).
+ */
+std::string pipeline_stats::json() const
+{
+    totals const t = merge();
+
+    auto us = [](std::chrono::nanoseconds d) { return static_cast<double>(d.count()) / 1e3; };
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+
+    ss << "{\"elapsed_s\":" << t.elapsed_s << ",\"images\":" << t.merged.images;
+    ss << ",\"images_per_s\":" << (t.elapsed_s > 0.0 ? static_cast<double>(t.merged.images) / t.elapsed_s : 0.0);
+    ss << ",\"bytes_read\":" << t.merged.bytes_read << ",\"stages\":{";
+
+    bool first = true;
+    for(size_t i = 0; i < pipeline_stage_count; ++i)
+    {
+        hdr_histogram const &h = t.merged.stages[i];
+        if(h.count() == 0)
+            continue;
+
+        double const busy_s = std::chrono::duration<double>(h.sum()).count();
+
+        ss << (first ? "" : ",") << json_quote(pipeline_stage_name(static_cast<pipeline_stage>(i))) << ":{\"count\":" << h.count();
+        ss << ",\"ops_per_s\":" << (busy_s > 0.0 ? static_cast<double>(h.count()) / busy_s : 0.0);
+        ss << ",\"p50_us\":" << us(h.percentile(0.5)) << ",\"p90_us\":" << us(h.percentile(0.9)) << ",\"p99_us\":" << us(h.percentile(0.99));
+        ss << ",\"max_us\":" << us(h.max()) << ",\"total_us\":" << us(h.sum()) << "}";
+        first = false;
+    }
+
+    ss << "},\"errors\":{";
+
+    first = true;
+    for(auto const &[reason, n] : t.merged.errors)
+    {
+        ss << (first ? "" : ",") << json_quote(reason) << ":" << n;
+        first = false;
+    }
+
+    ss << "}}";
+    return ss.str();
+}
+
+/**
+ * @brief Sets a member of a JSON object, adding it if it is missing.
+ * @param object The object.
+ * @param[in] key The key.
+ * @param[in] value The value.
+ */
+static void set_member(json_value &object, std::string const &key, json_value const &value)
+{
+    for(size_t i = 0; i < object.keys.size(); ++i)
+    {
+        if(object.keys[i] == key)
+        {
+            object.items[i] = value;
+            return;
+        }
+    }
+
+    object.keys.push_back(key);
+    object.items.push_back(value);
+}
+
+/**
+ * @brief Writes the spans of all threads and the ONNX Runtime profiles in the Chrome trace event format.
+ * @details The pipeline threads are in the `yolo-cls` process, every profile is a process of its own.
+ *          The profiles are aligned to the spans by the start of the profiling.
+ *          The file can be opened with Perfetto (ui.perfetto.dev) or `chrome://tracing`.
+ * @param[in] path The path of the trace file.
+ * @param[in] profiles The ONNX Runtime profiles to merge.
+ * @throws std::runtime_error if the trace or a profile cannot be read or written.
+ * @throws std::invalid_argument if a profile is not valid JSON.
+ */
+void pipeline_stats::write_trace(std::string const &path, std::vector<session_profile> const &profiles) const
+{
+    std::ofstream file(path);
+    if(!file)
+        throw std::runtime_error("could not write the trace '" + path + "'.");
+
+    // Timestamps are microseconds since the statistics were created
+    auto us = [](std::chrono::steady_clock::duration d) { return std::chrono::duration<double, std::micro>(d).count(); };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"yolo-cls\"}}";
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Threads of the same name are numbered (e.g., `worker 1`, `worker 2`)
+    std::map<std::string, size_t> named;
+    std::map<std::string, size_t> numbered;
+    for(auto const &r : recorders)
+        ++named[r.thread_name];
+
+    size_t tid = 0;
+    for(auto const &r : recorders)
+    {
+        ++tid;
+
+        std::string name = r.thread_name;
+        if(named[name] > 1)
+            name += " " + std::to_string(++numbered[name]);
+
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":" << json_quote(name) << "}}";
+
+        // Complete events, the begin and the end of a span in a single event
+        for(auto const &e : r.events)
+        {
+            file << ",\n{\"name\":" << json_quote(e.name) << ",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid;
+            file << ",\"ts\":" << us(e.begin - start) << ",\"dur\":" << us(e.end - e.begin);
+
+            if(e.image != stage_recorder::no_image)
+                file << ",\"args\":{\"image\":" << json_quote(r.image_names[e.image]) << "}";
+
+            file << "}";
+        }
+    }
+
+    int64_t const wall_start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_start.time_since_epoch()).count();
+
+    int pid = 1;
+    for(auto const &profile : profiles)
+    {
+        ++pid;
+
+        std::ifstream in(profile.path);
+        if(!in)
+            throw std::runtime_error("could not read the profile '" + profile.path + "'.");
+
+        std::stringstream text;
+        text << in.rdbuf();
+
+        json_value const events = parse_json(text.str());
+        if(events.type != json_value::kind::array)
+            throw std::invalid_argument("The profile '" + profile.path + "' is not an array of trace events.");
+
+        // The profiler timestamps are microseconds since the start of the profiling
+        double const offset_us = static_cast<double>(static_cast<int64_t>(profile.start_ns) - wall_start_ns) / 1e3;
+
+        json_value pid_value;
+        pid_value.type   = json_value::kind::number;
+        pid_value.number = pid;
+
+        file << ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":0,\"args\":{\"name\":" << json_quote("onnxruntime " + profile.name) << "}}";
+
+        for(json_value event : events.items)
+        {
+            if(event.type != json_value::kind::object)
+                continue;
+
+            json_value ts;
+            if(json_value const *value = event.find("ts"))
+                ts = *value;
+
+            ts.type = json_value::kind::number;
+            ts.number += offset_us;
+
+            set_member(event, "pid", pid_value);
+            set_member(event, "ts", ts);
+
+            file << ",\n" << dump_json(event);
+        }
+    }
+
+    file << "\n]}" << std::endl;
+
+    if(!file)
+        throw std::runtime_error("could not write the trace '" + path + "'.");
+}
\ No newline at end of file
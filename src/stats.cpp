@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file stats.cpp
+ * @brief Defines latency histograms and the serving statistics.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+/**
+ * @brief Updates the moving average of the inference time of a batch.
+ * @param[in] duration The inference time of a batch.
+ */
+void serving_stats::record_batch(std::chrono::microseconds duration)
+{
+    int64_t average = batch_average_us.load(std::memory_order_relaxed);
+    int64_t updated;
+
+    // The first batch initializes the average, later batches have a weight of 1/8
+    do
+    {
+        updated = (average == 0) ? duration.count() : average + (duration.count() - average) / 8;
+    } while(!batch_average_us.compare_exchange_weak(average, updated, std::memory_order_relaxed));
+}
+
+/**
+ * @brief Returns the moving average of the inference time of a batch.
+ * @return The estimated inference time of the next batch.
+ */
+std::chrono::microseconds serving_stats::compute_estimate() const
+{
+    return std::chrono::microseconds(batch_average_us.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Formats the statistics as a single line (e.g., `queue p50 120us p99 900us, compute p50 ...`).
+ * @return The report.
+ */
+std::string serving_stats::report() const
+{
+    std::stringstream ss;
+
+    ss << "queue p50 " << queue.percentile(0.5).count() << "us p99 " << queue.percentile(0.99).count() << "us, ";
+    ss << "compute p50 " << compute.percentile(0.5).count() << "us p99 " << compute.percentile(0.99).count() << "us (" << compute.count() << " batches), ";
+    ss << classified.load(std::memory_order_relaxed) << " classified, " << expired.load(std::memory_order_relaxed) << " expired, ";
+    ss << rejected.load(std::memory_order_relaxed) << " rejected, " << downgraded.load(std::memory_order_relaxed) << " downgraded";
+
+    // Per model only if the images are split between several models
+    if(models.size() > 1)
+    {
+        for(auto const &m : models)
+            ss << ", " << m.name << " p50 " << m.compute.percentile(0.5).count() << "us p99 " << m.compute.percentile(0.99).count() << "us (" << m.compute.count() << " batches, " << m.classified.load(std::memory_order_relaxed) << " classified)";
+    }
+
+    return ss.str();
+}
+
+/**
+ * @brief Formats the statistics in the Prometheus text format.
+ * @return The metrics.
+ */
+std::string serving_stats::prometheus() const
+{
+    std::stringstream ss;
+
+    auto summary = [&ss](char const *name, char const *help, latency_histogram const &h)
+    {
+        ss << "# HELP " << name << " " << help << "\n";
+        ss << "# TYPE " << name << " summary\n";
+        ss << name << "{quantile=\"0.5\"} " << h.percentile(0.5).count() << "\n";
+        ss << name << "{quantile=\"0.99\"} " << h.percentile(0.99).count() << "\n";
+        ss << name << "_count " << h.count() << "\n";
+    };
+
+    summary("yolo_cls_queue_latency_us", "Time from receiving an image to the start of its batch in microseconds.", queue);
+    summary("yolo_cls_compute_latency_us", "Inference time of a batch in microseconds.", compute);
+
+    ss << "# HELP yolo_cls_batched_images_total Images classified by the batches of the worker threads.\n";
+    ss << "# TYPE yolo_cls_batched_images_total counter\n";
+    ss << "yolo_cls_batched_images_total " << classified.load(std::memory_order_relaxed) << "\n";
+
+    if(!models.empty())
+    {
+        ss << "# HELP yolo_cls_model_compute_latency_us Inference time of a batch per model in microseconds.\n";
+        ss << "# TYPE yolo_cls_model_compute_latency_us summary\n";
+
+        for(auto const &m : models)
+        {
+            ss << "yolo_cls_model_compute_latency_us{model=\"" << m.name << "\",quantile=\"0.5\"} " << m.compute.percentile(0.5).count() << "\n";
+            ss << "yolo_cls_model_compute_latency_us{model=\"" << m.name << "\",quantile=\"0.99\"} " << m.compute.percentile(0.99).count() << "\n";
+            ss << "yolo_cls_model_compute_latency_us_count{model=\"" << m.name << "\"} " << m.compute.count() << "\n";
+        }
+
+        ss << "# HELP yolo_cls_model_batched_images_total Images classified per model.\n";
+        ss << "# TYPE yolo_cls_model_batched_images_total counter\n";
+
+        for(auto const &m : models)
+            ss << "yolo_cls_model_batched_images_total{model=\"" << m.name << "\"} " << m.classified.load(std::memory_order_relaxed) << "\n";
+    }
+
+    ss << "# HELP yolo_cls_expired_total Images dropped because their deadline had passed.\n";
+    ss << "# TYPE yolo_cls_expired_total counter\n";
+    ss << "yolo_cls_expired_total " << expired.load(std::memory_order_relaxed) << "\n";
+    ss << "# HELP yolo_cls_rejected_total Images rejected because the latency SLO would be violated.\n";
+    ss << "# TYPE yolo_cls_rejected_total counter\n";
+    ss << "yolo_cls_rejected_total " << rejected.load(std::memory_order_relaxed) << "\n";
+    ss << "# HELP yolo_cls_downgraded_total Images classified by the first cascade stage only to meet the latency SLO.\n";
+    ss << "# TYPE yolo_cls_downgraded_total counter\n";
+    ss << "yolo_cls_downgraded_total " << downgraded.load(std::memory_order_relaxed) << "\n";
+    ss << "# HELP yolo_cls_busy_workers Worker threads processing a batch.\n";
+    ss << "# TYPE yolo_cls_busy_workers gauge\n";
+    ss << "yolo_cls_busy_workers " << busy_workers.load(std::memory_order_relaxed) << "\n";
+
+    return ss.str();
+}
\ No newline at end of file
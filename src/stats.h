@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file stats.h
+ * @brief Defines latency histograms and the serving statistics.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef STATS_H
+#define STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+#include "histogram.h"
+
+/**
+ * @brief A lock-free histogram of durations in microseconds, shared by all threads.
+ * @details Values below 16 us have their own buckets, larger values are split into 8 buckets per power of two
+ *          up to 2^40 us (12 days), so a percentile is reported with a relative error below 12.5%.
+ */
+using latency_histogram = log_linear_histogram<std::chrono::microseconds, 3, 40, true>;
+
+/**
+ * @struct model_stats
+ * @brief Statistics of a single model variant.
+ */
+struct model_stats
+{
+    std::string name;                     ///< The name of the variant (e.g., `primary` or `canary`).
+    latency_histogram compute;            ///< Inference time of a batch, recorded once per batch.
+    std::atomic<uint64_t> classified {0}; ///< Images classified by the variant.
+};
+
+/**
+ * @struct serving_stats
+ * @brief Statistics of the worker threads shared by all requests.
+ */
+struct serving_stats
+{
+    latency_histogram queue;                    ///< Time from receiving a job to the start of its batch.
+    latency_histogram compute;                  ///< Inference time of a batch, recorded once per batch.
+    std::atomic<uint64_t> classified {0};       ///< Images classified by all batches.
+    std::atomic<uint64_t> expired {0};          ///< Jobs dropped because their deadline had passed.
+    std::atomic<uint64_t> rejected {0};         ///< Jobs rejected by the admission control.
+    std::atomic<uint64_t> downgraded {0};       ///< Jobs downgraded to the first cascade stage by the admission control.
+    std::atomic<unsigned int> busy_workers {0}; ///< Worker threads processing a batch.
+    std::deque<model_stats> models;             ///< Per model variant, set up before the worker threads start.
+
+    /**
+     * @brief Updates the moving average of the inference time of a batch.
+     * @param[in] duration The inference time of a batch.
+     */
+    void record_batch(std::chrono::microseconds duration);
+
+    /**
+     * @brief Returns the moving average of the inference time of a batch.
+     * @return The estimated inference time of the next batch.
+     */
+    std::chrono::microseconds compute_estimate() const;
+
+    /**
+     * @brief Formats the statistics as a single line (e.g., `queue p50 120us p99 900us, compute p50 ...`).
+     * @return The report.
+     */
+    std::string report() const;
+
+    /**
+     * @brief Formats the statistics in the Prometheus text format.
+     * @return The metrics.
+     */
+    std::string prometheus() const;
+
+private:
+    std::atomic<int64_t> batch_average_us {0}; ///< The exponential moving average of the batch inference time.
+};
+
+#endif // STATS_H
\ No newline at end of file
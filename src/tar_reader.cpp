@@ -0,0 +1,283 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file tar_reader.cpp
+ * @brief Implements a streaming reader of tar archives.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "tar_reader.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+#include "utils.h"
+
+/// The size of a tar block.
+static constexpr uint64_t block_size = 512;
+
+/// Content smaller than this is skipped by reading, so that the buffer of the stream is not dropped by a seek.
+static constexpr uint64_t min_seek = 256 * 1024;
+
+/// The maximum size of a GNU long name or a pax extended header.
+static constexpr uint64_t max_extension_size = 1024 * 1024;
+
+/**
+ * @brief Parses a numeric header field, octal or GNU base-256.
+ * @param[in] field The field.
+ * @param[in] size The size of the field in bytes.
+ * @return The value.
+ */
+static uint64_t parse_number(unsigned char const *field, size_t size)
+{
+    // Base-256, used for members of 8 GiB and more
+    if(field[0] & 0x80)
+    {
+        uint64_t value = field[0] & 0x7F;
+        for(size_t i = 1; i < size; ++i)
+            value = (value << 8) | field[i];
+
+        return value;
+    }
+
+    uint64_t value = 0;
+    for(size_t i = 0; i < size && field[i] != '\0'; ++i)
+    {
+        if(field[i] >= '0' && field[i] <= '7')
+            value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+    }
+
+    return value;
+}
+
+/**
+ * @brief Reads a NUL-terminated header field.
+ * @param[in] field The field.
+ * @param[in] size The size of the field in bytes.
+ * @return The value.
+ */
+static std::string parse_string(unsigned char const *field, size_t size)
+{
+    auto const *begin = reinterpret_cast<char const *>(field);
+    return std::string(begin, std::find(begin, begin + size, '\0'));
+}
+
+/**
+ * @brief Constructs a reader of an archive.
+ * @param[in] stream The stream, opened in binary mode. It is not closed by the reader.
+ * @param[in] name The name of the archive used in error messages.
+ */
+tar_reader::tar_reader(std::FILE *stream, std::string name) : stream(stream), name(std::move(name)) {}
+
+/**
+ * @brief Reads the header of the next regular file member.
+ * @param[out] path The path of the member inside the archive.
+ * @return The size of the member, or `std::nullopt` at the end of the archive.
+ * @throws std::runtime_error if the archive is truncated or a header is invalid.
+ */
+std::optional<uint64_t> tar_reader::next(std::string &path)
+{
+    skip();
+
+    // Set by the extension headers for the following member
+    std::string long_path;
+    std::optional<uint64_t> pax_size;
+
+    while(true)
+    {
+        unsigned char header[block_size];
+        size_t const count = std::fread(header, 1, block_size, stream);
+
+        if(count == 0)
+            return std::nullopt;
+
+        if(count != block_size)
+            throw std::runtime_error("the archive '" + name + "' is truncated.");
+
+        // The archive ends with zero blocks
+        if(std::all_of(header, header + block_size, [](unsigned char b) { return b == 0; }))
+            return std::nullopt;
+
+        // The checksum is computed with the checksum field filled with spaces
+        uint64_t sum = 0;
+        for(size_t i = 0; i < block_size; ++i)
+            sum += (i >= 148 && i < 156) ? ' ' : header[i];
+
+        if(sum != parse_number(header + 148, 8))
+            throw std::runtime_error("the archive '" + name + "' has an invalid header.");
+
+        char const type = static_cast<char>(header[156]);
+
+        remaining = pax_size ? *pax_size : parse_number(header + 124, 12);
+        padding   = (block_size - remaining % block_size) % block_size;
+
+        if(type == 'L' || type == 'x')
+        {
+            if(remaining > max_extension_size)
+                throw std::runtime_error("the archive '" + name + "' has an invalid extension header.");
+
+            std::vector<uchar> content;
+            read(content);
+
+            if(type == 'L')
+            {
+                long_path.assign(content.begin(), std::find(content.begin(), content.end(), '\0'));
+                continue;
+            }
+
+            // Pax records: "<length> <key>=<value>\n"
+            std::string_view records(reinterpret_cast<char const *>(content.data()), content.size());
+            while(!records.empty())
+            {
+                size_t const space = records.find(' ');
+                auto const length  = parse_integer(records.substr(0, space), 0, static_cast<int64_t>(records.size()));
+
+                if(space == std::string_view::npos || !length || static_cast<size_t>(*length) <= space + 1 || records[static_cast<size_t>(*length) - 1] != '\n')
+                    throw std::runtime_error("the archive '" + name + "' has an invalid extension header.");
+
+                std::string_view const record = records.substr(space + 1, static_cast<size_t>(*length) - space - 2);
+                size_t const equals           = record.find('=');
+
+                if(equals != std::string_view::npos)
+                {
+                    std::string_view const key   = record.substr(0, equals);
+                    std::string_view const value = record.substr(equals + 1);
+
+                    if(key == "path")
+                        long_path = value;
+                    else if(key == "size")
+                    {
+                        auto const size = parse_integer(value, 0, std::numeric_limits<int64_t>::max());
+                        if(!size)
+                            throw std::runtime_error("the archive '" + name + "' has an invalid extension header.");
+
+                        pax_size = static_cast<uint64_t>(*size);
+                    }
+                }
+
+                records.remove_prefix(static_cast<size_t>(*length));
+            }
+
+            continue;
+        }
+
+        // Regular files, the legacy regular file and the contiguous file
+        if(type == '0' || type == '\0' || type == '7')
+        {
+            if(!long_path.empty())
+            {
+                path = std::move(long_path);
+            }
+            else
+            {
+                std::string const prefix = (std::memcmp(header + 257, "ustar", 5) == 0) ? parse_string(header + 345, 155) : "";
+                std::string const file    = parse_string(header, 100);
+
+                path = prefix.empty() ? file : prefix + "/" + file;
+            }
+
+            return remaining;
+        }
+
+        // Directories, links and everything else
+        skip();
+        long_path.clear();
+        pax_size.reset();
+    }
+}
+
+/**
+ * @brief Reads the content of the current member.
+ * @param[out] buffer Receives the content. Its capacity is reused.
+ * @throws std::runtime_error if the archive is truncated.
+ */
+void tar_reader::read(std::vector<uchar> &buffer)
+{
+    buffer.resize(remaining);
+    read_exact(buffer.data(), remaining);
+    read_exact(nullptr, padding);
+
+    remaining = 0;
+    padding   = 0;
+}
+
+/**
+ * @brief Skips the content of the current member. Seeks if the stream is seekable.
+ * @throws std::runtime_error if the archive is truncated.
+ */
+void tar_reader::skip()
+{
+    uint64_t const size = remaining + padding;
+
+    remaining = 0;
+    padding   = 0;
+
+    if(size == 0)
+        return;
+
+    if(seekable && size >= min_seek && size <= static_cast<uint64_t>(LONG_MAX))
+    {
+        // Seeking past the end succeeds, so the last byte is read to notice a truncated archive
+        if(std::fseek(stream, static_cast<long>(size - 1), SEEK_CUR) == 0)
+        {
+            read_exact(nullptr, 1);
+            return;
+        }
+
+        // A pipe
+        seekable = false;
+    }
+
+    read_exact(nullptr, size);
+}
+
+/**
+ * @brief Reads exactly `size` bytes.
+ * @param[out] data The destination, or nullptr to discard the bytes.
+ * @param[in] size The number of bytes to read.
+ * @throws std::runtime_error if the archive is truncated.
+ */
+void tar_reader::read_exact(void *data, uint64_t size)
+{
+    char skipped[64 * 1024];
+    auto *out = static_cast<char *>(data);
+
+    while(size > 0)
+    {
+        size_t const chunk = out ? static_cast<size_t>(std::min<uint64_t>(size, SIZE_MAX)) : static_cast<size_t>(std::min<uint64_t>(size, sizeof(skipped)));
+        size_t const count = std::fread(out ? out : skipped, 1, chunk, stream);
+
+        if(count == 0)
+            throw std::runtime_error("the archive '" + name + "' is truncated.");
+
+        if(out)
+            out += count;
+
+        size -= count;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file tar_reader.h
+ * @brief Defines a streaming reader of tar archives.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef TAR_READER_H
+#define TAR_READER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class tar_reader
+ * @brief Reads the regular file members of a tar archive sequentially, without extracting them.
+ *
+ * Supports ustar archives, GNU long names (`L`) and pax extended headers (`x`, the `path` and `size` records).
+ * Other member types (directories, links, devices) are skipped. The stream does not need to be seekable,
+ * so an archive can be read from a pipe.
+ */
+class tar_reader
+{
+public:
+    /**
+     * @brief Constructs a reader of an archive.
+     * @param[in] stream The stream, opened in binary mode. It is not closed by the reader.
+     * @param[in] name The name of the archive used in error messages.
+     */
+    tar_reader(std::FILE *stream, std::string name);
+
+    /**
+     * @brief Reads the header of the next regular file member.
+     * @param[out] path The path of the member inside the archive.
+     * @return The size of the member, or `std::nullopt` at the end of the archive.
+     * @throws std::runtime_error if the archive is truncated or a header is invalid.
+     */
+    std::optional<uint64_t> next(std::string &path);
+
+    /**
+     * @brief Reads the content of the current member.
+     * @param[out] buffer Receives the content. Its capacity is reused.
+     * @throws std::runtime_error if the archive is truncated.
+     */
+    void read(std::vector<uchar> &buffer);
+
+    /**
+     * @brief Skips the content of the current member. Seeks if the stream is seekable.
+     * @throws std::runtime_error if the archive is truncated.
+     */
+    void skip();
+
+private:
+    /**
+     * @brief Reads exactly `size` bytes.
+     * @param[out] data The destination, or nullptr to discard the bytes.
+     * @param[in] size The number of bytes to read.
+     * @throws std::runtime_error if the archive is truncated.
+     */
+    void read_exact(void *data, uint64_t size);
+
+    std::FILE *stream;         ///< The archive.
+    std::string name;          ///< The name of the archive.
+    uint64_t remaining = 0;    ///< The unread content of the current member.
+    uint64_t padding   = 0;    ///< The padding after the content of the current member.
+    bool seekable      = true; ///< False once seeking has failed (e.g., on a pipe).
+};
+
+#endif // TAR_READER_H
\ No newline at end of file
@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file tensor_cache.cpp
+ * @brief Implements the cache of preprocessed input tensors (--tensor-cache).
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "tensor_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "mapped_file.h"
+#include "yolo.h"
+
+/**
+ * @brief Returns the name of a tensor format (`fp32`, `fp16` or `uint8`).
+ * @param[in] format The format.
+ * @return The name.
+ */
+char const *tensor_format_name(tensor_format format)
+{
+    switch(format)
+    {
+        case tensor_format::fp16: return "fp16";
+        case tensor_format::uint8: return "uint8";
+        default: return "fp32";
+    }
+}
+
+/**
+ * @brief Returns the OpenCV element type of a tensor format.
+ * @param[in] format The format.
+ * @return The element type.
+ */
+static int tensor_format_type(tensor_format format)
+{
+    switch(format)
+    {
+        case tensor_format::fp16: return CV_16F;
+        case tensor_format::uint8: return CV_8U;
+        default: return CV_32F;
+    }
+}
+
+/**
+ * @brief Opens the cache directory, creating it if it does not exist.
+ * @param[in] directory The cache directory.
+ * @param[in] size The input size of the models.
+ * @param[in] format The element type of the stored tensors.
+ * @throws std::filesystem::filesystem_error if the directory cannot be created.
+ */
+tensor_cache::tensor_cache(std::string const &directory, cv::Size size, tensor_format format) : directory(directory), input_size(size), format(format)
+{
+    std::filesystem::create_directories(this->directory);
+}
+
+/**
+ * @brief Checks whether the cache is enabled.
+ * @return True if the cache has a directory.
+ */
+bool tensor_cache::enabled() const
+{
+    return !directory.empty();
+}
+
+/**
+ * @brief Returns the path of the file of an encoded image.
+ * @param[in] digest The SHA-256 digest of the encoded image.
+ * @param[in] size The size of the encoded image in bytes.
+ * @return The path.
+ */
+std::filesystem::path tensor_cache::path_for(sha256_digest const &digest, size_t size) const
+{
+    char hex[2 * sizeof(sha256_digest) + 1];
+    for(size_t i = 0; i < digest.size(); ++i)
+        std::snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+
+    char name[160];
+    std::snprintf(name, sizeof(name), "%s-%llu-%dx%d-p%u-%s.yct", hex, static_cast<unsigned long long>(size), input_size.width, input_size.height, tensor_cache_preprocessing, tensor_format_name(format));
+
+    // The first byte of the digest spreads the files over 256 subdirectories
+    return directory / std::string(name, 2) / name;
+}
+
+/**
+ * @brief Looks up the tensor of an encoded image.
+ * @param[in] digest The SHA-256 digest of the encoded image.
+ * @param[in] size The size of the encoded image in bytes.
+ * @param[out] owner Keeps the memory of the returned tensor valid.
+ * @return The preprocessed input tensor (see `yolo::is_input_tensor`), or an empty matrix if the image is not cached.
+ */
+cv::Mat tensor_cache::find(sha256_digest const &digest, size_t size, std::shared_ptr<void const> &owner)
+{
+    auto const path = path_for(digest, size);
+    int const type  = tensor_format_type(format);
+    int const area  = input_size.area();
+
+    std::error_code ec;
+    if(!std::filesystem::is_regular_file(path, ec))
+        return {};
+
+    std::shared_ptr<mapped_file const> file;
+    try
+    {
+        file = std::make_shared<mapped_file const>(path.string(), mapped_file::access::whole);
+    }
+    catch(std::exception const &)
+    {
+        return {};
+    }
+
+    // A file of another layout, or a truncated one, is a miss and gets replaced
+    tensor_cache_header header;
+    size_t const tensor_size = 3 * static_cast<size_t>(area) * CV_ELEM_SIZE(type);
+
+    if(file->size() != tensor_cache_data_offset + tensor_size)
+        return {};
+
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if(std::memcmp(header.magic, tensor_cache_magic, sizeof(tensor_cache_magic)) != 0 || header.version != tensor_cache_version || header.preprocessing != tensor_cache_preprocessing || header.format != static_cast<uint32_t>(format))
+        return {};
+
+    if(header.width != static_cast<uint32_t>(input_size.width) || header.height != static_cast<uint32_t>(input_size.height) || header.content_size != size || header.content_digest != digest)
+        return {};
+
+    hits.fetch_add(1, std::memory_order_relaxed);
+
+    cv::Mat stored(3, area, type, const_cast<uchar *>(file->data() + tensor_cache_data_offset));
+
+    // A 32-bit float tensor is fed straight from the mapping, the others are converted
+    if(format == tensor_format::fp32)
+    {
+        owner = file;
+        return stored;
+    }
+
+    cv::Mat tensor;
+    stored.convertTo(tensor, CV_32F, format == tensor_format::uint8 ? 1.0 / 255.0 : 1.0);
+
+    return tensor;
+}
+
+/**
+ * @brief Preprocesses a decoded image and stores its tensor.
+ * @details A failure to write the file is reported once and otherwise ignored.
+ * @param[in] digest The SHA-256 digest of the encoded image.
+ * @param[in] size The size of the encoded image in bytes.
+ * @param[in] image The decoded BGR image.
+ * @return The preprocessed input tensor of the image (see `yolo::is_input_tensor`).
+ */
+cv::Mat tensor_cache::store(sha256_digest const &digest, size_t size, cv::Mat const &image)
+{
+    cv::Mat tensor(3, input_size.area(), CV_32FC1);
+    preprocess_image(image, input_size, tensor.ptr<float>());
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    cv::Mat stored = tensor;
+    if(format != tensor_format::fp32)
+        tensor.convertTo(stored, tensor_format_type(format), format == tensor_format::uint8 ? 255.0 : 1.0);
+
+    tensor_cache_header header {};
+    std::memcpy(header.magic, tensor_cache_magic, sizeof(tensor_cache_magic));
+    header.version        = tensor_cache_version;
+    header.format         = static_cast<uint32_t>(format);
+    header.width          = static_cast<uint32_t>(input_size.width);
+    header.height         = static_cast<uint32_t>(input_size.height);
+    header.preprocessing  = tensor_cache_preprocessing;
+    header.content_size   = size;
+    header.content_digest = digest;
+
+    char padding[tensor_cache_data_offset] = {};
+    std::memcpy(padding, &header, sizeof(header));
+
+    // Written under a unique temporary name and renamed, so a reader never maps a partial file
+    thread_local std::mt19937_64 generator {std::random_device {}()};
+
+    auto const path      = path_for(digest, size);
+    auto const temporary = std::filesystem::path(path).concat(".tmp-" + std::to_string(generator()));
+
+    try
+    {
+        std::filesystem::create_directories(path.parent_path());
+
+        {
+            std::ofstream ofs(temporary, std::ios::binary);
+            ofs.write(padding, sizeof(padding));
+            ofs.write(reinterpret_cast<char const *>(stored.data), static_cast<std::streamsize>(stored.total() * stored.elemSize()));
+
+            if(!ofs)
+                throw std::runtime_error("could not write the tensor cache file '" + temporary.string() + "'.");
+        }
+
+        std::filesystem::rename(temporary, path);
+    }
+    catch(std::exception const &e)
+    {
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+
+        if(!write_failed.exchange(true))
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: " << e.what() << std::endl;
+            std::cerr << ss.str();
+        }
+    }
+
+    return tensor;
+}
+
+/**
+ * @brief Formats the number of cache hits and misses.
+ * @return The report.
+ */
+std::string tensor_cache::report() const
+{
+    std::stringstream ss;
+    ss << "tensor cache: " << hits.load(std::memory_order_relaxed) << " hits, " << misses.load(std::memory_order_relaxed) << " misses (" << tensor_format_name(format) << ", " << input_size.width << "x" << input_size.height << ")";
+
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file tensor_cache.h
+ * @brief Defines the cache of preprocessed input tensors (--tensor-cache).
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef TENSOR_CACHE_H
+#define TENSOR_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "sha256.h"
+
+/**
+ * @brief The element type of the tensors stored in the cache.
+ */
+enum class tensor_format : uint32_t
+{
+    fp32  = 0, ///< 32-bit floats, fed to the model straight from the mapping.
+    fp16  = 1, ///< 16-bit floats, half the size, converted to 32-bit floats when read.
+    uint8 = 2, ///< The 8-bit RGB values before scaling, a quarter of the size and lossless.
+};
+
+/**
+ * @brief Returns the name of a tensor format (`fp32`, `fp16` or `uint8`).
+ * @param[in] format The format.
+ * @return The name.
+ */
+char const *tensor_format_name(tensor_format format);
+
+/// Identifies a file of the tensor cache.
+inline constexpr char tensor_cache_magic[8] = {'Y', 'C', 'T', 'E', 'N', 'S', 'O', 'R'};
+
+/// The version of the file layout.
+inline constexpr uint32_t tensor_cache_version = 2;
+
+/// The version of `preprocess_image` (bilinear resize, BGR to RGB, scaling to [0, 1], NCHW), bumped whenever it changes.
+inline constexpr uint32_t tensor_cache_preprocessing = 1;
+
+/// The offset of the tensor in a file of the tensor cache.
+inline constexpr size_t tensor_cache_data_offset = 128;
+
+/**
+ * @struct tensor_cache_header
+ * @brief The header at the start of every file of the tensor cache, followed by the tensor at `tensor_cache_data_offset`.
+ */
+struct tensor_cache_header
+{
+    char magic[8];                ///< `tensor_cache_magic`.
+    uint32_t version;             ///< `tensor_cache_version`.
+    uint32_t format;              ///< The `tensor_format` of the tensor.
+    uint32_t width;               ///< The input width of the model.
+    uint32_t height;              ///< The input height of the model.
+    uint32_t preprocessing;       ///< `tensor_cache_preprocessing`.
+    uint32_t reserved;            ///< Zero.
+    uint64_t content_size;        ///< The size of the encoded image in bytes.
+    sha256_digest content_digest; ///< The SHA-256 digest of the encoded image.
+};
+
+static_assert(sizeof(tensor_cache_header) <= tensor_cache_data_offset, "The header overlaps the tensor.");
+
+/**
+ * @class tensor_cache
+ * @brief A directory of preprocessed input tensors, one memory-mapped file per encoded image.
+ *
+ * The files are keyed by the SHA-256 digest and size of the encoded image, the input size of the model,
+ * the version of the preprocessing and the tensor format, so models with the same preprocessing share the cache
+ * across runs. The whole digest is checked against the header, a file is never returned for other content.
+ * A cached image is neither decoded nor preprocessed again.
+ * The files are written to a temporary name and renamed, so concurrent runs may share the directory.
+ */
+class tensor_cache
+{
+public:
+    /**
+     * @brief Default constructor. The cache is disabled.
+     */
+    tensor_cache() = default;
+
+    /**
+     * @brief Opens the cache directory, creating it if it does not exist.
+     * @param[in] directory The cache directory.
+     * @param[in] size The input size of the models.
+     * @param[in] format The element type of the stored tensors.
+     * @throws std::filesystem::filesystem_error if the directory cannot be created.
+     */
+    tensor_cache(std::string const &directory, cv::Size size, tensor_format format);
+
+    /**
+     * @brief Checks whether the cache is enabled.
+     * @return True if the cache has a directory.
+     */
+    bool enabled() const;
+
+    /**
+     * @brief Looks up the tensor of an encoded image.
+     * @param[in] digest The SHA-256 digest of the encoded image.
+     * @param[in] size The size of the encoded image in bytes.
+     * @param[out] owner Keeps the memory of the returned tensor valid.
+     * @return The preprocessed input tensor (see `yolo::is_input_tensor`), or an empty matrix if the image is not cached.
+     */
+    cv::Mat find(sha256_digest const &digest, size_t size, std::shared_ptr<void const> &owner);
+
+    /**
+     * @brief Preprocesses a decoded image and stores its tensor.
+     * @details A failure to write the file is reported once and otherwise ignored.
+     * @param[in] digest The SHA-256 digest of the encoded image.
+     * @param[in] size The size of the encoded image in bytes.
+     * @param[in] image The decoded BGR image.
+     * @return The preprocessed input tensor of the image (see `yolo::is_input_tensor`).
+     */
+    cv::Mat store(sha256_digest const &digest, size_t size, cv::Mat const &image);
+
+    /**
+     * @brief Formats the number of cache hits and misses.
+     * @return The report.
+     */
+    std::string report() const;
+
+private:
+    std::filesystem::path directory;             ///< The cache directory, empty if the cache is disabled.
+    cv::Size input_size;                         ///< The input size of the models.
+    tensor_format format = tensor_format::fp32;  ///< The element type of the stored tensors.
+    std::atomic<uint64_t> hits {0};              ///< The number of images read from the cache.
+    std::atomic<uint64_t> misses {0};            ///< The number of images stored in the cache.
+    std::atomic<bool> write_failed {false};      ///< True once a file could not be written.
+
+    /**
+     * @brief Returns the path of the file of an encoded image.
+     * @param[in] digest The SHA-256 digest of the encoded image.
+     * @param[in] size The size of the encoded image in bytes.
+     * @return The path.
+     */
+    std::filesystem::path path_for(sha256_digest const &digest, size_t size) const;
+};
+
+#endif // TENSOR_CACHE_H
\ No newline at end of file
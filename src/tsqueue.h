@@ -30,35 +30,77 @@
 #ifndef TSQUEUE_H
 #define TSQUEUE_H
 
-#include <string>
+#include <algorithm>
+#include <chrono>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
 #include <optional>
 #include <atomic>
+#include <vector>
 
 /**
  * @class tsqueue
- * @brief A simple thread-safe queue for passing strings between threads.
+ * @brief A simple thread-safe queue for passing values between threads.
  *
  * This class uses a mutex and a condition variable to ensure that operations
  * like push and pop are safe to call from multiple threads concurrently.
+ *
+ * Values can be pushed with a priority level. Values of a lower level are popped first,
+ * values of the same level in the push order.
+ *
+ * @tparam T The type of the queued values.
  */
+template<typename T>
 class tsqueue
 {
 public:
     /**
-     * @brief Pushes a string onto the queue in a thread-safe manner.
-     * @param[in] value The string to push.
+     * @brief Constructs an empty queue.
+     * @param[in] levels The number of priority levels.
+     */
+    explicit tsqueue(size_t levels = 1);
+
+    /**
+     * @brief Pushes a value onto the queue in a thread-safe manner.
+     * @param[in] value The value to push.
+     * @param[in] level The priority level, 0 is popped first. Levels past the last one are clamped to it.
      */
-    void push(std::string const &value);
+    void push(T value, size_t level = 0);
 
     /**
-     * @brief Pops a string from the queue. This operation is blocking.
+     * @brief Pops a value from the queue. This operation is blocking.
               It will wait until an item is available or until the queue is closed.
-     * @return An `std::optional<std::string>` containing the value if one was popped, or `std::nullopt` if the queue is empty and has been closed.
+     * @return An `std::optional<T>` containing the value if one was popped, or `std::nullopt` if the queue is empty and has been closed.
+     */
+    std::optional<T> pop();
+
+    /**
+     * @brief Pops up to `max_count` values from the queue. This operation is blocking.
+              It will wait until at least one item is available or until the queue is closed,
+              then takes the items that are already queued without waiting for more.
+     * @param[in] max_count The maximum number of values to pop.
+     * @return The popped values in the queue order, or an empty vector if the queue is empty and has been closed.
      */
-    std::optional<std::string> pop();
+    std::vector<T> pop_batch(size_t max_count);
+
+    /**
+     * @brief Pops up to `max_count` values from the queue, waiting for the batch to fill. This operation is blocking.
+              It will wait until at least one item is available or until the queue is closed,
+              then until `max_count` items are queued, the queue is closed, or the time returned by `wait_until` has passed.
+     * @param[in] max_count The maximum number of values to pop.
+     * @param[in] wait_until Returns the latest time to wait for the batch to fill, given the next value to pop.
+     * @return The popped values in the queue order, or an empty vector if the queue is empty and has been closed.
+     */
+    template<typename WaitUntil>
+    std::vector<T> pop_batch(size_t max_count, WaitUntil wait_until);
+
+    /**
+     * @brief Returns the number of queued values that are popped before a value pushed with the given level.
+     * @param[in] level The priority level.
+     * @return The number of queued values with a level up to `level`.
+     */
+    size_t size(size_t level) const;
 
     /**
      * @brief Closes the queue, signaling that no more items will be pushed. This will unblock any threads waiting on `pop()`.
@@ -66,10 +108,173 @@ public:
     void close();
 
 private:
-    std::queue<std::string> queue;  ///< The underlying std::queue.
-    mutable std::mutex mutex;       ///< Mutex to protect access to the queue.
-    std::condition_variable cv;     ///< Condition variable to signal producers and consumers.
-    std::atomic<bool> done = false; ///< Flag to indicate that the queue is closed.
+    std::vector<std::queue<T>> queues; ///< The underlying std::queue of every priority level.
+    size_t count = 0;                  ///< The number of queued values of all levels.
+    mutable std::mutex mutex;          ///< Mutex to protect access to the queue.
+    std::condition_variable cv;        ///< Condition variable to signal producers and consumers.
+    std::condition_variable cv_fill;   ///< Condition variable to signal consumers waiting for a batch to fill.
+    std::atomic<bool> done = false;    ///< Flag to indicate that the queue is closed.
+
+    /**
+     * @brief Returns the next value to pop. The mutex must be locked and the queue must not be empty.
+     * @return The queue of the lowest non-empty level.
+     */
+    std::queue<T> &next_locked();
 };
 
+/**
+ * @brief Constructs an empty queue.
+ * @param[in] levels The number of priority levels.
+ */
+template<typename T>
+tsqueue<T>::tsqueue(size_t levels) : queues(levels == 0 ? 1 : levels)
+{
+}
+
+/**
+ * @brief Pushes a value onto the queue in a thread-safe manner.
+ * @param[in] value The value to push.
+ * @param[in] level The priority level, 0 is popped first. Levels past the last one are clamped to it.
+ */
+template<typename T>
+void tsqueue<T>::push(T value, size_t level)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queues[std::min(level, queues.size() - 1)].push(std::move(value));
+        ++count;
+    }
+    cv.notify_one();
+    cv_fill.notify_all();
+}
+
+/**
+ * @brief Pops a value from the queue. This operation is blocking.
+          It will wait until an item is available or until the queue is closed.
+ * @return An `std::optional<T>` containing the value if one was popped, or `std::nullopt` if the queue is empty and has been closed.
+ */
+template<typename T>
+std::optional<T> tsqueue<T>::pop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return count != 0 || done; });
+
+    if(count == 0)
+    {
+        return std::nullopt;
+    }
+
+    auto &queue = next_locked();
+    T value     = std::move(queue.front());
+    queue.pop();
+    --count;
+    return value;
+}
+
+/**
+ * @brief Pops up to `max_count` values from the queue. This operation is blocking.
+          It will wait until at least one item is available or until the queue is closed,
+          then takes the items that are already queued without waiting for more.
+ * @param[in] max_count The maximum number of values to pop.
+ * @return The popped values in the queue order, or an empty vector if the queue is empty and has been closed.
+ */
+template<typename T>
+std::vector<T> tsqueue<T>::pop_batch(size_t max_count)
+{
+    return pop_batch(max_count, [](T const &) { return std::chrono::steady_clock::time_point::min(); });
+}
+
+/**
+ * @brief Pops up to `max_count` values from the queue, waiting for the batch to fill. This operation is blocking.
+          It will wait until at least one item is available or until the queue is closed,
+          then until `max_count` items are queued, the queue is closed, or the time returned by `wait_until` has passed.
+ * @param[in] max_count The maximum number of values to pop.
+ * @param[in] wait_until Returns the latest time to wait for the batch to fill, given the next value to pop.
+ * @return The popped values in the queue order, or an empty vector if the queue is empty and has been closed.
+ */
+template<typename T>
+template<typename WaitUntil>
+std::vector<T> tsqueue<T>::pop_batch(size_t max_count, WaitUntil wait_until)
+{
+    std::vector<T> values;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return count != 0 || done; });
+
+    // Another consumer may take the values while waiting, then start over with the next one
+    while(count != 0 && count < max_count && !done)
+    {
+        auto const until = wait_until(next_locked().front());
+
+        if(until <= decltype(until)::clock::now())
+            break;
+
+        if(!cv_fill.wait_until(lock, until, [this, max_count] { return count >= max_count || done; }))
+        {
+            if(count == 0)
+                cv.wait(lock, [this] { return count != 0 || done; });
+            else
+                break;
+        }
+    }
+
+    while(count != 0 && values.size() < max_count)
+    {
+        auto &queue = next_locked();
+        values.push_back(std::move(queue.front()));
+        queue.pop();
+        --count;
+    }
+
+    return values;
+}
+
+/**
+ * @brief Returns the number of queued values that are popped before a value pushed with the given level.
+ * @param[in] level The priority level.
+ * @return The number of queued values with a level up to `level`.
+ */
+template<typename T>
+size_t tsqueue<T>::size(size_t level) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t result = 0;
+    for(size_t i = 0; i <= level && i < queues.size(); ++i)
+        result += queues[i].size();
+
+    return result;
+}
+
+/**
+ * @brief Closes the queue, signaling that no more items will be pushed. This will unblock any threads waiting on `pop()`.
+ */
+template<typename T>
+void tsqueue<T>::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+    }
+
+    cv.notify_all();
+    cv_fill.notify_all();
+}
+
+/**
+ * @brief Returns the next value to pop. The mutex must be locked and the queue must not be empty.
+ * @return The queue of the lowest non-empty level.
+ */
+template<typename T>
+std::queue<T> &tsqueue<T>::next_locked()
+{
+    for(auto &queue : queues)
+    {
+        if(!queue.empty())
+            return queue;
+    }
+
+    return queues.back();
+}
+
 #endif // TSQUEUE_H
\ No newline at end of file
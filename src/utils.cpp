@@ -28,18 +28,34 @@
  * @copyright SPDX-License-Identifier: GPL-3.0-or-later
 */
 #include "utils.h"
+#include "records.h"
 
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
 #include <stdexcept>
 #include <map>
+#include <numeric>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <sstream>
 #include <limits>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <filesystem>
+#include <fstream>
 
 #include "xgetopt/xgetopt.h"
 #include "config.h"
 
+#ifdef _WIN32
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
 /**
  * @brief Converts a string with a storage unit (e.g., `100mb`, `2g`) to a numeric value in bytes.
  * @param[in] unit The string representation of the size (e.g., `100mb`). Case-insensitive.
@@ -114,10 +130,35 @@ uint64_t string_unit_to_numeric(std::string const &unit)
     return number * multiplier;
 }
 
+/**
+ * @brief Checks whether OpenCV can decode GIF images, which depends on its version and build options.
+ * @return True if a 1x1 GIF image is decoded. The check runs once.
+ */
+static bool has_gif_decoder()
+{
+    static bool const supported = []()
+    {
+        // GIF89a, 1x1 pixel, a two-color global table and a single LZW-coded pixel
+        static unsigned char const gif[] = {0x47, 0x49, 0x46, 0x38, 0x39, 0x61, 0x01, 0x00, 0x01, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF,
+                                            0xFF, 0x2C, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x02, 0x02, 0x44, 0x01, 0x00, 0x3B};
+
+        try
+        {
+            return !cv::imdecode(cv::Mat(1, sizeof(gif), CV_8UC1, const_cast<unsigned char *>(gif)), cv::IMREAD_COLOR).empty();
+        }
+        catch(std::exception const &)
+        {
+            return false;
+        }
+    }();
+
+    return supported;
+}
+
 /**
  * @brief Checks if a file extension corresponds to an image format supported by OpenCV.
  * @param[in] extension The file extension (e.g., `.jpg`, `png`). Case-insensitive.
- * @return True if the extension is supported, false otherwise.
+ * @return True if the extension is supported, false otherwise. GIF is supported only if OpenCV can decode it.
  */
 bool is_supported_image(std::string_view extension)
 {
@@ -183,9 +224,330 @@ bool is_supported_image(std::string_view extension)
     lower_extension.reserve(extension.size());
     std::transform(extension.begin(), extension.end(), std::back_inserter(lower_extension), [](unsigned char c) { return std::tolower(c); });
 
+    // OpenCV decodes GIF since 4.11 and only if it was built with it
+    if(lower_extension == "gif")
+        return has_gif_decoder();
+
     return supported_extensions.count(lower_extension) > 0;
 }
 
+/**
+ * @brief Checks if a file extension corresponds to an image format that may hold several frames or pages
+ *        (animated GIF and WebP, multi-page TIFF).
+ * @param[in] extension The file extension (e.g., `.tif`, `gif`). Case-insensitive.
+ * @return True if the image may have several frames.
+ */
+bool is_multi_frame_image(std::string_view extension)
+{
+    if(!extension.empty() && extension.front() == '.')
+        extension.remove_prefix(1);
+
+    std::string lower_extension;
+    lower_extension.reserve(extension.size());
+    std::transform(extension.begin(), extension.end(), std::back_inserter(lower_extension), [](unsigned char c) { return std::tolower(c); });
+
+    return lower_extension == "tif" || lower_extension == "tiff" || lower_extension == "gif" || lower_extension == "webp";
+}
+
+/**
+ * @brief Reads the whole file into memory.
+ * @param[in] path The path to the file.
+ * @param[in] size The expected size of the file in bytes.
+ * @return The content of the file.
+ * @throws std::filesystem::filesystem_error if the file cannot be opened or read.
+ */
+std::vector<uchar> read_file(std::string const &path, std::uintmax_t size)
+{
+    std::ifstream ifs(path, std::ios::binary);
+    if(!ifs.is_open())
+        throw std::filesystem::filesystem_error("Could not open file", path, std::make_error_code(std::errc::io_error));
+
+    std::vector<uchar> buffer(size);
+    if(!ifs.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(size)))
+        throw std::filesystem::filesystem_error("Could not read file", path, std::make_error_code(std::errc::io_error));
+
+    return buffer;
+}
+
+/**
+ * @brief Parses a cascade specification (e.g., `fast.onnx:0.9,big.onnx`).
+ * @param[in] spec Comma-separated model paths. Every model except the last one has a `:threshold` suffix.
+ * @return The stages as (model path, top-1 confidence threshold) pairs. The thresholds are in [0, 1], the threshold of the last stage is 0.
+ * @throws std::invalid_argument if the specification is invalid or a threshold is outside [0, 1].
+ */
+std::vector<std::pair<std::string, float>> parse_cascade(std::string const &spec)
+{
+    std::vector<std::pair<std::string, float>> result;
+
+    std::stringstream ss(spec);
+    std::string item;
+    while(std::getline(ss, item, ','))
+    {
+        if(item.empty())
+            throw std::invalid_argument("Cascade '" + spec + "' contains an empty stage.");
+
+        // Split at the last colon, so that Windows drive letters (e.g., `C:\model.onnx`) are kept
+        size_t const colon = item.rfind(':');
+        std::string threshold_str = (colon == std::string::npos) ? "" : item.substr(colon + 1);
+
+        if(!threshold_str.empty() && threshold_str.find_first_not_of("0123456789.") == std::string::npos)
+        {
+            // The threshold is a softmax probability
+            size_t end            = 0;
+            float const threshold = std::stof(threshold_str, &end);
+
+            if(end != threshold_str.size() || threshold > 1.0f)
+                throw std::invalid_argument("Cascade stage '" + item + "' has an invalid confidence threshold, expected a number from 0 to 1.");
+
+            result.emplace_back(item.substr(0, colon), threshold);
+        }
+        else
+            result.emplace_back(item, -1.0f);
+    }
+
+    if(result.size() < 2)
+        throw std::invalid_argument("Cascade '" + spec + "' must have at least two stages.");
+
+    for(size_t i = 0; i + 1 < result.size(); ++i)
+    {
+        if(result[i].second < 0.0f)
+            throw std::invalid_argument("Cascade stage '" + result[i].first + "' has no confidence threshold.");
+    }
+
+    // The last stage always accepts the image
+    result.back().second = 0.0f;
+
+    return result;
+}
+
+/**
+ * @brief Parses a decimal integer within a range (e.g., a duration from a command or a header).
+ * @param[in] value The digits, without a sign or spaces.
+ * @param[in] min The smallest accepted value.
+ * @param[in] max The largest accepted value.
+ * @return The value, or `std::nullopt` if the text is not a decimal integer from `min` to `max`.
+ */
+std::optional<int64_t> parse_integer(std::string_view value, int64_t min, int64_t max)
+{
+    if(value.empty() || value.find_first_not_of("0123456789") != std::string_view::npos)
+        return std::nullopt;
+
+    // Digits only, so a failed or partial conversion means an overflow
+    int64_t result         = 0;
+    auto const [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+
+    if(error != std::errc() || end != value.data() + value.size() || result < min || result > max)
+        return std::nullopt;
+
+    return result;
+}
+
+/**
+ * @brief Parses an inference resolution (e.g., `320` or `320x256`).
+ * @param[in] size The resolution as `<size>` (square) or `<width>x<height>`.
+ * @return The (width, height) pair.
+ * @throws std::invalid_argument if the resolution is invalid.
+ */
+std::pair<int64_t, int64_t> parse_input_size(std::string const &size)
+{
+    size_t const x = size.find_first_of("xX");
+
+    std::string const width_str  = size.substr(0, x);
+    std::string const height_str = (x == std::string::npos) ? width_str : size.substr(x + 1);
+
+    auto is_number = [](std::string const &str) { return !str.empty() && str.find_first_not_of("0123456789") == std::string::npos; };
+
+    if(!is_number(width_str) || !is_number(height_str))
+        throw std::invalid_argument("Invalid input size '" + size + "', expected <size> or <width>x<height>.");
+
+    int64_t const width  = std::stoll(width_str);
+    int64_t const height = std::stoll(height_str);
+
+    if(width == 0 || height == 0)
+        throw std::invalid_argument("Invalid input size '" + size + "', the dimensions must be positive.");
+
+    return {width, height};
+}
+
+/**
+ * @brief Parses a canary specification (e.g., `new.onnx:0.05`).
+ * @param[in] spec The model path and the share of the images routed to it, separated by a colon.
+ * @return The (model path, share) pair. The share is in (0, 1).
+ * @throws std::invalid_argument if the specification is invalid.
+ */
+std::pair<std::string, double> parse_canary(std::string const &spec)
+{
+    // Split at the last colon, so that Windows drive letters (e.g., `C:\model.onnx`) are kept
+    size_t const colon = spec.rfind(':');
+    std::string const weight_str = (colon == std::string::npos) ? "" : spec.substr(colon + 1);
+
+    if(colon == 0 || weight_str.empty() || weight_str.find_first_not_of("0123456789.") != std::string::npos)
+        throw std::invalid_argument("Invalid canary '" + spec + "', expected <model.onnx>:<share>.");
+
+    double const weight = std::stod(weight_str);
+    if(!(weight > 0.0 && weight < 1.0))
+        throw std::invalid_argument("Invalid canary '" + spec + "', the share must be between 0 and 1.");
+
+    return {spec.substr(0, colon), weight};
+}
+
+/**
+ * @brief Parses the format of the piped standard input.
+ * @param[in] format `lines`, `frames`, `tar` or `boxes`.
+ * @return The format.
+ * @throws std::invalid_argument if the format is unknown.
+ */
+static stdin_format parse_stdin_format(std::string const &format)
+{
+    if(format == "lines")
+        return stdin_format::lines;
+
+    if(format == "frames")
+        return stdin_format::frames;
+
+    if(format == "tar")
+        return stdin_format::tar;
+
+    if(format == "boxes")
+        return stdin_format::boxes;
+
+    throw std::invalid_argument("Unknown standard input format '" + format + "', expected lines, frames, tar or boxes.");
+}
+
+/**
+ * @brief Parses the element type of the cached tensors.
+ * @param[in] format `fp32`, `fp16` or `uint8`.
+ * @return The format.
+ * @throws std::invalid_argument if the format is unknown.
+ */
+static tensor_format parse_tensor_format(std::string const &format)
+{
+    for(auto f : {tensor_format::fp32, tensor_format::fp16, tensor_format::uint8})
+    {
+        if(format == tensor_format_name(f))
+            return f;
+    }
+
+    throw std::invalid_argument("Unknown tensor format '" + format + "', expected fp32, fp16 or uint8.");
+}
+
+/**
+ * @brief Parses the maximum Hamming distance of near-duplicate images.
+ * @param[in] value The distance, 0 to 64 (a larger distance would match every image).
+ * @return The distance.
+ * @throws std::invalid_argument if the value is not an integer or out of range.
+ */
+static int parse_phash_distance(std::string const &value)
+{
+    size_t end     = 0;
+    int const dist = std::stoi(value, &end);
+
+    if(end != value.size() || dist < 0 || dist > 64)
+        throw std::invalid_argument("--phash-distance must be an integer from 0 to 64, got '" + value + "'.");
+
+    return dist;
+}
+
+/**
+ * @brief Parses the maximum time a worker waits for a batch to fill, `--max-queue-delay-us`.
+ * @param[in] value The time in microseconds, 0 to 60000000 (a minute).
+ * @return The time.
+ * @throws std::invalid_argument if the value is not an integer or out of range.
+ */
+static std::chrono::microseconds parse_max_queue_delay(std::string const &value)
+{
+    auto const us = parse_integer(value, 0, 60'000'000);
+
+    if(!us)
+        throw std::invalid_argument("--max-queue-delay-us must be an integer from 0 to 60000000, got '" + value + "'.");
+
+    return std::chrono::microseconds(*us);
+}
+
+/**
+ * @brief Parses the latency SLO of `--slo-ms`.
+ * @param[in] value The SLO in milliseconds, 1 to `max_deadline_ms`.
+ * @return The SLO.
+ * @throws std::invalid_argument if the value is not a positive integer or out of range.
+ */
+static std::chrono::milliseconds parse_slo(std::string const &value)
+{
+    auto const ms = parse_integer(value, 1, max_deadline_ms);
+
+    if(!ms)
+        throw std::invalid_argument("--slo-ms must be an integer from 1 to " + std::to_string(max_deadline_ms) + ", got '" + value + "'.");
+
+    return std::chrono::milliseconds(*ms);
+}
+
+/**
+ * @brief Parses the frame sampling interval of `--every-n-frames`.
+ * @param[in] value The interval, a positive integer.
+ * @return The interval.
+ * @throws std::invalid_argument if the value is not a positive integer.
+ */
+static unsigned int parse_every_n_frames(std::string const &value)
+{
+    size_t end        = 0;
+    long long const n = std::stoll(value, &end);
+
+    if(end != value.size() || n <= 0 || n > std::numeric_limits<int>::max())
+        throw std::invalid_argument("--every-n-frames must be a positive integer, got '" + value + "'.");
+
+    return static_cast<unsigned int>(n);
+}
+
+/**
+ * @brief Parses the frame sampling rate of `--fps`.
+ * @param[in] value The rate in frames per second, a finite number that is not negative.
+ * @return The rate.
+ * @throws std::invalid_argument if the value is not a finite number or negative.
+ */
+static double parse_sample_fps(std::string const &value)
+{
+    size_t end       = 0;
+    double const fps = std::stod(value, &end);
+
+    if(end != value.size() || !std::isfinite(fps) || fps < 0.0)
+        throw std::invalid_argument("--fps must be a finite number that is not negative, got '" + value + "'.");
+
+    return fps;
+}
+
+/**
+ * @brief Identifiers of the options that have no short form.
+ *        The values start after the range of `char` so they never collide with short options.
+ */
+enum long_only_option : int
+{
+    option_dedup = 256,
+    option_phash_distance,
+    option_cascade,
+    option_input_size,
+    option_fold_preprocessing,
+    option_graph_top_k,
+    option_socket,
+    option_connect,
+    option_http,
+    option_max_queue_delay,
+    option_slo,
+    option_slo_downgrade,
+    option_canary,
+    option_watch_models,
+    option_stdin_format,
+    option_tar,
+    option_records,
+    option_tensor_cache,
+    option_tensor_format,
+    option_video,
+    option_every_n_frames,
+    option_fps,
+    option_all_frames,
+    option_stats,
+    option_stats_json,
+    option_trace,
+};
+
 /**
  * @brief Parses command-line arguments and populates a configuration struct.
  * @param argc Argument count from `main`.
@@ -203,16 +565,33 @@ configuration parse_arguments(int argc, char **argv)
 
     configuration result;
 
+    // The `serve` subcommand runs the application as a daemon, the options follow it
+    if(std::string_view(argv[1]) == "serve")
+    {
+        result.serve = true;
+        --argc;
+        ++argv;
+    }
+    // The `pack` subcommand writes the images to a record file
+    else if(std::string_view(argv[1]) == "pack")
+    {
+        result.pack = true;
+        --argc;
+        ++argv;
+    }
+
     // Accepted parameters
-    std::string const short_opts = "m:c:k:t:TSF:Dhva";
+    std::string const short_opts = "m:c:k:t:b:TSF:Dhvao:";
 
     // clang-format off
-    std::array<xoption, 12> long_options =
+    std::array<xoption, 41> long_options =
         {{
             {"model",               xrequired_argument, nullptr, 'm'},
             {"classes",             xrequired_argument, nullptr, 'c'},
             {"top-k",               xrequired_argument, nullptr, 'k'},
             {"threads",             xrequired_argument, nullptr, 't'},
+            {"batch",               xrequired_argument, nullptr, 'b'},
+            {"max-batch",           xrequired_argument, nullptr, 'b'},
             {"timing",              xno_argument,       nullptr, 'T'},
             {"softmax",             xno_argument,       nullptr, 'S'},
             {"max-filesize",        xrequired_argument, nullptr, 'F'},
@@ -220,6 +599,33 @@ configuration parse_arguments(int argc, char **argv)
             {"help",                xno_argument,       nullptr, 'h'},
             {"version",             xno_argument,       nullptr, 'v'},
             {"about",               xno_argument,       nullptr, 'a'},
+            {"dedup",               xno_argument,       nullptr, option_dedup},
+            {"phash-distance",      xrequired_argument, nullptr, option_phash_distance},
+            {"cascade",             xrequired_argument, nullptr, option_cascade},
+            {"input-size",          xrequired_argument, nullptr, option_input_size},
+            {"fold-preprocessing",  xno_argument,       nullptr, option_fold_preprocessing},
+            {"graph-top-k",         xno_argument,       nullptr, option_graph_top_k},
+            {"socket",              xrequired_argument, nullptr, option_socket},
+            {"connect",             xrequired_argument, nullptr, option_connect},
+            {"http",                xrequired_argument, nullptr, option_http},
+            {"max-queue-delay-us",  xrequired_argument, nullptr, option_max_queue_delay},
+            {"slo-ms",              xrequired_argument, nullptr, option_slo},
+            {"slo-downgrade",       xno_argument,       nullptr, option_slo_downgrade},
+            {"canary",              xrequired_argument, nullptr, option_canary},
+            {"watch-models",        xno_argument,       nullptr, option_watch_models},
+            {"stdin-format",        xrequired_argument, nullptr, option_stdin_format},
+            {"tar",                 xrequired_argument, nullptr, option_tar},
+            {"records",             xrequired_argument, nullptr, option_records},
+            {"output",              xrequired_argument, nullptr, 'o'},
+            {"tensor-cache",        xrequired_argument, nullptr, option_tensor_cache},
+            {"tensor-format",       xrequired_argument, nullptr, option_tensor_format},
+            {"video",               xrequired_argument, nullptr, option_video},
+            {"every-n-frames",      xrequired_argument, nullptr, option_every_n_frames},
+            {"fps",                 xrequired_argument, nullptr, option_fps},
+            {"all-frames",          xno_argument,       nullptr, option_all_frames},
+            {"stats",               xno_argument,       nullptr, option_stats},
+            {"stats-json",          xrequired_argument, nullptr, option_stats_json},
+            {"trace",               xrequired_argument, nullptr, option_trace},
             {0, 0, 0, 0} // Sentinel
         }};
     // clang-format on
@@ -234,10 +640,11 @@ configuration parse_arguments(int argc, char **argv)
         // clang-format off
         switch(opt)
         {
-            case 'm': result.model_path = xoptarg; break;
-            case 'c': result.classes_path = xoptarg; break;
+            case 'm': result.model_paths.push_back(xoptarg); break;
+            case 'c': result.classes_paths.push_back(xoptarg); break;
             case 'k': result.top_k = std::stoi(xoptarg); break;
             case 't': result.threads = std::stoi(xoptarg); break;
+            case 'b': result.batch_size = std::stoi(xoptarg); break;
             case 'T': result.enable_timing = true; break;
             case 'S': result.use_softmax = true; break;
             case 'F': result.max_filesize = string_unit_to_numeric(xoptarg); break;
@@ -245,6 +652,33 @@ configuration parse_arguments(int argc, char **argv)
             case 'h': print_help(); exit(EXIT_SUCCESS); break;
             case 'v': std::cout << PROJECT_VERSION << std::endl; exit(EXIT_SUCCESS); break;
             case 'a': print_about(); exit(EXIT_SUCCESS); break;
+            case 'o': result.output_path = xoptarg; break;
+            case option_dedup: result.enable_dedup = true; break;
+            case option_phash_distance: result.phash_distance = parse_phash_distance(xoptarg); break;
+            case option_cascade: result.cascade = parse_cascade(xoptarg); break;
+            case option_input_size: std::tie(result.input_width, result.input_height) = parse_input_size(xoptarg); break;
+            case option_fold_preprocessing: result.fold_preprocessing = true; break;
+            case option_graph_top_k: result.graph_top_k = true; break;
+            case option_socket: result.socket_path = xoptarg; break;
+            case option_connect: result.connect_path = xoptarg; break;
+            case option_http: result.http_address = xoptarg; break;
+            case option_max_queue_delay: result.max_queue_delay = parse_max_queue_delay(xoptarg); break;
+            case option_slo: result.slo = parse_slo(xoptarg); break;
+            case option_slo_downgrade: result.slo_downgrade = true; break;
+            case option_canary: std::tie(result.canary_path, result.canary_weight) = parse_canary(xoptarg); break;
+            case option_watch_models: result.watch_models = true; break;
+            case option_stdin_format: result.input_format = parse_stdin_format(xoptarg); break;
+            case option_tar: result.tar_paths.push_back(xoptarg); break;
+            case option_records: result.records_paths.push_back(xoptarg); break;
+            case option_tensor_cache: result.tensor_cache_dir = xoptarg; break;
+            case option_tensor_format: result.tensor_cache_format = parse_tensor_format(xoptarg); break;
+            case option_video: result.video_paths.push_back(xoptarg); break;
+            case option_every_n_frames: result.every_n_frames = parse_every_n_frames(xoptarg); break;
+            case option_fps: result.sample_fps = parse_sample_fps(xoptarg); break;
+            case option_all_frames: result.all_frames = true; break;
+            case option_stats: result.print_stats = true; break;
+            case option_stats_json: result.stats_json_path = xoptarg; break;
+            case option_trace: result.trace_path = xoptarg; break;
             default: throw std::runtime_error("could not parse parameters, use --help for usage.");
         }
         // clang-format on
@@ -257,146 +691,1299 @@ configuration parse_arguments(int argc, char **argv)
     if(result.threads == 0)
         result.threads = 1;
 
+    if(result.batch_size == 0)
+        result.batch_size = 1;
+
+    if(!result.cascade.empty() && !result.model_paths.empty())
+        throw std::runtime_error("--cascade cannot be combined with -m, use --help for usage.");
+
+    // The stages of a cascade take their class files like the models of -m
+    size_t const models = result.cascade.empty() ? result.model_paths.size() : result.cascade.size();
+    if(result.classes_paths.size() > 1 && result.classes_paths.size() != models)
+        throw std::runtime_error("every model or cascade stage needs its own -c, or a single -c is shared by all of them, use --help for usage.");
+
+    if(result.classes_paths.empty())
+        result.classes_paths.push_back("");
+
+    if(result.serve && result.socket_path.empty() && result.http_address.empty())
+        throw std::runtime_error("serve requires --socket or --http, use --help for usage.");
+
+    if(!result.serve && (!result.socket_path.empty() || !result.http_address.empty()))
+        throw std::runtime_error("--socket and --http are only valid with serve, use --help for usage.");
+
+    if(result.serve && (!result.connect_path.empty() || !result.image_files.empty()))
+        throw std::runtime_error("serve takes no image files and cannot be combined with --connect, use --help for usage.");
+
+    if(!result.canary_path.empty() && result.model_paths.size() > 1)
+        throw std::runtime_error("--canary replaces a single model or cascade and cannot be combined with several -m, use --help for usage.");
+
+    if(result.serve && (result.input_format != stdin_format::lines || !result.tar_paths.empty()))
+        throw std::runtime_error("--stdin-format and --tar cannot be combined with serve, use --help for usage.");
+
+    if(!result.tar_paths.empty() && (result.input_format != stdin_format::lines || !result.image_files.empty()))
+        throw std::runtime_error("--tar cannot be combined with --stdin-format or image files, use --help for usage.");
+
+    if(!result.connect_path.empty() && (result.input_format == stdin_format::tar || !result.tar_paths.empty()))
+        throw std::runtime_error("tar archives cannot be sent to a daemon with --connect, use --help for usage.");
+
+    if(result.input_format == stdin_format::boxes && (!result.connect_path.empty() || !result.image_files.empty()))
+        throw std::runtime_error("--stdin-format boxes cannot be combined with --connect or image files, use --help for usage.");
+
+    if(result.input_format == stdin_format::boxes && (result.enable_dedup || result.phash_distance >= 0 || !result.tensor_cache_dir.empty()))
+        throw std::runtime_error("--stdin-format boxes cannot be combined with --dedup, --phash-distance or --tensor-cache, use --help for usage.");
+
+    if(!result.serve && result.watch_models)
+        throw std::runtime_error("--watch-models is only valid with serve, use --help for usage.");
+
+    if(result.pack && result.output_path.empty())
+        throw std::runtime_error("pack requires -o, use --help for usage.");
+
+    if(!result.pack && !result.output_path.empty())
+        throw std::runtime_error("-o is only valid with pack, use --help for usage.");
+
+    if(result.pack && (!result.connect_path.empty() || result.input_format != stdin_format::lines || !result.tar_paths.empty() || !result.records_paths.empty()))
+        throw std::runtime_error("pack takes image files or paths from standard input only, use --help for usage.");
+
+    if(!result.records_paths.empty() && (result.serve || !result.connect_path.empty() || result.input_format != stdin_format::lines || !result.tar_paths.empty() || !result.image_files.empty()))
+        throw std::runtime_error("--records cannot be combined with serve, --connect, --stdin-format, --tar or image files, use --help for usage.");
+
+    if(!result.video_paths.empty() && (result.serve || result.pack || !result.connect_path.empty() || result.input_format != stdin_format::lines || !result.tar_paths.empty() || !result.records_paths.empty() || !result.image_files.empty()))
+        throw std::runtime_error("--video cannot be combined with serve, pack, --connect, --stdin-format, --tar, --records or image files, use --help for usage.");
+
+    if(result.every_n_frames != 1 && result.sample_fps > 0.0)
+        throw std::runtime_error("--every-n-frames and --fps cannot be combined, use --help for usage.");
+
+    if(result.all_frames && (result.serve || !result.connect_path.empty()))
+        throw std::runtime_error("--all-frames cannot be combined with serve or --connect, use --help for usage.");
+
+#ifndef YOLOCLS_HAS_VIDEOIO
+    if(!result.video_paths.empty())
+        throw std::runtime_error("--video requires OpenCV with the videoio module, yolo-cls was built without it.");
+#endif
+
+    if(!result.tensor_cache_dir.empty() && (result.serve || result.pack || !result.connect_path.empty()))
+        throw std::runtime_error("--tensor-cache cannot be combined with serve, pack or --connect, use --help for usage.");
+
+    if(!result.tensor_cache_dir.empty() && (result.fold_preprocessing || result.phash_distance >= 0))
+        throw std::runtime_error("--tensor-cache cannot be combined with --fold-preprocessing or --phash-distance, use --help for usage.");
+
+    if((result.print_stats || !result.stats_json_path.empty() || !result.trace_path.empty()) && (result.serve || result.pack || !result.connect_path.empty()))
+        throw std::runtime_error("--stats, --stats-json and --trace cannot be combined with serve, pack or --connect, use --help for usage.");
+
     return result;
 }
 
 /**
- * @brief The main worker thread function.
- *        Pops a file path from the input queue, performs classification,
- *        formats the result, and pushes it to the output queue.
- * @param tsq_in The thread-safe input queue for file paths.
- * @param tsq_out The thread-safe output queue for formatted results.
- * @param model The YOLO model instance to use for classification.
- * @param[in] c The application configuration.
+ * @class deadline_exceeded
+ * @brief Thrown for a job whose deadline passed before its inference started.
  */
-void thread_classify(tsqueue &tsq_in, tsqueue &tsq_out, yolo &model, configuration const &c)
+class deadline_exceeded : public std::runtime_error
 {
-    while(auto value = tsq_in.pop())
-    {
-        try
-        {
-            // Measure execution time
-            auto start_timer = std::chrono::high_resolution_clock::now();
+public:
+    deadline_exceeded() : std::runtime_error("Deadline exceeded.") {}
+};
 
-            // File path of the image
-            auto const &path = *value;
+/**
+ * @class dedup_retry
+ * @brief Published to the requests waiting on an identical image whose own deadline passed before its inference.
+ *        The waiting requests are queued again instead of failing with a deadline that is not their own.
+ */
+class dedup_retry : public std::runtime_error
+{
+public:
+    dedup_retry() : std::runtime_error("The identical image was not classified.") {}
+};
 
-            // Check if the path points to a regular file (not a directory, not non-existent)
-            if(!std::filesystem::is_regular_file(path))
-                throw std::filesystem::filesystem_error("Path is not a regular file or does not exist", path, std::make_error_code(std::errc::no_such_file_or_directory));
+/**
+ * @struct classify_item
+ * @brief The state of a single job processed by `thread_classify`.
+ */
+struct classify_item
+{
+    job request;                                                 ///< The job.
+    std::chrono::high_resolution_clock::time_point start;        ///< The time the processing started.
+    cv::Mat image;                                               ///< The decoded image (or its preprocessed tensor) waiting for classification.
+    std::shared_ptr<void const> tensor;                          ///< Keeps the mapping of a cached tensor in `image` valid.
+    std::vector<cv::Mat> frames;                                 ///< The decoded frames of `job::frames`.
+    bool expanded = false;                                       ///< True if the crops of the boxes or the frames are classified as separate items instead.
+    size_t variant = 0;                                          ///< The model variant the image is routed to, the caches are keyed by it.
+    uint64_t phash = 0;                                          ///< The perceptual hash of the image.
+    uint64_t content_size = 0;                                   ///< The size of the content the deduplication entry is keyed by.
+    sha256_digest content_digest {};                             ///< The digest of the content the deduplication entry is keyed by.
+    uint64_t dedup_generation = 0;                               ///< The generation of the deduplication cache the batch started with.
+    uint64_t phash_generation = 0;                               ///< The generation of the near-duplicate index the batch started with.
+    std::shared_ptr<std::promise<std::string>> owner;            ///< The deduplication entry to publish the result to.
+    std::optional<std::shared_future<std::string>> duplicate;    ///< The result of an identical image to wait for.
+    bool retry = false;                                          ///< True if the identical image expired and the job is queued again.
+    std::string predictions;                                     ///< The formatted predictions.
+    std::exception_ptr error;                                    ///< The error, if the processing failed.
+};
 
-            // Check file size
-            std::uintmax_t file_sz = std::filesystem::file_size(path);
-            if(file_sz == 0)
-                throw std::length_error("File is empty.");
-            else if(file_sz > c.max_filesize)
-                throw std::length_error("File is too large.");
+/**
+ * @brief Stores the formatted predictions of an item and publishes them to the caches.
+ * @param item The item.
+ * @param[in] predictions The formatted predictions.
+ * @param phash The index of results for near-duplicate images.
+ * @param[in] c The application configuration.
+ * @param[in] insert_phash If true, the predictions are inserted into the near-duplicate index.
+ */
+static void complete_item(classify_item &item, std::string predictions, phash_index &phash, configuration const &c, bool insert_phash)
+{
+    // The result of the first cascade stage alone must not be reused for images that are not downgraded
+    if(insert_phash && c.phash_distance >= 0 && !item.request.downgraded)
+        phash.insert(item.variant, item.phash, predictions, item.phash_generation);
 
-            // Load the image
-            cv::Mat image = cv::imread(path);
+    if(item.owner)
+        item.owner->set_value(predictions);
 
-            if(image.empty())
-                throw std::runtime_error("OpenCV could not read or decode image.");
+    item.predictions = std::move(predictions);
+}
 
-            // Run the model and classify the image
-            auto cls = model.predict(image, c.top_k);
+/**
+ * @brief Marks an item as failed and publishes the error to the waiting identical images.
+ *        The deduplication entry is removed, so that a later request for the same content is classified again.
+ * @param item The item.
+ * @param dedup The cache of results for byte-identical images.
+ * @param[in] error The error.
+ */
+static void fail_item(classify_item &item, dedup_cache &dedup, std::exception_ptr error)
+{
+    if(item.owner)
+    {
+        dedup.erase(item.variant, item.content_size, item.content_digest, item.dedup_generation);
 
-            // Format result
-            std::string result = path;
+        // Identical images fail with the same error, but the deadline of this job is not theirs
+        bool expired = false;
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch(deadline_exceeded const &)
+        {
+            expired = true;
+        }
+        catch(...)
+        {
+        }
 
-            if(c.enable_timing)
-            {
-                // Time of the image being loaded, resized and classified
-                auto end      = std::chrono::high_resolution_clock::now();
-                auto duration = end - start_timer;
+        item.owner->set_exception(expired ? std::make_exception_ptr(dedup_retry()) : error);
+        item.owner.reset();
+    }
 
-                result += ", " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()) + "ms";
-            }
+    item.error = error;
+}
 
-            if(c.top_k != 0)
-                result += ", ";
+/**
+ * @brief Checks that a path is a regular, non-empty image file within the maximum file size.
+ * @param[in] path The path.
+ * @param[in] c The application configuration (used for the maximum file size).
+ * @return The size of the file in bytes.
+ * @throws std::filesystem::filesystem_error if the path is not a regular file.
+ * @throws std::length_error if the file is empty or too large.
+ */
+static std::uintmax_t check_image_file(std::string const &path, configuration const &c)
+{
+    stage_scope scope(pipeline_stage::stat);
 
-            for(auto it = cls.begin(); it != cls.end(); ++it)
-            {
-                result += it->class_name + " " + std::to_string(it->confidence);
+    // Check if the path points to a regular file (not a directory, not non-existent)
+    if(!std::filesystem::is_regular_file(path))
+        throw std::filesystem::filesystem_error("Path is not a regular file or does not exist", path, std::make_error_code(std::errc::no_such_file_or_directory));
 
-                if(std::next(it) != cls.end())
-                    result += ", ";
-            }
+    // Check file size
+    std::uintmax_t file_sz = std::filesystem::file_size(path);
+    if(file_sz == 0)
+        throw std::length_error("File is empty.");
+    else if(file_sz > c.max_filesize)
+        throw std::length_error("File is too large.");
 
-            tsq_out.push(result);
-        }
-        catch(const std::exception &e)
-        {
-            std::stringstream ss;
-            ss << "yolo-cls: could not process the file \'" << *value << "\': " << e.what() << std::endl;
-            std::cerr << ss.str();
-        }
-    }
+    return file_sz;
 }
 
 /**
- * @brief The output thread function.
- *        Pops formatted results from the output queue and prints them to standard output.
- * @param tsq The thread-safe output queue.
+ * @brief Releases the memory of the input of a job: returns the buffer to its pool and drops the encoded bytes.
+ *        Releasing the input again has no effect.
+ * @param request The job.
  */
-void thread_print_tsq(tsqueue &tsq)
+static void release_input(job &request)
 {
-    while(auto value = tsq.pop())
-    {
-        std::cout << *value << std::endl;
-    }
+    if(request.pool)
+        request.pool->release(std::move(request.data));
+    else
+        std::vector<uchar>().swap(request.data);
+
+    request.pool = nullptr;
+    request.encoded.release();
+    request.owner.reset();
 }
 
 /**
- * @brief The input thread function for piped data.
- *        Reads lines (file paths) from standard input and pushes them to the input queue.
- * @param tsq_in The thread-safe input queue to push file paths to.
- * @param[in] c The application configuration (used for extension checking).
+ * @brief Loads and decodes the image of an item, resolving it from the caches when possible.
+ * @param item The item.
+ * @param dedup The cache of results for byte-identical images.
+ * @param phash The index of results for near-duplicate images.
+ * @param tensors The cache of preprocessed input tensors.
+ * @param[in] input_size The input size shared by all models, or an empty size if they differ.
+ * @param[in] c The application configuration.
+ * @return True if the decoded image (or its preprocessed tensor) still has to be classified.
  */
-void thread_get_line(tsqueue &tsq_in, configuration const &c)
+static bool load_item(classify_item &item, dedup_cache &dedup, phash_index &phash, tensor_cache &tensors, cv::Size input_size, configuration const &c)
 {
-    std::string line;
-    while(std::getline(std::cin, line))
+    cv::Mat const &decoded     = item.request.image;
+    cv::Mat const &encoded     = item.request.encoded;
+    std::vector<uchar> &buffer = item.request.data;
+
+    // Decode only the frames of this job, every frame is classified as a separate item
+    if(!item.request.frames.empty())
     {
-        // Checking the file extention
-        std::filesystem::path fp = line;
-        std::string extension    = fp.extension().string();
+        auto const &path   = item.request.path;
+        auto const &frames = item.request.frames;
 
-        if(!c.disable_extension_check)
+        check_image_file(path, c);
+
+        stage_scope scope(pipeline_stage::decode);
+
+        // The range of the job is decoded in a single pass, a decoder would otherwise walk the file again from the start
+        // for every sampled frame. The frames between the sampled ones are dropped.
+        int const first = frames.front();
+        int const count = frames.back() - first + 1;
+
+        cv::imreadmulti(path, item.frames, first, count, cv::IMREAD_COLOR);
+
+        if(item.frames.size() != static_cast<size_t>(count))
+            throw std::runtime_error("OpenCV could not read or decode the frames.");
+
+        if(count != static_cast<int>(frames.size()))
         {
-            if(is_supported_image(extension))
-                tsq_in.push(line);
+            std::vector<cv::Mat> sampled;
+            sampled.reserve(frames.size());
+            for(int index : frames)
+                sampled.push_back(item.frames[static_cast<size_t>(index - first)]);
+
+            item.frames = std::move(sampled);
         }
-        else
-            tsq_in.push(line);
+
+        return true;
     }
-    tsq_in.close();
-}
 
-/**
- * @brief Prints help information that is invoked by `-h` or `--help`
-*/
-void print_help()
-{
-    std::string help =
-        R"(yolo-cls: A command-line tool for YOLO-based image classification.
+    // Load the encoded image, unless it was received in memory. The bytes are only needed to key the caches,
+    // otherwise cv::imread reads the file without an intermediate buffer
+    bool const from_path = decoded.empty() && encoded.empty() && buffer.empty();
+    bool const keyed     = (c.enable_dedup && !item.request.downgraded) || tensors.enabled();
+    bool const read_path = from_path && !keyed;
 
-usage: yolo-cls [options...] [image_file...]
-       <command> | yolo-cls [options...]
+    if(from_path)
+    {
+        auto const &path          = item.request.path;
+        std::uintmax_t const size = check_image_file(path, c);
+
+        if(read_path)
+        {
+            pipeline_stats::count_bytes(size);
+        }
+        else
+        {
+            stage_scope scope(pipeline_stage::read);
+            buffer = read_file(path, size);
+        }
+    }
+
+    if(decoded.empty() && !read_path)
+        pipeline_stats::count_bytes(!encoded.empty() ? encoded.total() : buffer.size());
+
+    // Decoded images are keyed by their pixels, encoded images by their bytes
+    bool const hashable  = decoded.empty() || decoded.isContinuous();
+    bool const cacheable = tensors.enabled() && decoded.empty();
+    uchar const *bytes   = !decoded.empty() ? decoded.data : !encoded.empty() ? encoded.data : buffer.data();
+    size_t const size    = !decoded.empty() ? decoded.total() * decoded.elemSize() : !encoded.empty() ? encoded.total() : buffer.size();
+    bool const dedupable = c.enable_dedup && hashable && !item.request.downgraded;
+    bool const digested  = hashable && (cacheable || dedupable);
+
+    // The digest keys both the deduplication and the tensor cache
+    sha256_digest digest {};
+    if(digested)
+        digest = sha256(bytes, size);
+
+    // Wait for the result of an identical image instead of classifying it again.
+    // A downgraded image is classified by the first cascade stage only, so it neither waits for nor publishes a result
+    if(dedupable)
+    {
+        auto entry = dedup.lookup(item.variant, size, digest, item.dedup_generation);
+
+        if(!entry.owner)
+        {
+            item.duplicate = entry.result;
+            return false;
+        }
+
+        item.owner          = entry.owner;
+        item.content_size   = size;
+        item.content_digest = digest;
+    }
+
+    // Feed the cached tensor of the image, which is neither decoded nor preprocessed again
+    if(cacheable)
+    {
+        item.image = tensors.find(digest, size, item.tensor);
+
+        if(!item.image.empty())
+            return true;
+    }
+
+    // Decode the image, a decoded image is classified without a copy and mapped bytes are decoded in place
+    if(!decoded.empty())
+    {
+        item.image = decoded;
+    }
+    else
+    {
+        stage_scope scope(pipeline_stage::decode);
+
+        if(read_path)
+            item.image = cv::imread(item.request.path, cv::IMREAD_COLOR);
+        else if(!encoded.empty())
+            item.image = cv::imdecode(encoded, cv::IMREAD_COLOR);
+        else
+            item.image = cv::imdecode(buffer, cv::IMREAD_COLOR);
+    }
+
+    if(item.image.empty())
+        throw std::runtime_error("OpenCV could not read or decode image.");
+
+    // The preprocessed tensor is stored for the next run and classified instead of the image
+    if(cacheable)
+    {
+        stage_scope scope(pipeline_stage::preprocess);
+        item.image = tensors.store(digest, size, item.image);
+    }
+
+    // Reuse the result of a near-duplicate image
+    if(c.phash_distance >= 0)
+    {
+        // The image is resized to the model input here instead of in the inference, so the hash is computed from the small image
+        if(!input_size.empty() && item.image.size() != input_size)
+        {
+            stage_scope scope(pipeline_stage::preprocess);
+
+            cv::Mat resized;
+            cv::resize(item.image, resized, input_size);
+            item.image = resized;
+        }
+
+        item.phash = difference_hash(item.image);
+
+        if(auto stored = phash.find(item.variant, item.phash, c.phash_distance))
+        {
+            complete_item(item, *stored, phash, c, false);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief The main worker thread function.
+ *        Pops up to `configuration::batch_size` jobs from the input queue, performs classification,
+ *        formats the results, and pushes them to the output queue (or passes them to `job::reply`).
+ * @param tsq_in The thread-safe input queue for jobs.
+ * @param tsq_out The thread-safe output queue for formatted results.
+ * @param router The classifiers of the model variants, every image is routed to one of them.
+ * @param dedup The cache of results for byte-identical images (used if `configuration::enable_dedup` is set).
+ * @param phash The index of results for near-duplicate images (used if `configuration::phash_distance` is not negative).
+ * @param tensors The cache of preprocessed input tensors (used if it is enabled).
+ * @param stats The queueing and inference statistics.
+ * @param pipeline The per-stage statistics (`--stats`), the thread attaches its own recorder.
+ * @param[in] c The application configuration.
+ */
+void thread_classify(tsqueue<job> &tsq_in, tsqueue<std::string> &tsq_out, model_router &router, dedup_cache &dedup, phash_index &phash, tensor_cache &tensors, serving_stats &stats, pipeline_stats &pipeline, configuration const &c)
+{
+    pipeline.attach("worker");
+
+    // Wait for the batch to fill, but not so long that the oldest job misses its deadline
+    auto wait_until = [&](job const &oldest) { return std::min(oldest.received + c.max_queue_delay, oldest.deadline - stats.compute_estimate()); };
+
+    while(true)
+    {
+        std::vector<job> values;
+        {
+            // A worker waiting here is starved of input
+            trace_scope scope("wait");
+            values = (c.max_queue_delay.count() > 0) ? tsq_in.pop_batch(c.batch_size, wait_until) : tsq_in.pop_batch(c.batch_size);
+        }
+
+        if(values.empty())
+            break;
+
+        trace_scope batch_scope("batch");
+
+        auto const batch_start = std::chrono::steady_clock::now();
+        ++stats.busy_workers;
+
+        // The caches are cleared after a reload has swapped the models. Their generations are read before the snapshot,
+        // so if the batch runs on models that are swapped out meanwhile, its results are not stored
+        uint64_t const dedup_generation = dedup.generation();
+        uint64_t const phash_generation = phash.generation();
+
+        // The whole batch runs on the same models, even if they are reloaded meanwhile
+        auto const models = router.models();
+
+        // A near-duplicate image is hashed after resizing, which needs a single input size
+        cv::Size input_size = models.front()->input_size();
+        for(auto const &model : models)
+        {
+            if(model->input_size() != input_size)
+                input_size = cv::Size();
+        }
+
+        // Every box or frame of an image becomes an item of its own, reserved up front so that the items do not move
+        std::vector<classify_item> items(values.size());
+        items.reserve(std::accumulate(values.begin(), values.end(), values.size(), [](size_t sum, job const &j) { return sum + j.boxes.size() + j.frames.size(); }));
+
+        // Load and decode the images, grouped by the model variant
+        std::vector<std::vector<size_t>> pending(models.size());
+        std::vector<std::vector<cv::Mat>> images(models.size());
+        std::vector<std::vector<bool>> first_stage_only(models.size());
+
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            auto &item = items[i];
+
+            // Measure execution time
+            item.start            = std::chrono::high_resolution_clock::now();
+            item.request          = std::move(values[i]);
+            item.dedup_generation = dedup_generation;
+            item.phash_generation = phash_generation;
+
+            // The image is routed before the cache lookups, the variants of a canary rollout do not share results
+            item.variant = router.route();
+
+            stats.queue.record(std::chrono::duration_cast<std::chrono::microseconds>(batch_start - item.request.received));
+            pipeline_stats::set_image(item.request.name);
+
+            try
+            {
+                // Drop the job before reading the image if it is already late
+                if(batch_start > item.request.deadline)
+                    throw deadline_exceeded();
+
+                if(load_item(item, dedup, phash, tensors, input_size, c))
+                {
+                    // Decoding takes time, so check again right before the inference
+                    if(std::chrono::steady_clock::now() > item.request.deadline)
+                        throw deadline_exceeded();
+
+                    auto classify = [&](size_t index, cv::Mat const &image, size_t variant)
+                    {
+                        pending[variant].push_back(index);
+                        images[variant].push_back(image);
+                        first_stage_only[variant].push_back(item.request.downgraded);
+                    };
+
+                    // A box or a frame becomes an item of its own, named after the image
+                    auto add_part = [&](std::string const &suffix) -> classify_item &
+                    {
+                        classify_item &part = items.emplace_back();
+
+                        part.start         = item.start;
+                        part.request.name  = item.request.name + suffix;
+                        part.request.reply = item.request.reply;
+
+                        return part;
+                    };
+
+                    if(!item.request.boxes.empty())
+                    {
+                        // The crops refer to the decoded image, nothing is copied
+                        item.expanded = true;
+
+                        for(auto const &box : item.request.boxes)
+                        {
+                            classify_item &crop = add_part(" " + std::to_string(box.x) + " " + std::to_string(box.y) + " " + std::to_string(box.width) + " " + std::to_string(box.height));
+
+                            cv::Rect const clipped = box & cv::Rect(0, 0, item.image.cols, item.image.rows);
+                            if(clipped.empty())
+                            {
+                                crop.error = std::make_exception_ptr(std::out_of_range("The box is outside the image."));
+                                continue;
+                            }
+
+                            crop.image = item.image(clipped);
+                            classify(items.size() - 1, crop.image, router.route());
+                        }
+                    }
+                    else if(!item.request.frames.empty())
+                    {
+                        // The frames of a multi-frame image are classified in the same batch
+                        item.expanded = true;
+
+                        for(size_t f = 0; f < item.frames.size(); ++f)
+                        {
+                            classify_item &frame = add_part("#" + std::to_string(item.request.frames[f]));
+
+                            if(item.frames[f].empty())
+                            {
+                                frame.error = std::make_exception_ptr(std::runtime_error("OpenCV could not read or decode the frame."));
+                                continue;
+                            }
+
+                            frame.image = item.frames[f];
+                            classify(items.size() - 1, frame.image, router.route());
+                        }
+
+                        item.frames.clear();
+                    }
+                    else
+                    {
+                        classify(i, item.image, item.variant);
+                    }
+                }
+            }
+            catch(...)
+            {
+                fail_item(item, dedup, std::current_exception());
+            }
+
+            // The encoded bytes are not needed after decoding, a pooled buffer behind a decoded image is kept until the inference is done.
+            // A duplicate keeps its input in case it has to be queued again.
+            if(item.request.image.empty() && !item.duplicate)
+                release_input(item.request);
+        }
+
+        pipeline_stats::clear_image();
+
+        // Run the models and classify the images of every variant in a single batch
+        auto const compute_start = std::chrono::steady_clock::now();
+
+        for(size_t v = 0; v < models.size(); ++v)
+        {
+            if(images[v].empty())
+                continue;
+
+            try
+            {
+                auto const variant_start = std::chrono::steady_clock::now();
+                auto cls                 = models[v]->predict_batch(images[v], c.top_k, first_stage_only[v]);
+                auto const variant_time  = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - variant_start);
+
+                if(v < stats.models.size())
+                {
+                    stats.models[v].compute.record(variant_time);
+                    stats.models[v].classified += pending[v].size();
+                }
+
+                for(size_t j = 0; j < pending[v].size(); ++j)
+                {
+                    pipeline_stats::set_image(items[pending[v][j]].request.name);
+
+                    std::string predictions;
+                    {
+                        stage_scope scope(pipeline_stage::format);
+                        predictions = models[v]->format(cls[j]);
+                    }
+
+                    complete_item(items[pending[v][j]], std::move(predictions), phash, c, true);
+                }
+            }
+            catch(...)
+            {
+                for(size_t index : pending[v])
+                    fail_item(items[index], dedup, std::current_exception());
+            }
+        }
+
+        pipeline_stats::clear_image();
+
+        for(auto &item : items)
+        {
+            if(!item.duplicate)
+                release_input(item.request);
+        }
+
+        // The admission control estimates the latency from the time of the whole batch
+        size_t const classified = std::accumulate(pending.begin(), pending.end(), size_t(0), [](size_t sum, auto const &p) { return sum + p.size(); });
+        if(classified != 0)
+        {
+            auto const compute_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - compute_start);
+
+            stats.record_batch(compute_time);
+            stats.compute.record(compute_time);
+            stats.classified += classified;
+        }
+
+        --stats.busy_workers;
+
+        // Wait for the results of identical images.
+        // The results of this batch have been published above, so waiting cannot deadlock.
+        for(auto &item : items)
+        {
+            if(!item.duplicate)
+                continue;
+
+            try
+            {
+                item.predictions = item.duplicate->get();
+            }
+            catch(dedup_retry const &)
+            {
+                item.retry = true;
+            }
+            catch(...)
+            {
+                item.error = std::current_exception();
+            }
+        }
+
+        for(auto &item : items)
+        {
+            // The identical image expired before its inference, this job looks up the cache again (and may classify the image).
+            // This thread pops the input queue again, so the job is not lost even if the queue has been closed.
+            if(item.retry)
+            {
+                size_t const level = static_cast<size_t>(item.request.priority);
+                tsq_in.push(std::move(item.request), level);
+                continue;
+            }
+
+            release_input(item.request);
+
+            // The crops of the boxes and the frames report their own results
+            if(item.expanded)
+                continue;
+
+            pipeline_stats::set_image(item.request.name);
+
+            try
+            {
+                if(item.error)
+                    std::rethrow_exception(item.error);
+
+                // Format result, the predictions have been formatted (and timed) per model after the inference
+                std::string result = item.request.name;
+
+                if(c.enable_timing)
+                {
+                    // Time of the image being loaded, resized and classified
+                    auto end      = std::chrono::high_resolution_clock::now();
+                    auto duration = end - item.start;
+
+                    result += ", " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()) + "ms";
+                }
+
+                if(c.top_k != 0)
+                    result += ", ";
+
+                result += item.predictions;
+
+                pipeline_stats::count_image();
+
+                if(item.request.reply)
+                    item.request.reply(job_status::done, result);
+                else
+                    tsq_out.push(result);
+            }
+            catch(const std::exception &e)
+            {
+                std::string const message = "could not process the file \'" + item.request.name + "\': " + e.what();
+                bool const expired        = dynamic_cast<deadline_exceeded const *>(&e) != nullptr;
+
+                if(expired)
+                    ++stats.expired;
+
+                // The reason of a filesystem error without the path, so that errors of different files add up
+                auto const *fs_error = dynamic_cast<std::filesystem::filesystem_error const *>(&e);
+                pipeline_stats::count_error(fs_error ? fs_error->code().message() : e.what());
+
+                if(item.request.reply)
+                {
+                    item.request.reply(expired ? job_status::expired : job_status::failed, message);
+                }
+                else
+                {
+                    std::stringstream ss;
+                    ss << "yolo-cls: " << message << std::endl;
+                    std::cerr << ss.str();
+                }
+            }
+        }
+
+        pipeline_stats::clear_image();
+    }
+}
+
+/**
+ * @brief The output thread function.
+ *        Pops formatted results from the output queue and prints them to standard output.
+ * @param tsq The thread-safe output queue.
+ * @param pipeline The per-stage statistics (`--stats`), the thread attaches its own recorder.
+ */
+void thread_print_tsq(tsqueue<std::string> &tsq, pipeline_stats &pipeline)
+{
+    pipeline.attach("output");
+
+    while(auto value = tsq.pop())
+    {
+        stage_scope scope(pipeline_stage::output);
+        std::cout << *value << std::endl;
+    }
+}
+
+/**
+ * @brief The input thread function for piped data.
+ *        Reads lines (file paths) from standard input and pushes them to the input queue.
+ * @param tsq_in The thread-safe input queue to push file paths to.
+ * @param[in] c The application configuration (used for extension checking).
+ */
+void thread_get_line(tsqueue<job> &tsq_in, configuration const &c)
+{
+    std::string line;
+    while(std::getline(std::cin, line))
+    {
+        // Checking the file extention
+        std::filesystem::path fp = line;
+        std::string extension    = fp.extension().string();
+
+        if(!c.disable_extension_check)
+        {
+            if(is_supported_image(extension))
+                push_image_path(tsq_in, line, c);
+        }
+        else
+            push_image_path(tsq_in, line, c);
+    }
+    tsq_in.close();
+}
+
+/**
+ * @brief Pushes the job of an image path to the input queue.
+ *        With `configuration::all_frames` the frames of a multi-frame image, sampled by `configuration::every_n_frames`,
+ *        are split into jobs of up to `configuration::batch_size` frames, so that the frames are decoded lazily, a job at a time.
+ * @param tsq_in The thread-safe input queue to push the jobs to.
+ * @param[in] path The path to the image.
+ * @param[in] c The application configuration.
+ */
+void push_image_path(tsqueue<job> &tsq_in, std::string const &path, configuration const &c)
+{
+    size_t count = 1;
+
+    // Counting the frames reads only the headers, a failure leaves the error to the worker thread
+    if(c.all_frames && is_multi_frame_image(std::filesystem::path(path).extension().string()))
+    {
+        try
+        {
+            count = cv::imcount(path, cv::IMREAD_COLOR);
+        }
+        catch(std::exception const &)
+        {
+            count = 1;
+        }
+    }
+
+    if(count <= 1)
+    {
+        tsq_in.push(job {path, path});
+        return;
+    }
+
+    size_t const chunk = std::max(c.batch_size, 1u);
+    job request {path, path};
+
+    for(size_t index = 0; index < count; index += std::max(c.every_n_frames, 1u))
+    {
+        request.frames.push_back(static_cast<int>(index));
+
+        if(request.frames.size() == chunk)
+        {
+            tsq_in.push(std::move(request));
+            request = job {path, path};
+        }
+    }
+
+    if(!request.frames.empty())
+        tsq_in.push(std::move(request));
+}
+
+/**
+ * @brief Parses a `<path> <x> <y> <width> <height>` line of a detector. The path may contain spaces.
+ * @param[in] line The line.
+ * @return The path and the box, or `std::nullopt` if the line is not a box.
+ */
+std::optional<std::pair<std::string, cv::Rect>> parse_box_line(std::string const &line)
+{
+    // The four numbers are taken from the end of the line, the rest is the path
+    int values[4];
+    size_t end = line.find_last_not_of(" \t\r");
+
+    for(int i = 3; i >= 0; --i)
+    {
+        if(end == std::string::npos)
+            return std::nullopt;
+
+        size_t const begin = line.find_last_of(" \t", end);
+        if(begin == std::string::npos)
+            return std::nullopt;
+
+        try
+        {
+            size_t parsed = 0;
+            values[i]     = std::stoi(line.substr(begin + 1, end - begin), &parsed);
+
+            if(parsed != end - begin)
+                return std::nullopt;
+        }
+        catch(std::exception const &)
+        {
+            return std::nullopt;
+        }
+
+        end = line.find_last_not_of(" \t", begin);
+    }
+
+    if(end == std::string::npos || values[2] <= 0 || values[3] <= 0)
+        return std::nullopt;
+
+    // The crop is clipped to the image with `x + width` and `y + height`, which must not overflow
+    if(values[0] > std::numeric_limits<int>::max() - values[2] || values[1] > std::numeric_limits<int>::max() - values[3])
+        return std::nullopt;
+
+    return std::make_pair(line.substr(0, end + 1), cv::Rect(values[0], values[1], values[2], values[3]));
+}
+
+/**
+ * @brief The input thread function for the boxes of a detector (`--stdin-format boxes`).
+ *        Reads `<path> <x> <y> <width> <height>` lines from standard input and pushes a single job
+ *        with all boxes of consecutive lines of the same path, so the image is decoded only once.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param[in] c The application configuration (used for the extension check).
+ */
+void thread_get_boxes(tsqueue<job> &tsq_in, configuration const &c)
+{
+    std::optional<job> current;
+
+    auto flush = [&]()
+    {
+        if(current)
+            tsq_in.push(std::move(*current));
+
+        current.reset();
+    };
+
+    std::string line;
+    while(std::getline(std::cin, line))
+    {
+        auto box = parse_box_line(line);
+
+        if(!box)
+        {
+            if(line.find_first_not_of(" \t\r") != std::string::npos)
+            {
+                std::stringstream ss;
+                ss << "yolo-cls: could not parse the box '" << line << "', expected <path> <x> <y> <width> <height>." << std::endl;
+                std::cerr << ss.str();
+            }
+
+            continue;
+        }
+
+        auto &[path, rect] = *box;
+
+        if(!c.disable_extension_check && !is_supported_image(std::filesystem::path(path).extension().string()))
+            continue;
+
+        // The boxes of consecutive lines of the same image are classified together
+        if(!current || current->path != path)
+        {
+            flush();
+            current = job {path, path};
+        }
+
+        current->boxes.push_back(rect);
+    }
+
+    flush();
+    tsq_in.close();
+}
+
+/**
+ * @brief Reads a length-prefixed record (`[u32 little-endian length][bytes]`) from a stream.
+ * @param[in] stream The stream, opened in binary mode.
+ * @param[out] buffer Receives the bytes of the record if its length is within `max_size`. Its capacity is reused.
+ * @param[in] max_size Larger records are skipped.
+ * @return The length of the record, or `std::nullopt` at the end of the stream.
+ * @throws std::runtime_error if the stream ends inside a record.
+ */
+std::optional<uint32_t> read_frame(std::FILE *stream, std::vector<uchar> &buffer, uint64_t max_size)
+{
+    unsigned char header[4];
+    size_t const header_read = std::fread(header, 1, sizeof(header), stream);
+
+    if(header_read == 0)
+        return std::nullopt;
+
+    if(header_read != sizeof(header))
+        throw std::runtime_error("the input ends inside a frame header.");
+
+    uint32_t const size = static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) | (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+
+    if(size > max_size)
+    {
+        // Skip the record without keeping it in memory
+        buffer.clear();
+
+        char skipped[64 * 1024];
+        for(uint32_t left = size; left > 0;)
+        {
+            size_t const count = std::fread(skipped, 1, std::min<size_t>(left, sizeof(skipped)), stream);
+            if(count == 0)
+                throw std::runtime_error("the input ends inside a frame.");
+
+            left -= static_cast<uint32_t>(count);
+        }
+
+        return size;
+    }
+
+    buffer.resize(size);
+
+    if(std::fread(buffer.data(), 1, size, stream) != size)
+        throw std::runtime_error("the input ends inside a frame.");
+
+    return size;
+}
+
+/**
+ * @brief The input thread function for piped encoded images (`--stdin-format frames`).
+ *        Reads length-prefixed records from standard input into pooled buffers and pushes them to the input queue.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param pool The buffers of the records, returned by the worker threads once the images are decoded.
+ * @param[in] c The application configuration (used for the maximum file size).
+ */
+void thread_get_frames(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c)
+{
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+    // Large reads, the records are copied straight into the pooled buffers
+    std::setvbuf(stdin, nullptr, _IOFBF, 1024 * 1024);
+
+    try
+    {
+        for(size_t index = 1;; ++index)
+        {
+            job request {"frame:" + std::to_string(index), ""};
+            request.data = pool.acquire();
+            request.pool = &pool;
+
+            auto const size = read_frame(stdin, request.data, c.max_filesize);
+            if(!size)
+            {
+                pool.release(std::move(request.data));
+                break;
+            }
+
+            if(*size == 0 || request.data.empty())
+            {
+                pool.release(std::move(request.data));
+
+                std::stringstream ss;
+                ss << "yolo-cls: could not process the file '" << request.name << "': " << (*size == 0 ? "File is empty." : "File is too large.") << std::endl;
+                std::cerr << ss.str();
+                continue;
+            }
+
+            tsq_in.push(std::move(request));
+        }
+    }
+    catch(std::exception const &e)
+    {
+        std::stringstream ss;
+        ss << "yolo-cls: " << e.what() << std::endl;
+        std::cerr << ss.str();
+    }
+
+    tsq_in.close();
+}
+
+/**
+ * @brief Streams the image members of a tar archive into pooled buffers and pushes them to the input queue.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param pool The buffers of the members.
+ * @param[in] archive The path to the archive, `-` for the standard input.
+ * @param[in] c The application configuration (used for extension checking and the maximum file size).
+ */
+static void read_tar(tsqueue<job> &tsq_in, buffer_pool &pool, std::string const &archive, configuration const &c)
+{
+    bool const is_stdin = (archive == "-");
+    std::FILE *stream   = is_stdin ? stdin : std::fopen(archive.c_str(), "rb");
+
+    if(!stream)
+    {
+        std::stringstream ss;
+        ss << "yolo-cls: could not open the archive '" << archive << "'." << std::endl;
+        std::cerr << ss.str();
+        return;
+    }
+
+#ifdef _WIN32
+    if(is_stdin)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+    // Large sequential reads, members larger than the buffer are read straight into the pooled buffers
+    std::setvbuf(stream, nullptr, _IOFBF, 1024 * 1024);
+
+    std::string const prefix = (is_stdin ? std::string("stdin") : archive) + ":";
+    tar_reader reader(stream, is_stdin ? "stdin" : archive);
+
+    try
+    {
+        std::string member;
+        while(auto const size = reader.next(member))
+        {
+            // Other files of a sample (e.g., `.cls` or `.json` in WebDataset shards)
+            if(!c.disable_extension_check && !is_supported_image(std::filesystem::path(member).extension().string()))
+                continue;
+
+            job request {prefix + member, ""};
+
+            if(*size == 0 || *size > c.max_filesize)
+            {
+                std::stringstream ss;
+                ss << "yolo-cls: could not process the file '" << request.name << "': " << (*size == 0 ? "File is empty." : "File is too large.") << std::endl;
+                std::cerr << ss.str();
+                continue;
+            }
+
+            request.data = pool.acquire();
+            request.pool = &pool;
+
+            try
+            {
+                reader.read(request.data);
+            }
+            catch(...)
+            {
+                pool.release(std::move(request.data));
+                throw;
+            }
+
+            tsq_in.push(std::move(request));
+        }
+    }
+    catch(std::exception const &e)
+    {
+        std::stringstream ss;
+        ss << "yolo-cls: " << e.what() << std::endl;
+        std::cerr << ss.str();
+    }
+
+    if(!is_stdin)
+        std::fclose(stream);
+}
+
+/**
+ * @brief The input thread function for tar archives (`--tar` or `--stdin-format tar`).
+ *        Streams the image members of the archives into pooled buffers and pushes them to the input queue,
+ *        named `<archive>:<member>`. Up to `configuration::threads` archives are read in parallel.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param pool The buffers of the members, returned by the worker threads once the images are decoded.
+ * @param[in] c The application configuration. Without `configuration::tar_paths` the archive is read from standard input.
+ */
+void thread_get_tar(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c)
+{
+    std::vector<std::string> const archives = c.tar_paths.empty() ? std::vector<std::string> {"-"} : c.tar_paths;
+    std::atomic<size_t> next {0};
+
+    auto read_archives = [&]()
+    {
+        for(size_t i = next++; i < archives.size(); i = next++)
+            read_tar(tsq_in, pool, archives[i], c);
+    };
+
+    // Every reader takes the next archive, this thread is one of them
+    size_t const readers = std::min<size_t>(archives.size(), std::max(c.threads, 1u));
+
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < readers; ++i)
+        threads.emplace_back(read_archives);
+
+    read_archives();
+
+    for(auto &t : threads)
+        t.join();
+
+    tsq_in.close();
+}
+
+/**
+ * @brief The input thread function for record files (`--records`).
+ *        Maps the record files and pushes their images to the input queue without a copy,
+ *        every job keeps its record file mapped until the image is decoded.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param pool Bounds the queued images, every job holds an empty buffer of the pool until the image is decoded.
+ * @param[in] c The application configuration (used for the maximum file size).
+ */
+void thread_get_records(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c)
+{
+    for(auto const &path : c.records_paths)
+    {
+        try
+        {
+            auto const file = std::make_shared<record_file const>(path);
+
+            for(size_t i = 0; i < file->size(); ++i)
+            {
+                auto const r = (*file)[i];
+
+                job j {std::string(r.path), std::string(r.path)};
+
+                // The size is checked before it becomes the int width of the wrapping matrix
+                if(r.size == 0 || r.size > c.max_filesize || r.size > static_cast<size_t>(std::numeric_limits<int>::max()))
+                {
+                    std::stringstream ss;
+                    ss << "yolo-cls: could not process the file '" << j.name << "': " << (r.size == 0 ? "File is empty." : "File is too large.") << std::endl;
+                    std::cerr << ss.str();
+                    continue;
+                }
+
+                // The buffer stays empty, it only stops the reader from queueing more images than the worker threads can keep up with
+                j.data    = pool.acquire();
+                j.pool    = &pool;
+                j.encoded = cv::Mat(1, static_cast<int>(r.size), CV_8UC1, const_cast<uchar *>(r.data));
+                j.owner   = file;
+
+                tsq_in.push(std::move(j));
+            }
+        }
+        catch(std::exception const &e)
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: " << e.what() << std::endl;
+            std::cerr << ss.str();
+        }
+    }
+
+    tsq_in.close();
+}
+
+/**
+ * @brief Prints help information that is invoked by `-h` or `--help`
+*/
+void print_help()
+{
+    std::string help =
+        R"(yolo-cls: A command-line tool for YOLO-based image classification.
+
+usage: yolo-cls [options...] [image_file...]
+       <command> | yolo-cls [options...]
+       <command> | yolo-cls --stdin-format frames|tar|boxes [options...]
+       yolo-cls --tar <archive.tar> [--tar <archive.tar>...] [options...]
+       yolo-cls --records <file.ycr> [--records <file.ycr>...] [options...]
+       yolo-cls pack -o <file.ycr> [image_file...]
+       yolo-cls --video <video> [--video <video>...] [--every-n-frames <int> | --fps <float>] [options...]
+       yolo-cls serve [--socket <path>] [--http <host:port>] [options...]
+       <command> | yolo-cls --connect <path> [-D]
 
 The application can process image file paths provided as arguments or piped from
-standard input (one path per line).
+standard input (one path per line). With --stdin-format frames the standard input
+carries the encoded images, every image is prefixed with its 32-bit little-endian
+length, and the results are named frame:1, frame:2 and so on. With --tar or
+--stdin-format tar the image members of tar archives are classified without
+extracting them, and the results are named <archive>:<member>. With --stdin-format
+boxes every line is a box of a detector, the image is decoded once for the boxes
+of consecutive lines and the crop of every box is classified, keyed by the box.
+
+With pack the images (arguments or paths piped from standard input) are written
+to a record file, a page-aligned archive of the encoded images with an index.
+With --records the record files are memory-mapped and read sequentially, the
+images are decoded straight from the mapping without opening every file.
+
+With --video the sampled frames of video files are classified without writing them
+to disk, and the results are named <video>@<HH:MM:SS.mmm>. Every video is decoded
+by its own thread, use -b to classify several frames in a single inference run.
+
+With serve the models stay loaded and the application classifies the images sent
+to the Unix socket: newline-terminated paths, or a zero byte followed by a 32-bit
+little-endian length and the encoded image. Every request is answered with a line
+starting with '+' (the result) or '-' (the error). With --connect the application
+sends the paths to a running daemon instead of loading the models and prints the
+results as usual. With --http the daemon also answers POST /classify (the image as
+the body or as a multipart file), GET /healthz and GET /metrics. Co-located producers can
+send decoded frames through a shared-memory ring with the socket command !shm (Linux only).
 
 Options:
   -m, --model <path>             Required. Path to the ONNX model file.
+                                 Repeat to classify every image with several models (one -c per -m,
+                                 or a single shared -c). The image is decoded once for all models.
   -c, --classes <path>           Required. Path to the text file containing class names.
   -k, --top-k <int>              Number of top results to show. [default: 5]
   -t, --threads <int>            Number of threads to use for classification. [default: number of hardware cores]
+  -b, --batch, --max-batch <int> Maximum number of images per inference run. Models with a dynamic batch
+                                 dimension classify the whole batch at once. [default: 1]
+      --max-queue-delay-us <int> Wait up to this long for a batch to fill before running it, but never past
+                                 the deadline of the oldest image, 0 to 60000000. [default: 0, run what is queued]
   -F, --max-filesize <size>      Maximum allowed filesize for images (e.g., 100mb, 2g). [default: 100mb]
   -T, --timing                   Enable printing processing time for each image.
   -S, --softmax                  Apply softmax to the output scores.
   -D, --no-extension-check       Disable image file extension check (e.g., .jpg, .png).
+      --dedup                    Classify byte-identical images only once and reuse the result. Images are
+                                 matched by size and SHA-256 digest, the 262144 most recent are kept.
+      --phash-distance <int>     Reuse the result of a near-duplicate image whose perceptual hash is
+                                 within the Hamming distance (0-64). Up to 262144 hashes are kept, the index
+                                 starts over when it is full. [default: disabled]
+      --input-size <size>        Inference resolution for models with dynamic spatial dimensions
+                                 (e.g., 320 or 320x256). It must match a dimension that is fixed. [default: 224]
+      --fold-preprocessing       Fold the preprocessing (BGR to RGB, scaling, NCHW layout) into the model
+                                 graph at load time. The decoded image is fed without a copy.
+                                 Requires ONNX Runtime 1.22 or newer.
+      --graph-top-k              Append Softmax (with -S) and TopK nodes to the model graph at load time,
+                                 so that only the top K results leave the session.
+                                 Requires ONNX Runtime 1.22 or newer.
+      --cascade <spec>           Run a cascade of models instead of -m (e.g., fast.onnx:0.9,big.onnx).
+                                 An image goes to the next model only if the top-1 softmax confidence
+                                 is below the threshold (0 to 1). Confidences are always softmax probabilities.
+                                 Give one -c per stage, or a single -c shared by all stages.
+      --socket <path>            serve: the Unix socket to listen on (mode 0600, only its owner can connect).
+      --http <host:port>         serve: the HTTP address to listen on (e.g., 127.0.0.1:8080).
+      --slo-ms <int>             serve: reject an image right away ("Busy") if its estimated latency, from the
+                                 queued images and recent inference times, exceeds the SLO (1 to 86400000).
+                                 [default: disabled]
+      --slo-downgrade            serve: classify interactive images over the SLO with the first cascade stage
+                                 instead of rejecting them. Bulk images are still rejected.
+      --canary <model>:<share>   Classify the given share of the images (e.g., new.onnx:0.05) with another model,
+                                 to compare it against -m or --cascade. serve reports the latency per model.
+      --watch-models             serve: reload the models when the model or class files change. The new models
+                                 are loaded and warmed up in the background, then swapped in at once.
+                                 A failed reload is retried every second. A reload is also requested by the socket command !reload or POST /reload.
+      --stdin-format <format>    The format of the piped standard input: lines (one path per line), frames
+                                 (length-prefixed encoded images), tar (a tar archive) or boxes (one
+                                 "<path> <x> <y> <width> <height>" box per line). [default: lines]
+      --tar <path>               Classify the image members of a tar archive (e.g., a WebDataset shard).
+                                 Repeat for several archives, up to -t archives are read in parallel.
+      --records <path>           Classify the images of a record file written by pack. Repeat for several files.
+  -o, --output <path>            pack: the record file to write.
+      --video <path>             Classify the frames of a video file (requires OpenCV videoio). Repeat for several
+                                 videos, up to -t videos are decoded in parallel.
+      --every-n-frames <int>     --video, --all-frames: classify every Nth frame. The others are skipped without
+                                 decoding in videos, and decoded and dropped in multi-frame images. [default: 1]
+      --fps <float>              --video: classify this many frames per second of video instead. [default: disabled]
+      --all-frames               Classify every frame of animated GIF and WebP images and every page of TIFF images
+                                 given as paths. The results are named <path>#<frame>. The frames are decoded
+                                 lazily, up to -b frames at a time, and classified in a single inference run.
+      --tensor-cache <dir>       Store the preprocessed input tensor of every image in the directory, keyed by
+                                 the SHA-256 digest of the image, the input size, the version of the
+                                 preprocessing and the tensor format. Cached images are neither decoded nor
+                                 preprocessed again. All models must share the input size.
+      --tensor-format <format>   The element type of the cached tensors: fp32 (fed without a copy), fp16
+                                 (half the size) or uint8 (a quarter of the size, lossless). [default: fp32]
+      --stats                    At exit, print per-stage statistics to standard error: count, throughput,
+                                 p50/p90/p99/max and total time of stat, read, decode, preprocess, run,
+                                 postprocess, format and output, bytes read and errors by reason.
+      --stats-json <path>        At exit, write the per-stage statistics as JSON to the file.
+      --trace <path>             Record the spans of every image, stage and thread and the ONNX Runtime profile
+                                 of every model, and write them to the file in the Chrome trace event format
+                                 (open it with ui.perfetto.dev or chrome://tracing).
+      --connect <path>           Send the images to the daemon listening on the Unix socket.
   -h, --help                     Print this help message and exit.
   -v, --version                  Print version information and exit.
   -a, --about                    Print about information and exit.
@@ -404,6 +1991,20 @@ Options:
 Examples:
   yolo-cls -m ./yolo11x-cls.onnx -c ./imagenet.names ./fox.png
   find . | yolo-cls -m ./yolo11x-cls.onnx -c ./imagenet.names
+  find . | yolo-cls -m ./content.onnx -c ./content.names -m ./nsfw.onnx -c ./nsfw.names
+  find . | yolo-cls --cascade ./yolov8n-cls.onnx:0.9,./yolo11x-cls.onnx -c ./imagenet.names
+  find ./dataset -name '*.jpg' | yolo-cls pack -o ./dataset.ycr
+  yolo-cls --records ./dataset.ycr -m ./yolo11x-cls.onnx -c ./imagenet.names
+  yolo-cls --all-frames --every-n-frames 5 -b 8 -m ./yolo11x-cls.onnx -c ./imagenet.names ./scan.tiff
+  ./detector | yolo-cls --stdin-format boxes -b 32 -m ./yolo11x-cls.onnx -c ./imagenet.names
+  yolo-cls --video ./camera.mp4 --fps 2 -b 16 -m ./yolo11x-cls.onnx -c ./imagenet.names
+  yolo-cls --records ./dataset.ycr -m ./candidate.onnx -c ./imagenet.names --tensor-cache ./tensors
+  find . | yolo-cls --stats -t 8 -m ./yolo11x-cls.onnx -c ./imagenet.names > /dev/null
+  find . | yolo-cls --trace ./trace.json -t 8 -b 8 -m ./yolo11x-cls.onnx -c ./imagenet.names > /dev/null
+  yolo-cls serve --socket /run/yolo-cls.sock -m ./yolo11x-cls.onnx -c ./imagenet.names
+  find . | yolo-cls --connect /run/yolo-cls.sock
+  yolo-cls serve --http 127.0.0.1:8080 -m ./yolo11x-cls.onnx -c ./imagenet.names
+  curl --data-binary @fox.png http://127.0.0.1:8080/classify
 )";
 
     std::cout << help << std::endl;
@@ -31,8 +31,22 @@
 #define UTILS_H
 
 #include "tsqueue.h"
+#include "job.h"
 #include "yolo.h"
+#include "dedup.h"
+#include "phash.h"
+#include "classifier.h"
+#include "router.h"
+#include "stats.h"
+#include "stage_stats.h"
+#include "buffer_pool.h"
+#include "tar_reader.h"
+#include "tensor_cache.h"
 
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <string_view>
 #include <thread>
 
 /**
@@ -47,24 +61,128 @@ uint64_t string_unit_to_numeric(std::string const &unit);
 /**
  * @brief Checks if a file extension corresponds to an image format supported by OpenCV.
  * @param[in] extension The file extension (e.g., `.jpg`, `png`). Case-insensitive.
- * @return True if the extension is supported, false otherwise.
+ * @return True if the extension is supported, false otherwise. GIF is supported only if OpenCV can decode it.
  */
 bool is_supported_image(std::string_view extension);
 
+/**
+ * @brief Checks if a file extension corresponds to an image format that may hold several frames or pages
+ *        (animated GIF and WebP, multi-page TIFF).
+ * @param[in] extension The file extension (e.g., `.tif`, `gif`). Case-insensitive.
+ * @return True if the image may have several frames.
+ */
+bool is_multi_frame_image(std::string_view extension);
+
+/**
+ * @brief Reads the whole file into memory.
+ * @param[in] path The path to the file.
+ * @param[in] size The expected size of the file in bytes.
+ * @return The content of the file.
+ * @throws std::filesystem::filesystem_error if the file cannot be opened or read.
+ */
+std::vector<uchar> read_file(std::string const &path, std::uintmax_t size);
+
+/**
+ * @brief Parses a cascade specification (e.g., `fast.onnx:0.9,big.onnx`).
+ * @param[in] spec Comma-separated model paths. Every model except the last one has a `:threshold` suffix.
+ * @return The stages as (model path, top-1 confidence threshold) pairs. The thresholds are in [0, 1], the threshold of the last stage is 0.
+ * @throws std::invalid_argument if the specification is invalid or a threshold is outside [0, 1].
+ */
+std::vector<std::pair<std::string, float>> parse_cascade(std::string const &spec);
+
+/**
+ * @brief Parses a decimal integer within a range (e.g., a duration from a command or a header).
+ * @param[in] value The digits, without a sign or spaces.
+ * @param[in] min The smallest accepted value.
+ * @param[in] max The largest accepted value.
+ * @return The value, or `std::nullopt` if the text is not a decimal integer from `min` to `max`.
+ */
+std::optional<int64_t> parse_integer(std::string_view value, int64_t min, int64_t max);
+
+/**
+ * @brief Parses an inference resolution (e.g., `320` or `320x256`).
+ * @param[in] size The resolution as `<size>` (square) or `<width>x<height>`.
+ * @return The (width, height) pair.
+ * @throws std::invalid_argument if the resolution is invalid.
+ */
+std::pair<int64_t, int64_t> parse_input_size(std::string const &size);
+
+/**
+ * @brief Parses a canary specification (e.g., `new.onnx:0.05`).
+ * @param[in] spec The model path and the share of the images routed to it, separated by a colon.
+ * @return The (model path, share) pair. The share is in (0, 1).
+ * @throws std::invalid_argument if the specification is invalid.
+ */
+std::pair<std::string, double> parse_canary(std::string const &spec);
+
+/**
+ * @enum stdin_format
+ * @brief The format of the piped standard input.
+ */
+enum class stdin_format
+{
+    lines,  ///< One image path per line.
+    frames, ///< Encoded images, every image is prefixed with its 32-bit little-endian length.
+    tar,    ///< A tar archive, the image members are classified.
+    boxes,  ///< One `<path> <x> <y> <width> <height>` box per line, the crops of the boxes are classified.
+};
+
+/**
+ * @brief Reads a length-prefixed record (`[u32 little-endian length][bytes]`) from a stream.
+ * @param[in] stream The stream, opened in binary mode.
+ * @param[out] buffer Receives the bytes of the record if its length is within `max_size`. Its capacity is reused.
+ * @param[in] max_size Larger records are skipped.
+ * @return The length of the record, or `std::nullopt` at the end of the stream.
+ * @throws std::runtime_error if the stream ends inside a record.
+ */
+std::optional<uint32_t> read_frame(std::FILE *stream, std::vector<uchar> &buffer, uint64_t max_size);
+
 /**
  * @struct configuration
  * @brief Holds the application's configuration settings, parsed from command-line arguments.
  */
 struct configuration
 {
-    std::string model_path       = "";                                  ///< Path to the ONNX model file.
-    std::string classes_path     = "";                                  ///< Path to the text file with class names.
+    std::vector<std::string> model_paths;                               ///< Paths to the ONNX model files, one per model.
+    std::vector<std::string> classes_paths;                             ///< Paths to the text files with class names, one per model or one shared by all models.
     int top_k                    = 5;                                   ///< Number of top classification results to show.
     unsigned int threads         = std::thread::hardware_concurrency(); ///< Number of worker threads.
     bool enable_timing           = false;                               ///< If true, include processing time in the output.
     bool use_softmax             = false;                               ///< If true, apply softmax to model output.
     uint64_t max_filesize        = string_unit_to_numeric("100mb");     ///< Maximum allowed image file size in bytes.
     bool disable_extension_check = false;                               ///< If true, do not check file extensions.
+    bool enable_dedup            = false;                               ///< If true, classify byte-identical images only once.
+    int phash_distance           = -1;                                  ///< Maximum Hamming distance to reuse the result of a near-duplicate image, negative to disable.
+    std::vector<std::pair<std::string, float>> cascade;                 ///< Cascade stages as (model path, top-1 confidence threshold) pairs.
+    unsigned int batch_size      = 1;                                   ///< Maximum number of images classified in a single session run.
+    std::chrono::microseconds max_queue_delay {0};                      ///< Maximum time to wait for a batch to fill, 0 to run what is queued.
+    std::chrono::microseconds slo {0};                                  ///< Latency SLO of the daemon, 0 to admit every request.
+    bool slo_downgrade           = false;                               ///< If true, requests over the SLO are downgraded to the first cascade stage.
+    std::string canary_path;                                            ///< Path to the ONNX model file that receives a share of the images, empty to disable.
+    double canary_weight         = 0.0;                                 ///< The share of the images classified by the canary model.
+    bool watch_models            = false;                               ///< If true, the daemon reloads the models when the model or class files change.
+    stdin_format input_format    = stdin_format::lines;                 ///< The format of the piped standard input.
+    std::vector<std::string> tar_paths;                                 ///< Paths to tar archives whose image members are classified.
+    std::vector<std::string> records_paths;                             ///< Paths to record files whose images are classified.
+    std::vector<std::string> video_paths;                               ///< Paths to video files whose frames are classified.
+    unsigned int every_n_frames  = 1;                                   ///< Classify every Nth frame of a video or a multi-frame image.
+    bool all_frames              = false;                               ///< If true, every frame (or page) of a multi-frame image is classified.
+    double sample_fps            = 0.0;                                 ///< Classify this many frames per second of a video, 0 to use `every_n_frames`.
+    std::string tensor_cache_dir;                                       ///< The directory of the cache of preprocessed input tensors, empty to disable.
+    tensor_format tensor_cache_format = tensor_format::fp32;            ///< The element type of the cached tensors.
+    int64_t input_width          = 0;                                   ///< Inference width for models with dynamic spatial dimensions, 0 for the default.
+    int64_t input_height         = 0;                                   ///< Inference height for models with dynamic spatial dimensions, 0 for the default.
+    bool fold_preprocessing      = false;                               ///< If true, the preprocessing is folded into the model graph.
+    bool graph_top_k             = false;                               ///< If true, Softmax and TopK are appended to the model graph.
+    bool serve                   = false;                               ///< If true, the application runs as a daemon (`yolo-cls serve`).
+    bool pack                    = false;                               ///< If true, the application writes a record file (`yolo-cls pack`).
+    std::string output_path;                                            ///< Path to the record file written by `yolo-cls pack`.
+    std::string socket_path;                                            ///< Path to the Unix socket the daemon listens on.
+    std::string http_address;                                           ///< The `<host>:<port>` address of the HTTP endpoint of the daemon.
+    std::string connect_path;                                           ///< Path to the Unix socket of a running daemon to send the images to.
+    bool print_stats             = false;                               ///< If true, per-stage statistics are printed to standard error at exit.
+    std::string stats_json_path;                                        ///< Path to write the per-stage statistics as JSON to at exit, empty to disable.
+    std::string trace_path;                                             ///< Path to write the Chrome trace of the pipeline and the models to at exit, empty to disable.
     std::vector<std::string> image_files;                               ///< List of image files from command-line arguments.
 };
 
@@ -79,21 +197,27 @@ configuration parse_arguments(int argc, char **argv);
 
 /**
  * @brief The main worker thread function.
- *        Pops a file path from the input queue, performs classification,
- *        formats the result, and pushes it to the output queue.
- * @param tsq_in The thread-safe input queue for file paths.
+ *        Pops up to `configuration::batch_size` jobs from the input queue, performs classification,
+ *        formats the results, and pushes them to the output queue (or passes them to `job::reply`).
+ * @param tsq_in The thread-safe input queue for jobs.
  * @param tsq_out The thread-safe output queue for formatted results.
- * @param model The YOLO model instance to use for classification.
+ * @param router The classifiers of the model variants, every image is routed to one of them.
+ * @param dedup The cache of results for byte-identical images (used if `configuration::enable_dedup` is set).
+ * @param phash The index of results for near-duplicate images (used if `configuration::phash_distance` is not negative).
+ * @param tensors The cache of preprocessed input tensors (used if it is enabled).
+ * @param stats The queueing and inference statistics.
+ * @param pipeline The per-stage statistics (`--stats`), the thread attaches its own recorder.
  * @param[in] c The application configuration.
  */
-void thread_classify(tsqueue &tsq_in, tsqueue &tsq_out, yolo &model, configuration const &c);
+void thread_classify(tsqueue<job> &tsq_in, tsqueue<std::string> &tsq_out, model_router &router, dedup_cache &dedup, phash_index &phash, tensor_cache &tensors, serving_stats &stats, pipeline_stats &pipeline, configuration const &c);
 
 /**
  * @brief The output thread function.
  *        Pops formatted results from the output queue and prints them to standard output.
  * @param tsq The thread-safe output queue.
+ * @param pipeline The per-stage statistics (`--stats`), the thread attaches its own recorder.
  */
-void thread_print_tsq(tsqueue &tsq);
+void thread_print_tsq(tsqueue<std::string> &tsq, pipeline_stats &pipeline);
 
 /**
  * @brief The input thread function for piped data.
@@ -101,7 +225,62 @@ void thread_print_tsq(tsqueue &tsq);
  * @param tsq_in The thread-safe input queue to push file paths to.
  * @param[in] c The application configuration (used for extension checking).
  */
-void thread_get_line(tsqueue &tsq_in, configuration const &c);
+void thread_get_line(tsqueue<job> &tsq_in, configuration const &c);
+
+/**
+ * @brief The input thread function for piped encoded images (`--stdin-format frames`).
+ *        Reads length-prefixed records from standard input into pooled buffers and pushes them to the input queue.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param pool The buffers of the records, returned by the worker threads once the images are decoded.
+ * @param[in] c The application configuration (used for the maximum file size).
+ */
+void thread_get_frames(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c);
+
+/**
+ * @brief The input thread function for tar archives (`--tar` or `--stdin-format tar`).
+ *        Streams the image members of the archives into pooled buffers and pushes them to the input queue,
+ *        named `<archive>:<member>`. Up to `configuration::threads` archives are read in parallel.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param pool The buffers of the members, returned by the worker threads once the images are decoded.
+ * @param[in] c The application configuration. Without `configuration::tar_paths` the archive is read from standard input.
+ */
+void thread_get_tar(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c);
+
+/**
+ * @brief Pushes the job of an image path to the input queue.
+ *        With `configuration::all_frames` the frames of a multi-frame image, sampled by `configuration::every_n_frames`,
+ *        are split into jobs of up to `configuration::batch_size` frames, so that the frames are decoded lazily, a job at a time.
+ * @param tsq_in The thread-safe input queue to push the jobs to.
+ * @param[in] path The path to the image.
+ * @param[in] c The application configuration.
+ */
+void push_image_path(tsqueue<job> &tsq_in, std::string const &path, configuration const &c);
+
+/**
+ * @brief Parses a `<path> <x> <y> <width> <height>` line of a detector. The path may contain spaces.
+ * @param[in] line The line.
+ * @return The path and the box, or `std::nullopt` if the line is not a box.
+ */
+std::optional<std::pair<std::string, cv::Rect>> parse_box_line(std::string const &line);
+
+/**
+ * @brief The input thread function for the boxes of a detector (`--stdin-format boxes`).
+ *        Reads `<path> <x> <y> <width> <height>` lines from standard input and pushes a single job
+ *        with all boxes of consecutive lines of the same path, so the image is decoded only once.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param[in] c The application configuration (used for the extension check).
+ */
+void thread_get_boxes(tsqueue<job> &tsq_in, configuration const &c);
+
+/**
+ * @brief The input thread function for record files (`--records`).
+ *        Maps the record files and pushes their images to the input queue without a copy,
+ *        every job keeps its record file mapped until the image is decoded.
+ * @param tsq_in The thread-safe input queue to push the images to.
+ * @param pool Bounds the queued images, every job holds an empty buffer of the pool until the image is decoded.
+ * @param[in] c The application configuration (used for the maximum file size).
+ */
+void thread_get_records(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c);
 
 /**
  * @brief Prints help information that is invoked by `-h` or `--help`
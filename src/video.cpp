@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file video.cpp
+ * @brief Implements the input of video files (--video).
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include "video.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "config.h"
+
+/**
+ * @brief Formats the timestamp of a video frame as `HH:MM:SS.mmm`.
+ * @param[in] milliseconds The position of the frame in the video.
+ * @return The formatted timestamp.
+ */
+std::string format_timestamp(double milliseconds)
+{
+    auto const total = static_cast<unsigned long long>(std::llround(std::max(milliseconds, 0.0)));
+
+    char result[32];
+    std::snprintf(result, sizeof(result), "%02llu:%02llu:%02llu.%03llu", total / 3600000, total / 60000 % 60, total / 1000 % 60, total % 1000);
+
+    return result;
+}
+
+#ifdef YOLOCLS_HAS_VIDEOIO
+
+/**
+ * @brief Decodes the sampled frames of a video and pushes them to the input queue.
+ * @param tsq_in The thread-safe input queue to push the frames to.
+ * @param pool The buffers of the frames.
+ * @param[in] path The path to the video file.
+ * @param[in] c The application configuration.
+ */
+static void read_video(tsqueue<job> &tsq_in, buffer_pool &pool, std::string const &path, configuration const &c)
+{
+    cv::VideoCapture capture(path);
+
+    if(!capture.isOpened())
+    {
+        std::stringstream ss;
+        ss << "yolo-cls: could not open the video '" << path << "'." << std::endl;
+        std::cerr << ss.str();
+        return;
+    }
+
+    double const fps   = capture.get(cv::CAP_PROP_FPS);
+    int const width    = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH));
+    int const height   = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT));
+    size_t const bytes = static_cast<size_t>(std::max(width, 0)) * static_cast<size_t>(std::max(height, 0)) * 3;
+
+    // With --fps a frame is sampled once its timestamp reaches the next sampling point
+    double const interval = c.sample_fps > 0.0 ? 1000.0 / c.sample_fps : 0.0;
+    double next_sample    = 0.0;
+
+    for(uint64_t index = 0; capture.grab(); ++index)
+    {
+        // Not every backend reports the position, then it follows from the frame rate
+        double timestamp = capture.get(cv::CAP_PROP_POS_MSEC);
+        if(timestamp <= 0.0 && index != 0 && fps > 0.0)
+            timestamp = static_cast<double>(index) * 1000.0 / fps;
+
+        bool const sampled = interval > 0.0 ? timestamp + 0.5 >= next_sample : index % c.every_n_frames == 0;
+        if(!sampled)
+            continue;
+
+        if(interval > 0.0)
+            next_sample = (std::floor((timestamp + 0.5) / interval) + 1.0) * interval;
+
+        job request {path + "@" + format_timestamp(timestamp), ""};
+
+        // Decode straight into a pooled buffer, the decoder allocates its own memory if the frame has another size
+        request.data = pool.acquire();
+        request.pool = &pool;
+        request.data.resize(bytes);
+
+        cv::Mat frame = bytes != 0 ? cv::Mat(height, width, CV_8UC3, request.data.data()) : cv::Mat();
+
+        if(!capture.retrieve(frame) || frame.empty())
+        {
+            pool.release(std::move(request.data));
+
+            std::stringstream ss;
+            ss << "yolo-cls: could not decode the frame '" << request.name << "'." << std::endl;
+            std::cerr << ss.str();
+            continue;
+        }
+
+        request.image = frame;
+        tsq_in.push(std::move(request));
+    }
+}
+
+#endif
+
+/**
+ * @brief The input thread function for video files (`--video`).
+ *        Every video is decoded by its own thread (up to `configuration::threads` at the same time).
+ *        Frames are sampled by `configuration::every_n_frames` or `configuration::sample_fps`,
+ *        the skipped frames are only grabbed, not decoded. The sampled frames are decoded into pooled buffers
+ *        and pushed to the input queue as decoded images named `<video>@<HH:MM:SS.mmm>`.
+ * @param tsq_in The thread-safe input queue to push the frames to.
+ * @param pool The buffers of the frames, returned by the worker threads once the frames are classified.
+ * @param[in] c The application configuration.
+ */
+void thread_get_video(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c)
+{
+#ifdef YOLOCLS_HAS_VIDEOIO
+    std::atomic<size_t> next {0};
+
+    auto read_videos = [&]()
+    {
+        for(size_t i = next++; i < c.video_paths.size(); i = next++)
+            read_video(tsq_in, pool, c.video_paths[i], c);
+    };
+
+    // Every decoder takes the next video, this thread is one of them
+    size_t const decoders = std::min<size_t>(c.video_paths.size(), std::max(c.threads, 1u));
+
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < decoders; ++i)
+        threads.emplace_back(read_videos);
+
+    read_videos();
+
+    for(auto &t : threads)
+        t.join();
+#else
+    std::cerr << "yolo-cls: video input requires OpenCV with the videoio module." << std::endl;
+#endif
+
+    tsq_in.close();
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file video.h
+ * @brief Defines the input of video files (--video).
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include <string>
+
+#include "utils.h"
+
+/**
+ * @brief Formats the timestamp of a video frame as `HH:MM:SS.mmm`.
+ * @param[in] milliseconds The position of the frame in the video.
+ * @return The formatted timestamp.
+ */
+std::string format_timestamp(double milliseconds);
+
+/**
+ * @brief The input thread function for video files (`--video`).
+ *        Every video is decoded by its own thread (up to `configuration::threads` at the same time).
+ *        Frames are sampled by `configuration::every_n_frames` or `configuration::sample_fps`,
+ *        the skipped frames are only grabbed, not decoded. The sampled frames are decoded into pooled buffers
+ *        and pushed to the input queue as decoded images named `<video>@<HH:MM:SS.mmm>`.
+ * @param tsq_in The thread-safe input queue to push the frames to.
+ * @param pool The buffers of the frames, returned by the worker threads once the frames are classified.
+ * @param[in] c The application configuration.
+ */
+void thread_get_video(tsqueue<job> &tsq_in, buffer_pool &pool, configuration const &c);
+
+#endif // VIDEO_H
\ No newline at end of file
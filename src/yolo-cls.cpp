@@ -36,7 +36,138 @@
 */
 #include <unistd.h> // For unix pipe
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
 #include "utils.h"
+#include "server.h"
+#include "records.h"
+#include "video.h"
+
+/// The directory of the ONNX Runtime profiles that are merged into the trace (`--trace`), empty unless it has been created.
+static std::filesystem::path profile_directory;
+
+/**
+ * @brief Creates the directory of the ONNX Runtime profiles, readable only by the user, and stores it in `profile_directory`.
+ * @details `mkdtemp` picks a new name atomically, so an existing file or a link in the temporary directory is never reused.
+ * @throws std::system_error if the directory cannot be created.
+ */
+static void create_profile_directory()
+{
+    std::string path = (std::filesystem::temp_directory_path() / "yolo-cls-profiles-XXXXXX").string();
+
+    if(::mkdtemp(path.data()) == nullptr)
+        throw std::system_error(errno, std::generic_category(), "could not create the profile directory '" + path + "'");
+
+    profile_directory = path;
+}
+
+/**
+ * @brief Removes the directory of the ONNX Runtime profiles, if it has been created.
+ */
+static void remove_profile_directory()
+{
+    if(profile_directory.empty())
+        return;
+
+    std::error_code error;
+    std::filesystem::remove_all(profile_directory, error);
+    profile_directory.clear();
+}
+
+/**
+ * @brief Loads a model with the options from the application configuration.
+ *        The resolved input shape of models with dynamic dimensions is printed to standard error.
+ * @param[in] model_path Path to the ONNX model file.
+ * @param[in] classes_path Path to the text file containing class names.
+ * @param[in] use_softmax If true, the model applies softmax to the output scores.
+ * @param[in] config The application configuration.
+ * @return The initialized model.
+ */
+static yolo load_model(std::string const &model_path, std::string const &classes_path, bool use_softmax, configuration const &config)
+{
+    yolo_options options;
+    options.use_softmax        = use_softmax;
+    options.input_width        = config.input_width;
+    options.input_height       = config.input_height;
+    options.fold_preprocessing = config.fold_preprocessing;
+
+    // A cascade needs at least the top-1 result of every stage
+    if(config.graph_top_k)
+        options.graph_top_k = std::max(config.top_k, 1);
+
+    // The profiles are merged into the trace at exit
+    if(!config.trace_path.empty())
+    {
+        static int profiles = 0;
+        options.profile_prefix = (profile_directory / (std::to_string(profiles++) + "-" + std::filesystem::path(model_path).stem().string())).string();
+    }
+
+    yolo result(model_path, classes_path, options);
+
+    if(result.has_dynamic_input())
+    {
+        std::stringstream ss;
+        ss << "yolo-cls: model '" << model_path << "' input shape " << result.describe_input() << std::endl;
+        std::cerr << ss.str();
+    }
+
+    if(config.batch_size > 1 && !result.has_dynamic_batch())
+    {
+        std::stringstream ss;
+        ss << "yolo-cls: model '" << model_path << "' has a fixed batch dimension, batches are split into separate session runs" << std::endl;
+        std::cerr << ss.str();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Builds the classifier of a model variant from the application configuration.
+ * @param[in] config The application configuration.
+ * @param[in] variant 0 for the models of -m or --cascade, 1 for the canary model (which uses the first -c).
+ * @return The initialized classifier.
+ * @throws std::exception if a model cannot be loaded.
+ */
+static classifier load_classifier(configuration const &config, size_t variant)
+{
+    classifier model;
+
+    if(variant != 0)
+    {
+        model.add_head(std::filesystem::path(config.canary_path).stem().string(), load_model(config.canary_path, config.classes_paths.front(), config.use_softmax, config));
+    }
+    else if(config.cascade.empty())
+    {
+        if(config.model_paths.empty())
+            throw std::invalid_argument("No model file provided, use --help for usage.");
+
+        for(size_t i = 0; i < config.model_paths.size(); ++i)
+        {
+            auto const &model_path   = config.model_paths[i];
+            auto const &classes_path = config.classes_paths.size() == 1 ? config.classes_paths.front() : config.classes_paths[i];
+
+            model.add_head(std::filesystem::path(model_path).stem().string(), load_model(model_path, classes_path, config.use_softmax, config));
+        }
+    }
+    else
+    {
+        // The thresholds are probabilities, so every stage applies softmax
+        for(size_t i = 0; i < config.cascade.size(); ++i)
+        {
+            auto const &[model_path, threshold] = config.cascade[i];
+            auto const &classes_path            = config.classes_paths.size() == 1 ? config.classes_paths.front() : config.classes_paths[i];
+
+            model.add_stage(std::filesystem::path(model_path).filename().string(), load_model(model_path, classes_path, true, config), threshold);
+        }
+    }
+
+    return model;
+}
 
 int main(int argc, char **argv)
 {
@@ -57,13 +188,108 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+    // Write the images to a record file, no models are needed
+    if(config.pack)
+    {
+        try
+        {
+            return run_pack(config);
+        }
+        catch(std::exception const &e)
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: " << e.what() << std::endl;
+            std::cerr << ss.str();
+
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Send the images to a running daemon instead of loading the models
+    if(!config.connect_path.empty())
+    {
+        try
+        {
+            return run_client(config);
+        }
+        catch(std::exception const &e)
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: " << e.what() << std::endl;
+            std::cerr << ss.str();
+
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Results of byte-identical images
+    dedup_cache dedup;
+
+    // Results of near-duplicate images
+    phash_index phash;
+
+    // Queueing and inference latencies
+    serving_stats stats;
+
+    // The primary model and the canary model, if any
+    std::vector<double> weights = {1.0};
+    stats.models.emplace_back().name = "primary";
+
+    if(!config.canary_path.empty())
+    {
+        weights = {1.0 - config.canary_weight, config.canary_weight};
+        stats.models.emplace_back().name = "canary";
+    }
+
     // Create classifier
-    yolo classifier;
+    std::unique_ptr<model_router> router;
+
+    // The cache of preprocessed input tensors, disabled unless --tensor-cache is set
+    auto tensors = std::make_unique<tensor_cache>();
 
-    // Initialize classifier
+    // Initialize classifier, the cached results of the old models are dropped on every reload
     try
     {
-        classifier = yolo(config.model_path, config.classes_path, config.use_softmax);
+        if(!config.trace_path.empty())
+            create_profile_directory();
+
+        router = std::make_unique<model_router>(weights, [&config](size_t variant) { return load_classifier(config, variant); }, [&dedup, &phash]()
+        {
+            dedup.clear();
+            phash.clear();
+        });
+
+        if(config.watch_models)
+        {
+            std::vector<std::string> paths = config.model_paths;
+            for(auto const &stage : config.cascade)
+                paths.push_back(stage.first);
+            if(!config.canary_path.empty())
+                paths.push_back(config.canary_path);
+            for(auto const &classes_path : config.classes_paths)
+            {
+                if(!classes_path.empty())
+                    paths.push_back(classes_path);
+            }
+
+            router->watch(paths, std::chrono::seconds(1));
+        }
+
+        // A cached tensor is fed to every model, so they must share the input size
+        if(!config.tensor_cache_dir.empty())
+        {
+            cv::Size size;
+            for(auto const &model : router->models())
+            {
+                if(size.empty())
+                    size = model->input_size();
+
+                if(model->input_size().empty() || model->input_size() != size)
+                    throw std::invalid_argument("--tensor-cache requires all models to have the same input size.");
+            }
+
+            tensors = std::make_unique<tensor_cache>(config.tensor_cache_dir, size, config.tensor_cache_format);
+        }
     }
     catch(std::exception const &e)
     {
@@ -71,25 +297,86 @@ int main(int argc, char **argv)
         ss << "yolo-cls: " << e.what() << std::endl;
         std::cerr << ss.str();
 
+        remove_profile_directory();
+
         return EXIT_FAILURE;
     }
 
     // Thread safe queues for input/output
-    tsqueue tsq_in;
-    tsqueue tsq_out;
+    tsqueue<job> tsq_in(job_priority_levels);
+    tsqueue<std::string> tsq_out;
+
+    // Per-stage statistics, every pipeline thread records into its own histograms
+    pipeline_stats pipeline(config.print_stats || !config.stats_json_path.empty() || !config.trace_path.empty(), !config.trace_path.empty());
 
     // Run piped output in a single separate thread
-    std::thread output_thread(thread_print_tsq, std::ref(tsq_out));
+    std::thread output_thread(thread_print_tsq, std::ref(tsq_out), std::ref(pipeline));
 
     // Create worker threads for classification
     std::vector<std::thread> worker_threads;
     for(int i = 0; i < config.threads; ++i)
     {
-        worker_threads.emplace_back(thread_classify, std::ref(tsq_in), std::ref(tsq_out), std::ref(classifier), std::ref(config));
+        worker_threads.emplace_back(thread_classify, std::ref(tsq_in), std::ref(tsq_out), std::ref(*router), std::ref(dedup), std::ref(phash), std::ref(*tensors), std::ref(stats), std::ref(pipeline), std::ref(config));
     }
 
+    int status = EXIT_SUCCESS;
+
+    if(config.serve)
+    {
+        // Classify the images sent to the sockets until the daemon is stopped
+        try
+        {
+            admission_control admission(tsq_in, stats, router->models().front()->is_cascade(), config);
+            serve(admission, *router, stats, config);
+        }
+        catch(std::exception const &e)
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: " << e.what() << std::endl;
+            std::cerr << ss.str();
+
+            status = EXIT_FAILURE;
+        }
+
+        tsq_in.close();
+    }
+    else if(!config.records_paths.empty())
+    {
+        // The images are decoded straight from the mapped record files, the pool bounds the queued images
+        buffer_pool pool(static_cast<size_t>(config.threads) * config.batch_size * 2);
+        std::thread input_thread(thread_get_records, std::ref(tsq_in), std::ref(pool), std::ref(config));
+
+        // The buffers are returned by the worker threads, so the pool must outlive them
+        input_thread.join();
+
+        for(std::thread &t : worker_threads)
+            t.join();
+
+        worker_threads.clear();
+    }
+    else if(config.input_format == stdin_format::boxes && !isatty(STDIN_FILENO))
+    {
+        // The boxes of a detector, every image is decoded once for all of its boxes
+        std::thread input_thread(thread_get_boxes, std::ref(tsq_in), std::ref(config));
+        input_thread.join();
+    }
+    else if(!config.video_paths.empty() || !config.tar_paths.empty() || (config.input_format != stdin_format::lines && !isatty(STDIN_FILENO)))
+    {
+        // Video frames, or encoded images from a pipe or from archives, enough buffers to keep every worker thread busy
+        buffer_pool pool(static_cast<size_t>(config.threads) * config.batch_size * 2);
+        auto const reader = !config.video_paths.empty() ? thread_get_video : config.input_format == stdin_format::frames ? thread_get_frames : thread_get_tar;
+        std::thread input_thread(reader, std::ref(tsq_in), std::ref(pool), std::ref(config));
+
+        // The buffers are returned by the worker threads, so the pool must outlive them
+        input_thread.join();
+
+        for(std::thread &t : worker_threads)
+            t.join();
+
+        worker_threads.clear();
+    }
     // Check whether the executable is invoked by a unix pipe or not
-    if(isatty(STDIN_FILENO))
+    else if(isatty(STDIN_FILENO))
     {
         if(config.image_files.empty())
         {
@@ -98,7 +385,7 @@ int main(int argc, char **argv)
 
         // Add images to the thread safe input queue
         for(auto const &i : config.image_files)
-            tsq_in.push(i);
+            push_image_path(tsq_in, i, config);
 
         // Close the queue because there won't be any input
         tsq_in.close();
@@ -124,5 +411,71 @@ int main(int argc, char **argv)
     // Wait for the output thread to finish printing
     output_thread.join();
 
-    return EXIT_SUCCESS;
+    // Print the share of images handled by every cascade stage (since the last reload)
+    auto const model = router->models().front();
+    if(model->is_cascade())
+    {
+        std::stringstream ss(model->report());
+        std::string line;
+        while(std::getline(ss, line))
+            std::cerr << "yolo-cls: " << line << std::endl;
+    }
+
+    // Print the number of images read from the tensor cache
+    if(tensors->enabled())
+        std::cerr << "yolo-cls: " << tensors->report() << std::endl;
+
+    // Print the queueing and inference latencies of the daemon
+    if(config.serve)
+        std::cerr << "yolo-cls: " << stats.report() << std::endl;
+
+    // Print the merged per-stage statistics
+    if(config.print_stats)
+    {
+        std::stringstream ss(pipeline.report());
+        std::string line;
+        while(std::getline(ss, line))
+            std::cerr << "yolo-cls: " << line << std::endl;
+    }
+
+    if(!config.stats_json_path.empty())
+    {
+        std::ofstream file(config.stats_json_path);
+        file << pipeline.json() << std::endl;
+
+        if(!file)
+        {
+            std::cerr << "yolo-cls: could not write the statistics to '" << config.stats_json_path << "'" << std::endl;
+            status = EXIT_FAILURE;
+        }
+    }
+
+    // Write the spans of the pipeline threads together with the ONNX Runtime profiles of the models.
+    // Only the models loaded at exit are profiled: models are reloaded only by serve, which does not accept --trace.
+    if(!config.trace_path.empty())
+    {
+        try
+        {
+            std::vector<session_profile> profiles;
+            for(auto const &m : router->models())
+            {
+                auto p = m->end_profiling();
+                profiles.insert(profiles.end(), p.begin(), p.end());
+            }
+
+            pipeline.write_trace(config.trace_path, profiles);
+        }
+        catch(std::exception const &e)
+        {
+            std::stringstream ss;
+            ss << "yolo-cls: " << e.what() << std::endl;
+            std::cerr << ss.str();
+
+            status = EXIT_FAILURE;
+        }
+
+        remove_profile_directory();
+    }
+
+    return status;
 }
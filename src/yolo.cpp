@@ -28,7 +28,9 @@
  * @copyright SPDX-License-Identifier: GPL-3.0-or-later
 */
 #include "yolo.h"
+#include "stage_stats.h"
 
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 #include <string>
@@ -55,6 +57,11 @@ yolo::yolo(yolo &&other) noexcept
       allocator(std::move(other.allocator)),
       input_width(other.input_width),
       input_height(other.input_height),
+      batch_size(other.batch_size),
+      dynamic_size(other.dynamic_size),
+      fold_preprocessing(other.fold_preprocessing),
+      graph_top_k(other.graph_top_k),
+      profiling(other.profiling),
       input_node_names(std::move(other.input_node_names)),
       output_node_names(std::move(other.output_node_names)),
       input_names(std::move(other.input_names)),
@@ -65,11 +72,16 @@ yolo::yolo(yolo &&other) noexcept
       use_softmax(other.use_softmax)
 {
     // The `other` object is now in a moved-from state (the same as a default-constructed object)
-    other.input_width      = 0;
-    other.input_height     = 0;
-    other.input_nodes_num  = 0;
-    other.output_nodes_num = 0;
-    other.use_softmax      = false;
+    other.input_width        = 0;
+    other.input_height       = 0;
+    other.batch_size         = 1;
+    other.dynamic_size       = false;
+    other.fold_preprocessing = false;
+    other.graph_top_k        = 0;
+    other.profiling          = false;
+    other.input_nodes_num    = 0;
+    other.output_nodes_num   = 0;
+    other.use_softmax        = false;
 }
 
 /**
@@ -81,26 +93,36 @@ yolo &yolo::operator=(yolo &&other) noexcept
 {
     if(this != &other)
     {
-        env               = std::move(other.env);
-        session           = std::move(other.session);
-        allocator         = std::move(other.allocator);
-        input_width       = other.input_width;
-        input_height      = other.input_height;
-        input_node_names  = std::move(other.input_node_names);
-        output_node_names = std::move(other.output_node_names);
-        input_names       = std::move(other.input_names);
-        output_names      = std::move(other.output_names);
-        class_names       = std::move(other.class_names);
-        input_nodes_num   = other.input_nodes_num;
-        output_nodes_num  = other.output_nodes_num;
-        use_softmax       = other.use_softmax;
+        env                = std::move(other.env);
+        session            = std::move(other.session);
+        allocator          = std::move(other.allocator);
+        input_width        = other.input_width;
+        input_height       = other.input_height;
+        batch_size         = other.batch_size;
+        dynamic_size       = other.dynamic_size;
+        fold_preprocessing = other.fold_preprocessing;
+        graph_top_k        = other.graph_top_k;
+        profiling          = other.profiling;
+        input_node_names   = std::move(other.input_node_names);
+        output_node_names  = std::move(other.output_node_names);
+        input_names        = std::move(other.input_names);
+        output_names       = std::move(other.output_names);
+        class_names        = std::move(other.class_names);
+        input_nodes_num    = other.input_nodes_num;
+        output_nodes_num   = other.output_nodes_num;
+        use_softmax        = other.use_softmax;
 
         // Reset the `other` object
-        other.input_width      = 0;
-        other.input_height     = 0;
-        other.input_nodes_num  = 0;
-        other.output_nodes_num = 0;
-        other.use_softmax      = false;
+        other.input_width        = 0;
+        other.input_height       = 0;
+        other.batch_size         = 1;
+        other.dynamic_size       = false;
+        other.fold_preprocessing = false;
+        other.graph_top_k        = 0;
+        other.profiling          = false;
+        other.input_nodes_num    = 0;
+        other.output_nodes_num   = 0;
+        other.use_softmax        = false;
     }
     return *this;
 }
@@ -113,9 +135,8 @@ yolo &yolo::operator=(yolo &&other) noexcept
  * @throws std::invalid_argument if the model or class file cannot be loaded or is invalid.
  * @throws std::filesystem::filesystem_error if the class names file cannot be opened.
  */
-yolo::yolo(std::string const &model_path, std::string const &cls_path, bool const &use_softmax) : yolo(model_path, cls_path)
+yolo::yolo(std::string const &model_path, std::string const &cls_path, bool const &use_softmax) : yolo(model_path, cls_path, yolo_options {use_softmax})
 {
-    this->use_softmax = use_softmax;
 }
 
 /**
@@ -125,7 +146,24 @@ yolo::yolo(std::string const &model_path, std::string const &cls_path, bool cons
  * @throws std::invalid_argument if the model or class file cannot be loaded or is invalid.
  * @throws std::filesystem::filesystem_error if the model or class names file cannot be opened, read, or does not exist.
  */
-yolo::yolo(std::string const &model_path, std::string const &cls_path) : env(ORT_LOGGING_LEVEL_WARNING, "yolo-cls")
+yolo::yolo(std::string const &model_path, std::string const &cls_path) : yolo(model_path, cls_path, yolo_options {})
+{
+}
+
+/**
+ * @brief Constructs and initializes a yolo object with the given options.
+ * @details Symbolic (dynamic) dimensions of the model input are resolved here.
+ *          A dynamic batch dimension enables batched execution in `predict_batch`.
+ *          Every dynamic spatial dimension uses `yolo_options::input_width` or `yolo_options::input_height`,
+ *          or the other, fixed dimension or `default_input_size` if they are not set. A fixed dimension is kept.
+ * @param[in] model_path Path to the ONNX model file.
+ * @param[in] cls_path Path to the text file containing class names (one per line).
+ * @param[in] options The model options.
+ * @throws std::invalid_argument if the model or class file cannot be loaded or is invalid,
+ *         or if the requested input size does not match a fixed dimension of the model input.
+ * @throws std::filesystem::filesystem_error if the class names file cannot be opened.
+ */
+yolo::yolo(std::string const &model_path, std::string const &cls_path, yolo_options const &options) : env(ORT_LOGGING_LEVEL_WARNING, "yolo-cls"), use_softmax(options.use_softmax)
 {
     // Read the model file into a memory buffer
     std::ifstream model_stream(model_path, std::ios::binary | std::ios::ate);
@@ -152,6 +190,13 @@ yolo::yolo(std::string const &model_path, std::string const &cls_path) : env(ORT
 
     session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
 
+    // The profile is written by `end_profiling`, or when the session is destroyed
+    if(!options.profile_prefix.empty())
+    {
+        session_options.EnableProfiling(options.profile_prefix.c_str());
+        profiling = true;
+    }
+
     session = Ort::Session(env, model_buffer.data(), model_buffer.size(), session_options);
 
     input_nodes_num  = session.GetInputCount();
@@ -164,18 +209,46 @@ yolo::yolo(std::string const &model_path, std::string const &cls_path) : env(ORT
         throw std::invalid_argument("Model file '" + model_path + "' has no output nodes.");
 
     // Get input/output node details
-    input_node_names.push_back(session.GetInputNameAllocated(0, allocator));
-    output_node_names.push_back(session.GetOutputNameAllocated(0, allocator));
-
-    input_names.push_back(input_node_names.back().get());
-    output_names.push_back(output_node_names.back().get());
+    read_node_names();
 
     Ort::TypeInfo input_type_info = session.GetInputTypeInfo(0);
     auto tensor_info              = input_type_info.GetTensorTypeAndShapeInfo();
     auto input_dims               = tensor_info.GetShape(); // Shape is [batch, channels, height, width]
 
-    input_height = input_dims[2];
-    input_width  = input_dims[3];
+    if(input_dims.size() != 4)
+        throw std::invalid_argument("Model file '" + model_path + "' input is not a 4D tensor [batch, channels, height, width].");
+
+    // Symbolic dimensions are reported as -1
+    batch_size = input_dims[0] > 0 ? input_dims[0] : 0;
+
+    // Every spatial dimension is resolved on its own, a fixed dimension is kept even if the other one is symbolic
+    int64_t const fixed_height = input_dims[2] > 0 ? input_dims[2] : 0;
+    int64_t const fixed_width  = input_dims[3] > 0 ? input_dims[3] : 0;
+
+    bool const size_requested = options.input_width > 0 || options.input_height > 0;
+    if(size_requested && ((fixed_width > 0 && options.input_width != fixed_width) || (fixed_height > 0 && options.input_height != fixed_height)))
+    {
+        std::string const fixed = fixed_width > 0 && fixed_height > 0 ? "size of " + std::to_string(fixed_width) + "x" + std::to_string(fixed_height)
+                                  : fixed_width > 0                   ? "width of " + std::to_string(fixed_width)
+                                                                      : "height of " + std::to_string(fixed_height);
+
+        throw std::invalid_argument("Model file '" + model_path + "' has a fixed input " + fixed + ", export the model with dynamic axes to change it.");
+    }
+
+    // A symbolic width defaults to the fixed height, so the input stays square, and a symbolic height to the width
+    dynamic_size = fixed_width == 0 || fixed_height == 0;
+    input_width  = fixed_width > 0 ? fixed_width : options.input_width > 0 ? options.input_width : fixed_height > 0 ? fixed_height : default_input_size;
+    input_height = fixed_height > 0 ? fixed_height : options.input_height > 0 ? options.input_height : input_width;
+
+    // Rewrite the graph, so that the session accepts raw uint8 NHWC BGR images and/or returns only the top K results
+    if(options.fold_preprocessing || options.graph_top_k > 0)
+    {
+        fold_preprocessing = options.fold_preprocessing;
+        graph_top_k        = options.graph_top_k;
+        session            = create_rewritten_session(model_buffer, session_options);
+
+        read_node_names();
+    }
 
     // Load class names from file
     auto const &path = cls_path;
@@ -262,27 +335,56 @@ void yolo::preprocess(const cv::Mat &image, std::vector<float> &output_tensor)
 }
 */
 
-void yolo::preprocess(cv::Mat const &image, std::vector<float> &output_tensor) const
+/**
+ * @brief Prepares an image for inference.
+ *        This involves resizing (unless the image already has the size), color space conversion (BGR to RGB),
+ *        normalization (to [0, 1]), and layout conversion to NCHW format.
+ * @param[in] image The input BGR image.
+ * @param[in] size The input size of the model.
+ * @param[out] output_tensor Pointer to `3 * size.height * size.width` floats to be filled with the preprocessed image data.
+ */
+void preprocess_image(cv::Mat const &image, cv::Size size, float *output_tensor)
 {
     cv::Mat resized_image;
 
-    cv::resize(image, resized_image, cv::Size(input_width, input_height));
-
-    // Convert BGR to RGB
-    cv::cvtColor(resized_image, resized_image, cv::COLOR_BGR2RGB);
-
-    resized_image = cv::dnn::blobFromImage(resized_image, 1.0, cv::Size(), cv::Scalar(), false, false, CV_32F);
+    // Skip resizing if the image has been resized by the caller
+    if(image.size() == size)
+        resized_image = image;
+    else
+        cv::resize(image, resized_image, size);
 
     // Convert image from uint8 [0, 255] to float [0, 1]
-    resized_image.convertTo(resized_image, CV_32F, 1.0 / 255.0);
-
-    // Reshape to a single row
-    resized_image = resized_image.reshape(1, 1);
+    cv::Mat float_image;
+    resized_image.convertTo(float_image, CV_32F, 1.0 / 255.0);
+
+    // Reshape from HWC to CHW, splitting the channels straight into the planes of the output tensor
+    // The planes are in reverse order, which converts BGR to RGB
+    size_t const plane          = static_cast<size_t>(size.area());
+    std::vector<cv::Mat> planes = {
+        cv::Mat(size, CV_32F, output_tensor + 2 * plane),
+        cv::Mat(size, CV_32F, output_tensor + 1 * plane),
+        cv::Mat(size, CV_32F, output_tensor + 0 * plane),
+    };
+    cv::split(float_image, planes);
+}
 
-    output_tensor.assign((float *)resized_image.ptr(0), (float *)resized_image.ptr(0) + resized_image.total() * resized_image.channels());
+/**
+ * @brief Prepares an image for inference.
+ *        This involves resizing, color space conversion (BGR to RGB),
+ *        normalization (to [0, 1]), and layout conversion to NCHW format.
+ * @param[in] image The input image.
+ * @param[out] output_tensor Pointer to `3 * input_height * input_width` floats to be filled with the preprocessed image data.
+ */
+void yolo::preprocess(cv::Mat const &image, float *output_tensor) const
+{
+    preprocess_image(image, input_size(), output_tensor);
 }
 
-void yolo::softmax(std::vector<float> &scores) const
+/**
+ * @brief Applies the softmax function to a vector of raw scores (logits) to convert them into probabilities.
+ * @param[in,out] scores A vector of scores to be modified in-place.
+ */
+void softmax_scores(std::vector<float> &scores)
 {
     if(scores.empty())
         return;
@@ -305,6 +407,30 @@ void yolo::softmax(std::vector<float> &scores) const
     }
 }
 
+/**
+ * @brief Selects the K highest scores.
+ * @param[in] scores The scores of all classes.
+ * @param[in] top_k The number of scores to select.
+ * @return Pairs of the class index and the score, sorted by score in descending order.
+ */
+std::vector<std::pair<int, float>> top_k_scores(std::vector<float> const &scores, size_t top_k)
+{
+    // Create a vector of pairs (index, score) to keep track of original indices
+    std::vector<std::pair<int, float>> indexed_scores;
+    indexed_scores.reserve(scores.size());
+    for(int i = 0; i < static_cast<int>(scores.size()); ++i)
+    {
+        indexed_scores.emplace_back(i, scores[i]);
+    }
+
+    // Sort the top K pairs in descending order based on the score
+    size_t count = std::min(top_k, indexed_scores.size());
+    std::partial_sort(indexed_scores.begin(), indexed_scores.begin() + count, indexed_scores.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+    indexed_scores.resize(count);
+
+    return indexed_scores;
+}
+
 /**
  * @brief Performs classification on a given image.
  * @param[in] image The input image as a `cv::Mat` object.
@@ -313,58 +439,534 @@ void yolo::softmax(std::vector<float> &scores) const
  * @throws std::runtime_error if the model is not initialized (e.g., default-constructed).
  */
 std::vector<prediction> yolo::predict(cv::Mat const &image, size_t const &top_k)
+{
+    return predict_batch({image}, top_k).front();
+}
+
+/**
+ * @brief Performs classification on several images.
+ * @details Models with a dynamic batch dimension classify all images in a single session run.
+ *          Models with a fixed batch dimension run once per batch (the last batch is padded).
+ * @param[in] images The input images as `cv::Mat` objects.
+ * @param[in] top_k The number of top predictions to return per image.
+ * @return One vector of `prediction` structs per image, sorted by confidence in descending order.
+ * @throws std::runtime_error if the model is not initialized (e.g., default-constructed).
+ */
+std::vector<std::vector<prediction>> yolo::predict_batch(std::vector<cv::Mat> const &images, size_t const &top_k)
 {
     // Check if the model is initialized
     if(session == nullptr)
         throw std::runtime_error("The model is not initialized.");
 
-    // Pre-process the image
+    std::vector<std::vector<prediction>> result;
+    result.reserve(images.size());
+
+    size_t const image_size = static_cast<size_t>(3 * input_height * input_width);
+    size_t const chunk_size = batch_size > 0 ? static_cast<size_t>(batch_size) : std::max<size_t>(images.size(), 1);
+
     std::vector<float> input_tensor_values;
-    preprocess(image, input_tensor_values);
+    std::vector<uint8_t> input_bytes;
+
+    for(size_t first = 0; first < images.size(); first += chunk_size)
+    {
+        size_t const count     = std::min(chunk_size, images.size() - first);
+        int64_t const run_size = batch_size > 0 ? batch_size : static_cast<int64_t>(count);
+
+        auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        Ort::Value input_tensor {nullptr};
+
+        // Keeps the resized image alive while the input tensor aliases it
+        cv::Mat resized_image;
+
+        {
+            stage_scope scope(pipeline_stage::preprocess);
+
+            if(fold_preprocessing)
+            {
+                for(size_t i = 0; i < count; ++i)
+                {
+                    if(is_input_tensor(images[first + i]))
+                        throw std::runtime_error("A preprocessed input tensor cannot be fed to a model with folded preprocessing.");
+                }
+
+                // The graph converts the raw images itself, only resizing is done here
+                std::vector<int64_t> input_shape = {run_size, input_height, input_width, 3};
+
+                // A single image is resized here and fed without a copy if possible, a batch is resized into the input in the loop below
+                if(count == 1)
+                {
+                    resized_image = images[first];
+                    if(resized_image.size() != input_size())
+                        cv::resize(images[first], resized_image, input_size());
+                }
+
+                if(count == 1 && run_size == 1 && resized_image.isContinuous() && resized_image.type() == CV_8UC3)
+                {
+                    // Feed the decoded (or resized) image without a copy
+                    input_tensor = Ort::Value::CreateTensor<uint8_t>(memory_info, resized_image.ptr<uint8_t>(), image_size, input_shape.data(), input_shape.size());
+                }
+                else
+                {
+                    input_bytes.assign(static_cast<size_t>(run_size) * image_size, 0);
+                    for(size_t i = 0; i < count; ++i)
+                    {
+                        cv::Mat destination(input_size(), CV_8UC3, input_bytes.data() + i * image_size);
+                        cv::Mat const &source = (count == 1) ? resized_image : images[first + i];
+
+                        if(source.size() == input_size())
+                            source.copyTo(destination);
+                        else
+                            cv::resize(source, destination, input_size());
+                    }
+
+                    input_tensor = Ort::Value::CreateTensor<uint8_t>(memory_info, input_bytes.data(), input_bytes.size(), input_shape.data(), input_shape.size());
+                }
+            }
+            else if(count == 1 && run_size == 1 && is_input_tensor(images[first]))
+            {
+                // Feed the preprocessed tensor without a copy
+                std::vector<int64_t> input_shape = {1, 3, input_height, input_width};
+                input_tensor                     = Ort::Value::CreateTensor<float>(memory_info, const_cast<float *>(images[first].ptr<float>()), image_size, input_shape.data(), input_shape.size());
+            }
+            else
+            {
+                // Pre-process the images, the padding of a fixed-size batch stays zero
+                input_tensor_values.assign(static_cast<size_t>(run_size) * image_size, 0.0f);
+                for(size_t i = 0; i < count; ++i)
+                {
+                    float *destination = input_tensor_values.data() + i * image_size;
+
+                    if(is_input_tensor(images[first + i]))
+                        std::copy_n(images[first + i].ptr<float>(), image_size, destination);
+                    else
+                        preprocess(images[first + i], destination);
+                }
+
+                // Create input tensor object
+                std::vector<int64_t> input_shape = {run_size, 3, input_height, input_width};
+                input_tensor                     = Ort::Value::CreateTensor<float>(memory_info, input_tensor_values.data(), input_tensor_values.size(), input_shape.data(), input_shape.size());
+            }
+        }
 
-    // Create input tensor object
-    std::vector<int64_t> input_shape = {1, 3, input_height, input_width};
-    auto memory_info                 = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-    Ort::Value input_tensor          = Ort::Value::CreateTensor<float>(memory_info, input_tensor_values.data(), input_tensor_values.size(), input_shape.data(), input_shape.size());
+        // Run inference
+        std::vector<Ort::Value> output_tensors;
+        {
+            stage_scope scope(pipeline_stage::run);
+            output_tensors = session.Run(Ort::RunOptions {nullptr}, input_names.data(), &input_tensor, 1, output_names.data(), output_names.size());
+        }
 
-    // Run inference
-    std::vector<Ort::Value> output_tensors = session.Run(Ort::RunOptions {nullptr}, input_names.data(), &input_tensor, input_nodes_num, output_names.data(), output_nodes_num);
+        stage_scope scope(pipeline_stage::postprocess);
+
+        // Post-process the output
+        if(graph_top_k > 0)
+        {
+            // The graph returns the sorted top K values and their class indices
+            float const *values    = output_tensors[0].GetTensorData<float>();
+            int64_t const *indices = output_tensors[1].GetTensorData<int64_t>();
+            auto output_shape      = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
+            size_t const k         = output_shape[1];
+
+            for(size_t i = 0; i < count; ++i)
+                result.push_back(postprocess_top_k(values + i * k, indices + i * k, k, top_k));
+
+            continue;
+        }
 
-    // Post-process the output
-    float *raw_output  = output_tensors[0].GetTensorMutableData<float>();
-    auto output_shape  = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
-    size_t output_size = output_shape[1]; // Number of classes
+        float *raw_output  = output_tensors[0].GetTensorMutableData<float>();
+        auto output_shape  = output_tensors[0].GetTensorTypeAndShapeInfo().GetShape();
+        size_t output_size = output_shape[1]; // Number of classes
 
+        for(size_t i = 0; i < count; ++i)
+            result.push_back(postprocess(raw_output + i * output_size, output_size, top_k));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Converts the raw scores of a single image into the top K predictions.
+ * @param[in] raw_output Pointer to the raw scores of the image.
+ * @param[in] output_size The number of scores (classes).
+ * @param[in] top_k The number of top predictions to return.
+ * @return A vector of `prediction` structs, sorted by confidence in descending order.
+ */
+std::vector<prediction> yolo::postprocess(float const *raw_output, size_t output_size, size_t top_k) const
+{
     std::vector<float> scores(raw_output, raw_output + output_size);
 
     // Apply softmax to get probabilities
     if(use_softmax)
-        softmax(scores);
+        softmax_scores(scores);
 
-    // Create a vector of pairs (index, score) to keep track of original indices
-    std::vector<std::pair<int, float>> indexed_scores;
-    indexed_scores.reserve(scores.size());
-    for(int i = 0; i < scores.size(); ++i)
+    // Get the top K results
+    std::vector<prediction> top_predictions;
+    for(auto const &[class_index, confidence] : top_k_scores(scores, top_k))
     {
-        indexed_scores.emplace_back(i, scores[i]);
+        if(static_cast<size_t>(class_index) < class_names.size())
+            top_predictions.push_back({class_names[class_index], confidence});
+        else
+            top_predictions.push_back({"class_" + std::to_string(class_index), confidence});
     }
 
-    // Sort the vector of pairs in descending order based on the score
-    std::sort(indexed_scores.begin(), indexed_scores.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+    return top_predictions;
+}
 
-    // Get the top K results
+/**
+ * @brief Converts the top K results returned by the graph into predictions.
+ * @param[in] values Pointer to the sorted top K values of the image.
+ * @param[in] indices Pointer to the class indices of the values.
+ * @param[in] k The number of values returned by the graph.
+ * @param[in] top_k The number of top predictions to return.
+ * @return A vector of `prediction` structs, sorted by confidence in descending order.
+ */
+std::vector<prediction> yolo::postprocess_top_k(float const *values, int64_t const *indices, size_t k, size_t top_k) const
+{
     std::vector<prediction> top_predictions;
-    size_t count = std::min(top_k, indexed_scores.size());
+
+    size_t count = std::min(top_k, k);
     for(size_t i = 0; i < count; ++i)
     {
-        int class_index  = indexed_scores[i].first;
-        float confidence = indexed_scores[i].second;
+        int64_t class_index = indices[i];
 
-        if(class_index <= class_names.size())
-            top_predictions.push_back({class_names[class_index], confidence});
+        if(class_index >= 0 && static_cast<size_t>(class_index) < class_names.size())
+            top_predictions.push_back({class_names[class_index], values[i]});
         else
-            top_predictions.push_back({"class_" + std::to_string(class_index), confidence});
+            top_predictions.push_back({"class_" + std::to_string(class_index), values[i]});
     }
 
     return top_predictions;
 }
+
+/**
+ * @brief Checks whether an image is a preprocessed input tensor of this model.
+ * @details A preprocessed input tensor is a continuous `CV_32FC1` matrix with 3 rows, the RGB planes,
+ *          of `input_size().area()` columns, as written by `preprocess_image`.
+ * @param[in] image The image.
+ * @return True if the image is a preprocessed input tensor.
+ */
+bool yolo::is_input_tensor(cv::Mat const &image) const
+{
+    return image.type() == CV_32FC1 && image.rows == 3 && image.cols == input_size().area() && image.isContinuous();
+}
+
+/**
+ * @brief Ends the ONNX Runtime profiling and writes the profile (see `yolo_options::profile_prefix`).
+ * @return The path of the profile in the Chrome trace event format, or an empty string if profiling is not enabled.
+ */
+std::string yolo::end_profiling()
+{
+    if(!profiling || session == nullptr)
+        return "";
+
+    profiling = false;
+
+    return session.EndProfilingAllocated(allocator).get();
+}
+
+/**
+ * @brief Returns the start of the ONNX Runtime profiling.
+ * @return Nanoseconds since the epoch of `std::chrono::high_resolution_clock`, 0 if profiling is not enabled.
+ */
+uint64_t yolo::profiling_start_ns() const
+{
+    if(!profiling || session == nullptr)
+        return 0;
+
+    return session.GetProfilingStartTimeNs();
+}
+
+/**
+ * @brief Describes the resolved model input shape (e.g., `[dynamic, 3, 320, 320]`).
+ * @return The description of the input shape.
+ */
+std::string yolo::describe_input() const
+{
+    std::string result = "[";
+    result += batch_size > 0 ? std::to_string(batch_size) : "dynamic";
+    result += ", 3, " + std::to_string(input_height) + ", " + std::to_string(input_width) + "]";
+
+    if(dynamic_size)
+        result += " (dynamic spatial dimensions)";
+
+    return result;
+}
+
+/**
+ * @brief Checks whether the model input has a dynamic batch dimension.
+ * @return True if any number of images can be classified in a single session run.
+ */
+bool yolo::has_dynamic_batch() const
+{
+    return batch_size == 0;
+}
+
+/**
+ * @brief Checks whether any dimension of the model input is dynamic.
+ * @return True if the batch or the spatial dimensions are dynamic.
+ */
+bool yolo::has_dynamic_input() const
+{
+    return has_dynamic_batch() || dynamic_size;
+}
+
+/**
+ * @brief Returns the spatial input size of the model.
+ * @details Images that already have this size are not resized again by `predict`.
+ * @return The input width and height.
+ */
+cv::Size yolo::input_size() const
+{
+    return cv::Size(static_cast<int>(input_width), static_cast<int>(input_height));
+}
+
+/**
+ * @brief Reads the input and output node names of the current session.
+ */
+void yolo::read_node_names()
+{
+    input_node_names.clear();
+    output_node_names.clear();
+    input_names.clear();
+    output_names.clear();
+
+    input_node_names.push_back(session.GetInputNameAllocated(0, allocator));
+    input_names.push_back(input_node_names.back().get());
+
+    for(size_t i = 0; i < session.GetOutputCount(); ++i)
+    {
+        output_node_names.push_back(session.GetOutputNameAllocated(i, allocator));
+        output_names.push_back(output_node_names.back().get());
+    }
+}
+
+/**
+ * @brief Reads the default ONNX opset version from a serialized `ModelProto`.
+ * @details Only the top-level fields are scanned, the graph itself is skipped.
+ * @param[in] data The serialized model.
+ * @param[in] size The size of the serialized model in bytes.
+ * @return The opset version of the default domain, or 0 if it cannot be found.
+ */
+static int64_t read_model_opset(char const *data, size_t size)
+{
+    auto const *p   = reinterpret_cast<uint8_t const *>(data);
+    auto const *end = p + size;
+
+    auto read_varint = [](uint8_t const *&it, uint8_t const *last) -> uint64_t
+    {
+        uint64_t value = 0;
+        for(int shift = 0; it < last && shift < 64; shift += 7)
+        {
+            uint8_t byte = *it++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0)
+                break;
+        }
+        return value;
+    };
+
+    int64_t opset = 0;
+
+    while(p < end)
+    {
+        uint64_t const tag  = read_varint(p, end);
+        uint64_t const wire = tag & 0x07;
+
+        if(wire == 0)
+        {
+            read_varint(p, end);
+        }
+        else if(wire == 1 || wire == 5)
+        {
+            p += wire == 1 ? 8 : 4;
+        }
+        else if(wire == 2)
+        {
+            uint64_t const length = read_varint(p, end);
+            if(length > static_cast<uint64_t>(end - p))
+                break;
+
+            // ModelProto.opset_import (OperatorSetIdProto)
+            if((tag >> 3) == 8)
+            {
+                auto const *it   = p;
+                auto const *last = p + length;
+
+                std::string domain;
+                int64_t version = 0;
+
+                while(it < last)
+                {
+                    uint64_t const field = read_varint(it, last);
+
+                    if(field == ((1 << 3) | 2)) // domain
+                    {
+                        uint64_t const n = read_varint(it, last);
+                        if(n > static_cast<uint64_t>(last - it))
+                            break;
+                        domain.assign(reinterpret_cast<char const *>(it), n);
+                        it += n;
+                    }
+                    else if(field == ((2 << 3) | 0)) // version
+                    {
+                        version = static_cast<int64_t>(read_varint(it, last));
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                if(domain.empty() || domain == "ai.onnx")
+                    opset = version;
+            }
+
+            p += length;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return opset;
+}
+
+/**
+ * @brief Creates a session of the model with the enabled graph rewrites applied.
+ * @details Uses the ONNX Runtime model editor API to add nodes to the loaded graph.
+ *          With `fold_preprocessing` the new graph input is a raw uint8 NHWC BGR image and the nodes
+ *          `Gather` (BGR to RGB), `Cast` (to float), `Div` (by 255) and `Transpose` (NHWC to NCHW)
+ *          produce the original input.
+ *          With `graph_top_k` the nodes `Softmax` (if `use_softmax` is set) and `TopK` are appended
+ *          to the first output and the graph returns only the top K values and class indices.
+ * @param[in] model_buffer The serialized model.
+ * @param[in] session_options The session options.
+ * @return The session of the rewritten model.
+ * @throws std::invalid_argument if the ONNX Runtime does not provide the model editor API.
+ */
+Ort::Session yolo::create_rewritten_session(std::vector<char> const &model_buffer, Ort::SessionOptions const &session_options)
+{
+#if ORT_API_VERSION >= 22
+    int64_t opset = read_model_opset(model_buffer.data(), model_buffer.size());
+    if(opset == 0)
+        opset = 13;
+
+    Ort::Graph graph;
+    std::vector<Ort::ValueInfo> graph_inputs;
+    std::vector<Ort::ValueInfo> graph_outputs;
+
+    // Creates a constant int64 tensor owned by the graph
+    auto add_int64_initializer = [&](std::string const &name, std::vector<int64_t> const &values, std::vector<int64_t> const &shape)
+    {
+        Ort::Value value = Ort::Value::CreateTensor<int64_t>(allocator, shape.data(), shape.size());
+        std::copy(values.begin(), values.end(), value.GetTensorMutableData<int64_t>());
+        graph.AddInitializer(name, value, false);
+    };
+
+    std::string const original_input = input_names.front();
+
+    if(fold_preprocessing)
+    {
+        // The batch dimension stays symbolic for models with a dynamic batch
+        std::vector<int64_t> dims              = {batch_size > 0 ? batch_size : -1, input_height, input_width, 3};
+        std::vector<std::string> symbolic_dims = {batch_size > 0 ? "" : "batch", "", "", ""};
+        Ort::TensorTypeAndShapeInfo tensor_info(ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8, dims, &symbolic_dims);
+        graph_inputs.emplace_back(folded_input_name, Ort::TypeInfo::CreateTensorInfo(tensor_info.GetConst()).GetConst());
+
+        // BGR to RGB, reverse the order of the channels
+        add_int64_initializer("yolo_cls_channel_order", {2, 1, 0}, {3});
+        int64_t axis = 3;
+        std::vector<Ort::OpAttr> gather_attributes;
+        gather_attributes.emplace_back("axis", &axis, 1, ORT_OP_ATTR_INT);
+        Ort::Node gather("Gather", "", "yolo_cls_bgr_to_rgb", {folded_input_name, "yolo_cls_channel_order"}, {"yolo_cls_rgb"}, gather_attributes);
+        graph.AddNode(gather);
+
+        // uint8 to float
+        int64_t to = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+        std::vector<Ort::OpAttr> cast_attributes;
+        cast_attributes.emplace_back("to", &to, 1, ORT_OP_ATTR_INT);
+        Ort::Node cast("Cast", "", "yolo_cls_cast", {"yolo_cls_rgb"}, {"yolo_cls_float"}, cast_attributes);
+        graph.AddNode(cast);
+
+        // [0, 255] to [0, 1]
+        std::vector<int64_t> scalar_shape;
+        Ort::Value scale = Ort::Value::CreateTensor<float>(allocator, scalar_shape.data(), scalar_shape.size());
+        *scale.GetTensorMutableData<float>() = 255.0f;
+        graph.AddInitializer("yolo_cls_scale", scale, false);
+        Ort::Node div("Div", "", "yolo_cls_normalize", {"yolo_cls_float", "yolo_cls_scale"}, {"yolo_cls_normalized"});
+        graph.AddNode(div);
+
+        // NHWC to NCHW, the output is the original graph input
+        std::vector<int64_t> perm = {0, 3, 1, 2};
+        std::vector<Ort::OpAttr> transpose_attributes;
+        transpose_attributes.emplace_back("perm", perm.data(), static_cast<int>(perm.size()), ORT_OP_ATTR_INTS);
+        Ort::Node transpose("Transpose", "", "yolo_cls_nhwc_to_nchw", {"yolo_cls_normalized"}, {original_input}, transpose_attributes);
+        graph.AddNode(transpose);
+    }
+
+    if(graph_top_k > 0)
+    {
+        std::string scores = output_names.front();
+
+        // Apply softmax to get probabilities
+        if(use_softmax)
+        {
+            int64_t axis = -1;
+            std::vector<Ort::OpAttr> softmax_attributes;
+            softmax_attributes.emplace_back("axis", &axis, 1, ORT_OP_ATTR_INT);
+            Ort::Node softmax_node("Softmax", "", "yolo_cls_softmax", {scores}, {"yolo_cls_probabilities"}, softmax_attributes);
+            graph.AddNode(softmax_node);
+
+            scores = "yolo_cls_probabilities";
+        }
+
+        // K cannot exceed the number of classes
+        auto output_dims = session.GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        if(output_dims.size() == 2 && output_dims[1] > 0)
+            graph_top_k = std::min<size_t>(graph_top_k, static_cast<size_t>(output_dims[1]));
+
+        add_int64_initializer("yolo_cls_k", {static_cast<int64_t>(graph_top_k)}, {1});
+
+        int64_t axis    = -1;
+        int64_t largest = 1;
+        int64_t sorted  = 1;
+        std::vector<Ort::OpAttr> topk_attributes;
+        topk_attributes.emplace_back("axis", &axis, 1, ORT_OP_ATTR_INT);
+        topk_attributes.emplace_back("largest", &largest, 1, ORT_OP_ATTR_INT);
+        topk_attributes.emplace_back("sorted", &sorted, 1, ORT_OP_ATTR_INT);
+        Ort::Node topk("TopK", "", "yolo_cls_topk", {scores, "yolo_cls_k"}, {"yolo_cls_topk_values", "yolo_cls_topk_indices"}, topk_attributes);
+        graph.AddNode(topk);
+
+        // The graph returns only [batch, K] values and indices
+        std::vector<int64_t> dims              = {output_dims.empty() ? -1 : output_dims[0], static_cast<int64_t>(graph_top_k)};
+        std::vector<std::string> symbolic_dims = {dims[0] > 0 ? "" : "batch", ""};
+        Ort::TensorTypeAndShapeInfo values_info(ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT, dims, &symbolic_dims);
+        Ort::TensorTypeAndShapeInfo indices_info(ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64, dims, &symbolic_dims);
+        graph_outputs.emplace_back("yolo_cls_topk_values", Ort::TypeInfo::CreateTensorInfo(values_info.GetConst()).GetConst());
+        graph_outputs.emplace_back("yolo_cls_topk_indices", Ort::TypeInfo::CreateTensorInfo(indices_info.GetConst()).GetConst());
+    }
+    else
+    {
+        // The outputs of the original graph are kept
+        for(size_t i = 0; i < output_names.size(); ++i)
+            graph_outputs.emplace_back(output_names[i], session.GetOutputTypeInfo(i).GetConst());
+    }
+
+    // The original graph input is replaced by the folded one, or kept
+    if(!fold_preprocessing)
+        graph_inputs.emplace_back(original_input, session.GetInputTypeInfo(0).GetConst());
+
+    graph.SetInputs(graph_inputs);
+    graph.SetOutputs(graph_outputs);
+
+    Ort::Model model({{"", static_cast<int>(opset)}});
+    model.AddGraph(graph);
+
+    Ort::Session result = Ort::Session::CreateModelEditorSession(env, model_buffer.data(), model_buffer.size(), session_options);
+    result.FinalizeModelEditorSession(model, session_options);
+
+    return result;
+#else
+    throw std::invalid_argument("Graph rewrites require ONNX Runtime 1.22 or newer (model editor API).");
+#endif
+}
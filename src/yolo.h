@@ -32,6 +32,7 @@
 
 #include <cstddef>
 #include <string>
+#include <utility>
 #include <vector>
 #include <onnxruntime_cxx_api.h>
 #include <opencv2/opencv.hpp>
@@ -46,6 +47,44 @@ struct prediction
     float confidence;       ///< The confidence score of the prediction.
 };
 
+/**
+ * @struct yolo_options
+ * @brief Options that control how the model is loaded and run.
+ */
+struct yolo_options
+{
+    bool use_softmax           = false; ///< If true, applies softmax to the model's output scores to convert them to probabilities.
+    int64_t input_width        = 0;     ///< Inference width for models with dynamic spatial dimensions, 0 to use the model default.
+    int64_t input_height       = 0;     ///< Inference height for models with dynamic spatial dimensions, 0 to use the model default.
+    bool fold_preprocessing    = false; ///< If true, the preprocessing is folded into the graph, which then accepts raw uint8 NHWC BGR images.
+    size_t graph_top_k         = 0;     ///< If not 0, Softmax (with `use_softmax`) and TopK are appended to the graph, which then returns only K results.
+    std::string profile_prefix = "";    ///< If not empty, ONNX Runtime profiling is enabled and the profile is written to a file with this prefix.
+};
+
+/**
+ * @brief Prepares an image for inference.
+ *        This involves resizing (unless the image already has the size), color space conversion (BGR to RGB),
+ *        normalization (to [0, 1]), and layout conversion to NCHW format.
+ * @param[in] image The input BGR image.
+ * @param[in] size The input size of the model.
+ * @param[out] output_tensor Pointer to `3 * size.height * size.width` floats to be filled with the preprocessed image data.
+ */
+void preprocess_image(cv::Mat const &image, cv::Size size, float *output_tensor);
+
+/**
+ * @brief Applies the softmax function to a vector of raw scores (logits) to convert them into probabilities.
+ * @param[in,out] scores A vector of scores to be modified in-place.
+ */
+void softmax_scores(std::vector<float> &scores);
+
+/**
+ * @brief Selects the K highest scores.
+ * @param[in] scores The scores of all classes.
+ * @param[in] top_k The number of scores to select.
+ * @return Pairs of the class index and the score, sorted by score in descending order.
+ */
+std::vector<std::pair<int, float>> top_k_scores(std::vector<float> const &scores, size_t top_k);
+
 /**
  * @class yolo
  * @brief Encapsulates the YOLO classification model, handling model loading, preprocessing, inference, and post-processing.
@@ -78,6 +117,21 @@ public:
      */
     yolo(std::string const &model_path, std::string const &cls_path, bool const &use_softmax);
 
+    /**
+     * @brief Constructs and initializes a yolo object with the given options.
+     * @details Symbolic (dynamic) dimensions of the model input are resolved here.
+     *          A dynamic batch dimension enables batched execution in `predict_batch`.
+     *          Every dynamic spatial dimension uses `yolo_options::input_width` or `yolo_options::input_height`,
+     *          or the other, fixed dimension or `default_input_size` if they are not set. A fixed dimension is kept.
+     * @param[in] model_path Path to the ONNX model file.
+     * @param[in] cls_path Path to the text file containing class names (one per line).
+     * @param[in] options The model options.
+     * @throws std::invalid_argument if the model or class file cannot be loaded or is invalid,
+     *         or if the requested input size does not match a fixed dimension of the model input.
+     * @throws std::filesystem::filesystem_error if the class names file cannot be opened.
+     */
+    yolo(std::string const &model_path, std::string const &cls_path, yolo_options const &options);
+
     // Rule of five - disable copying, enable moving
     yolo(const yolo &)            = delete;
     yolo &operator=(const yolo &) = delete;
@@ -104,6 +158,68 @@ public:
      */
     std::vector<prediction> predict(cv::Mat const &image, size_t const &top_k);
 
+    /**
+     * @brief Performs classification on several images.
+     * @details Models with a dynamic batch dimension classify all images in a single session run.
+     *          Models with a fixed batch dimension run once per batch (the last batch is padded).
+     *          Preprocessed input tensors (see `is_input_tensor`) are fed as they are,
+     *          a single tensor without a copy.
+     * @param[in] images The input images as `cv::Mat` objects.
+     * @param[in] top_k The number of top predictions to return per image.
+     * @return One vector of `prediction` structs per image, sorted by confidence in descending order.
+     * @throws std::runtime_error if the model is not initialized (e.g., default-constructed).
+     */
+    std::vector<std::vector<prediction>> predict_batch(std::vector<cv::Mat> const &images, size_t const &top_k);
+
+    /**
+     * @brief Describes the resolved model input shape (e.g., `[dynamic, 3, 320, 320]`).
+     * @return The description of the input shape.
+     */
+    std::string describe_input() const;
+
+    /**
+     * @brief Checks whether the model input has a dynamic batch dimension.
+     * @return True if any number of images can be classified in a single session run.
+     */
+    bool has_dynamic_batch() const;
+
+    /**
+     * @brief Checks whether any dimension of the model input is dynamic.
+     * @return True if the batch or the spatial dimensions are dynamic.
+     */
+    bool has_dynamic_input() const;
+
+    /**
+     * @brief Checks whether an image is a preprocessed input tensor of this model.
+     * @details A preprocessed input tensor is a continuous `CV_32FC1` matrix with 3 rows, the RGB planes,
+     *          of `input_size().area()` columns, as written by `preprocess_image`.
+     * @param[in] image The image.
+     * @return True if the image is a preprocessed input tensor.
+     */
+    bool is_input_tensor(cv::Mat const &image) const;
+
+    /// The spatial input size used for models with dynamic spatial dimensions if none is requested.
+    static constexpr int64_t default_input_size = 224;
+
+    /**
+     * @brief Returns the spatial input size of the model.
+     * @details Images that already have this size are not resized again by `predict`.
+     * @return The input width and height.
+     */
+    cv::Size input_size() const;
+
+    /**
+     * @brief Ends the ONNX Runtime profiling and writes the profile (see `yolo_options::profile_prefix`).
+     * @return The path of the profile in the Chrome trace event format, or an empty string if profiling is not enabled.
+     */
+    std::string end_profiling();
+
+    /**
+     * @brief Returns the start of the ONNX Runtime profiling.
+     * @return Nanoseconds since the epoch of `std::chrono::high_resolution_clock`, 0 if profiling is not enabled.
+     */
+    uint64_t profiling_start_ns() const;
+
 private:
     // ONNX Runtime session members
     Ort::Env env;
@@ -111,8 +227,16 @@ private:
     Ort::AllocatorWithDefaultOptions allocator;
 
     // Model properties extracted from the ONNX file
-    int64_t input_width  = 0;
-    int64_t input_height = 0;
+    int64_t input_width     = 0;
+    int64_t input_height    = 0;
+    int64_t batch_size      = 1;     ///< Fixed batch dimension of the model input, 0 if the batch dimension is dynamic.
+    bool dynamic_size       = false; ///< True if the spatial dimensions of the model input are dynamic.
+    bool fold_preprocessing = false; ///< True if the graph accepts raw uint8 NHWC BGR images.
+    size_t graph_top_k      = 0;     ///< The K of the TopK node appended to the graph, 0 if there is none.
+    bool profiling          = false; ///< True if ONNX Runtime profiling is enabled and has not ended.
+
+    /// The name of the graph input added by the preprocessing rewrite.
+    static constexpr char const *folded_input_name = "yolo_cls_images_u8";
     std::vector<Ort::AllocatedStringPtr> input_node_names;
     std::vector<Ort::AllocatedStringPtr> output_node_names;
 
@@ -123,20 +247,53 @@ private:
     // Class names loaded from the provided text file
     std::vector<std::string> class_names;
 
+    /**
+     * @brief Reads the input and output node names of the current session.
+     */
+    void read_node_names();
+
+    /**
+     * @brief Creates a session of the model with the enabled graph rewrites applied.
+     * @details Uses the ONNX Runtime model editor API to add nodes to the loaded graph.
+     *          With `fold_preprocessing` the new graph input is a raw uint8 NHWC BGR image and the nodes
+     *          `Gather` (BGR to RGB), `Cast` (to float), `Div` (by 255) and `Transpose` (NHWC to NCHW)
+     *          produce the original input.
+     *          With `graph_top_k` the nodes `Softmax` (if `use_softmax` is set) and `TopK` are appended
+     *          to the first output and the graph returns only the top K values and class indices.
+     * @param[in] model_buffer The serialized model.
+     * @param[in] session_options The session options.
+     * @return The session of the rewritten model.
+     * @throws std::invalid_argument if the ONNX Runtime does not provide the model editor API.
+     */
+    Ort::Session create_rewritten_session(std::vector<char> const &model_buffer, Ort::SessionOptions const &session_options);
+
     /**
      * @brief Prepares an image for inference.
-              This involves resizing, color space conversion (BGR to RGB),
-              normalization (to [0, 1]), and layout conversion to NCHW format.
+     *        This involves resizing, color space conversion (BGR to RGB),
+     *        normalization (to [0, 1]), and layout conversion to NCHW format.
      * @param[in] image The input image.
-     * @param[out] output_tensor A vector to be filled with the preprocessed image data.
+     * @param[out] output_tensor Pointer to `3 * input_height * input_width` floats to be filled with the preprocessed image data.
      */
-    void preprocess(cv::Mat const &image, std::vector<float> &output_tensor) const;
+    void preprocess(cv::Mat const &image, float *output_tensor) const;
 
     /**
-     * @brief Applies the softmax function to a vector of raw scores (logits) to convert them into probabilities.
-     * @param[out] scores A vector of scores to be modified in-place.
+     * @brief Converts the raw scores of a single image into the top K predictions.
+     * @param[in] raw_output Pointer to the raw scores of the image.
+     * @param[in] output_size The number of scores (classes).
+     * @param[in] top_k The number of top predictions to return.
+     * @return A vector of `prediction` structs, sorted by confidence in descending order.
+     */
+    std::vector<prediction> postprocess(float const *raw_output, size_t output_size, size_t top_k) const;
+
+    /**
+     * @brief Converts the top K results returned by the graph into predictions.
+     * @param[in] values Pointer to the sorted top K values of the image.
+     * @param[in] indices Pointer to the class indices of the values.
+     * @param[in] k The number of values returned by the graph.
+     * @param[in] top_k The number of top predictions to return.
+     * @return A vector of `prediction` structs, sorted by confidence in descending order.
      */
-    void softmax(std::vector<float> &scores) const;
+    std::vector<prediction> postprocess_top_k(float const *values, int64_t const *indices, size_t k, size_t top_k) const;
 
     // Model input/output node counts
     size_t input_nodes_num  = 0;
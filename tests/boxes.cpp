@@ -0,0 +1,110 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file boxes.cpp
+ * @brief Tests the parser of the box lines of a detector with malformed and oversized boxes.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <climits>
+#include <string>
+
+#include "check.h"
+#include "utils.h"
+
+/**
+ * @brief Checks that a line is parsed into a path and a box.
+ * @param[in] line The line.
+ * @param[in] path The expected path.
+ * @param[in] box The expected box.
+ * @return True if the line is parsed as expected.
+ */
+static bool parsed_as(std::string const &line, std::string const &path, cv::Rect const &box)
+{
+    auto const result = parse_box_line(line);
+    return result && result->first == path && result->second == box;
+}
+
+/**
+ * @brief Tests valid lines.
+ */
+static void test_valid()
+{
+    CHECK(parsed_as("a.jpg 1 2 3 4", "a.jpg", cv::Rect(1, 2, 3, 4)));
+    CHECK(parsed_as("a.jpg\t1\t2\t3\t4", "a.jpg", cv::Rect(1, 2, 3, 4)));
+    CHECK(parsed_as("a.jpg 1 2 3 4\r", "a.jpg", cv::Rect(1, 2, 3, 4)));
+    CHECK(parsed_as("a.jpg   1  2 3 4  ", "a.jpg", cv::Rect(1, 2, 3, 4)));
+
+    // The path may contain spaces and digits
+    CHECK(parsed_as("my photos/img 7.jpg 10 20 30 40", "my photos/img 7.jpg", cv::Rect(10, 20, 30, 40)));
+    CHECK(parsed_as("5 1 2 3 4", "5", cv::Rect(1, 2, 3, 4)));
+
+    // Boxes partly outside of the image are clipped later
+    CHECK(parsed_as("a.jpg -5 -5 10 10", "a.jpg", cv::Rect(-5, -5, 10, 10)));
+}
+
+/**
+ * @brief Tests lines that are not boxes.
+ */
+static void test_malformed()
+{
+    CHECK(!parse_box_line(""));
+    CHECK(!parse_box_line("a.jpg"));
+    CHECK(!parse_box_line("a.jpg 1 2 3"));
+    CHECK(!parse_box_line("1 2 3 4"));
+    CHECK(!parse_box_line(" 1 2 3 4"));
+    CHECK(!parse_box_line("a.jpg 1 2 x 4"));
+    CHECK(!parse_box_line("a.jpg 1 2 3.5 4"));
+    CHECK(!parse_box_line("a.jpg 1 2 3 4px"));
+    CHECK(!parse_box_line("a.jpg 1,2,3,4"));
+
+    // Empty boxes
+    CHECK(!parse_box_line("a.jpg 1 2 0 4"));
+    CHECK(!parse_box_line("a.jpg 1 2 3 -4"));
+}
+
+/**
+ * @brief Tests numbers and boxes that do not fit into an `int`.
+ */
+static void test_oversized()
+{
+    CHECK(!parse_box_line("a.jpg 1 2 99999999999 4"));
+    CHECK(!parse_box_line("a.jpg -99999999999 2 3 4"));
+
+    // The right and bottom edges must fit too
+    std::string const max = std::to_string(INT_MAX);
+    CHECK(parsed_as("a.jpg 0 0 " + max + " " + max, "a.jpg", cv::Rect(0, 0, INT_MAX, INT_MAX)));
+    CHECK(!parse_box_line("a.jpg 1 0 " + max + " 4"));
+    CHECK(!parse_box_line("a.jpg 0 1 4 " + max));
+    CHECK(!parse_box_line("a.jpg " + max + " 0 1 1"));
+}
+
+int main()
+{
+    test_valid();
+    test_malformed();
+    test_oversized();
+
+    return check_status();
+}
\ No newline at end of file
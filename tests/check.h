@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file check.h
+ * @brief Declares the assertions of the unit tests.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+/// The number of failed checks of the test executable.
+inline int check_failures = 0;
+
+/**
+ * @brief Records the result of a check and reports a failure.
+ * @param[in] passed The result of the check.
+ * @param[in] expression The checked expression.
+ * @param[in] file The source file of the check.
+ * @param[in] line The line of the check.
+ */
+inline void check(bool passed, char const *expression, char const *file, int line)
+{
+    if(passed)
+        return;
+
+    ++check_failures;
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+}
+
+/**
+ * @brief Returns the exit status of the test executable.
+ * @return `EXIT_SUCCESS` if every check passed, `EXIT_FAILURE` otherwise.
+ */
+inline int check_status()
+{
+    if(check_failures != 0)
+        std::cerr << check_failures << " check(s) failed." << std::endl;
+
+    return check_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/// Checks that a condition holds.
+#define CHECK(condition) check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+
+/// Checks that an expression throws an exception of the given type.
+#define CHECK_THROWS(expression, type)                                               \
+    do                                                                               \
+    {                                                                                \
+        bool thrown = false;                                                         \
+        try                                                                          \
+        {                                                                            \
+            (void)(expression);                                                      \
+        }                                                                            \
+        catch(type const &)                                                          \
+        {                                                                            \
+            thrown = true;                                                           \
+        }                                                                            \
+        catch(std::exception const &)                                                \
+        {                                                                            \
+        }                                                                            \
+        check(thrown, #expression " throws " #type, __FILE__, __LINE__);             \
+    } while(false)
+
+#endif // CHECK_H
\ No newline at end of file
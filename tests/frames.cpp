@@ -0,0 +1,148 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file frames.cpp
+ * @brief Tests the reader of length-prefixed frames with truncated and oversized frames.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "utils.h"
+
+/// An anonymous temporary file, removed when it is closed.
+using temporary_file = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+/**
+ * @brief Writes a stream to an anonymous temporary file.
+ * @param[in] data The content of the stream.
+ * @return The file, positioned at the start.
+ * @throws std::runtime_error if the file cannot be created.
+ */
+static temporary_file open_stream(std::string const &data)
+{
+    temporary_file file(std::tmpfile(), std::fclose);
+    if(!file)
+        throw std::runtime_error("could not create a temporary file.");
+
+    std::fwrite(data.data(), 1, data.size(), file.get());
+    std::rewind(file.get());
+
+    return file;
+}
+
+/**
+ * @brief Formats a frame.
+ * @param[in] content The content of the frame.
+ * @return The 32-bit little-endian length followed by the content.
+ */
+static std::string frame(std::string const &content)
+{
+    uint32_t const size = static_cast<uint32_t>(content.size());
+
+    std::string result;
+    for(int i = 0; i < 4; ++i)
+        result += static_cast<char>((size >> (8 * i)) & 0xFF);
+
+    return result + content;
+}
+
+/**
+ * @brief Tests a stream of complete frames.
+ */
+static void test_frames()
+{
+    auto const stream = open_stream(frame("first") + frame("") + frame(std::string(300, 'x')));
+    std::vector<uchar> buffer;
+
+    auto size = read_frame(stream.get(), buffer, 1024);
+    CHECK(size && *size == 5);
+    CHECK(std::string(buffer.begin(), buffer.end()) == "first");
+
+    size = read_frame(stream.get(), buffer, 1024);
+    CHECK(size && *size == 0);
+    CHECK(buffer.empty());
+
+    // The length is little-endian
+    size = read_frame(stream.get(), buffer, 1024);
+    CHECK(size && *size == 300);
+    CHECK(buffer.size() == 300);
+
+    CHECK(!read_frame(stream.get(), buffer, 1024));
+}
+
+/**
+ * @brief Tests streams that end inside a frame.
+ */
+static void test_truncated()
+{
+    std::vector<uchar> buffer;
+
+    auto const header = open_stream(frame("first") + frame("second").substr(0, 2));
+    CHECK(read_frame(header.get(), buffer, 1024));
+    CHECK_THROWS(read_frame(header.get(), buffer, 1024), std::runtime_error);
+
+    auto const content = open_stream(frame("second").substr(0, 7));
+    CHECK_THROWS(read_frame(content.get(), buffer, 1024), std::runtime_error);
+
+    // A length beyond the stream is not allocated
+    auto const length = open_stream(std::string("\xff\xff\xff\xff", 4) + "short");
+    CHECK_THROWS(read_frame(length.get(), buffer, 1024), std::runtime_error);
+}
+
+/**
+ * @brief Tests frames larger than the maximum size, which are skipped without keeping them in memory.
+ */
+static void test_oversized()
+{
+    std::vector<uchar> buffer;
+
+    auto const stream = open_stream(frame(std::string(100 * 1024, 'x')) + frame("next"));
+
+    auto size = read_frame(stream.get(), buffer, 1024);
+    CHECK(size && *size == 100 * 1024);
+    CHECK(buffer.empty());
+
+    // The stream continues after the skipped frame
+    size = read_frame(stream.get(), buffer, 1024);
+    CHECK(size && *size == 4);
+    CHECK(std::string(buffer.begin(), buffer.end()) == "next");
+
+    auto const truncated = open_stream(frame(std::string(100 * 1024, 'x')).substr(0, 2000));
+    CHECK_THROWS(read_frame(truncated.get(), buffer, 1024), std::runtime_error);
+}
+
+int main()
+{
+    test_frames();
+    test_truncated();
+    test_oversized();
+
+    return check_status();
+}
\ No newline at end of file
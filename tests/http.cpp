@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file http.cpp
+ * @brief Tests the request parser of the HTTP endpoint with truncated, malformed and oversized requests.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <string>
+#include <string_view>
+
+#include "check.h"
+#include "http_server.h"
+
+/// The maximum body size of the tests.
+static constexpr uint64_t max_body_size = 1024;
+
+/**
+ * @brief Parses a request.
+ * @param[in] data The received bytes.
+ * @param[out] request Receives the request line and the headers.
+ * @return The status returned by `parse_http_request`.
+ */
+static int parse(std::string_view data, http_request &request)
+{
+    std::string error;
+    return parse_http_request(data, max_body_size, request, error);
+}
+
+/**
+ * @brief Parses a request with a single header.
+ * @param[in] header The header line without the line break.
+ * @return The status returned by `parse_http_request`.
+ */
+static int parse_header(std::string const &header)
+{
+    http_request request;
+    return parse("POST /classify HTTP/1.1\r\n" + header + "\r\n\r\n", request);
+}
+
+/**
+ * @brief Tests a complete request.
+ */
+static void test_complete()
+{
+    std::string const data = "POST /classify?model=a HTTP/1.1\r\nHost: x\r\ncontent-length:  4 \r\nContent-Type: image/jpeg\r\nX-Priority: bulk\r\nX-Deadline-Ms: 250\r\n\r\nbody";
+
+    http_request request;
+    CHECK(parse(data, request) == 200);
+    CHECK(request.method == "POST");
+    CHECK(request.target == "/classify");
+    CHECK(request.content_type == "image/jpeg");
+    CHECK(request.content_length == 4);
+    CHECK(data.substr(request.body_begin) == "body");
+    CHECK(request.deadline_ms == 250);
+    CHECK(request.priority == job_priority::bulk);
+    CHECK(request.keep_alive);
+    CHECK(!request.expect_continue);
+}
+
+/**
+ * @brief Tests the persistence of the connection.
+ */
+static void test_keep_alive()
+{
+    http_request request;
+
+    CHECK(parse("GET /healthz HTTP/1.0\r\n\r\n", request) == 200);
+    CHECK(!request.keep_alive);
+
+    CHECK(parse("GET /healthz HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", request) == 200);
+    CHECK(request.keep_alive);
+
+    CHECK(parse("GET /healthz HTTP/1.1\r\nConnection: close\r\n\r\n", request) == 200);
+    CHECK(!request.keep_alive);
+
+    CHECK(parse("POST /classify HTTP/1.1\r\nContent-Length: 10\r\nExpect: 100-continue\r\n\r\n", request) == 200);
+    CHECK(request.expect_continue);
+}
+
+/**
+ * @brief Tests requests whose headers are not complete yet.
+ */
+static void test_truncated()
+{
+    http_request request;
+
+    CHECK(parse("", request) == 0);
+    CHECK(parse("POST /classify HTTP/1.1\r\n", request) == 0);
+    CHECK(parse("POST /classify HTTP/1.1\r\nContent-Length: 4\r\n\r", request) == 0);
+
+    // The body is not part of the headers
+    std::string const data = "POST /classify HTTP/1.1\r\nContent-Length: 100\r\n\r\npartial";
+    CHECK(parse(data, request) == 200);
+    CHECK(data.size() < request.body_begin + request.content_length);
+}
+
+/**
+ * @brief Tests malformed request lines.
+ */
+static void test_malformed()
+{
+    http_request request;
+
+    CHECK(parse("GARBAGE\r\n\r\n", request) == 400);
+    CHECK(parse("GET /\r\n\r\n", request) == 400);
+    CHECK(parse("GET / HTTP/2.0\r\n\r\n", request) == 400);
+    CHECK(parse("GET / http/1.1\r\n\r\n", request) == 400);
+
+    // Lines without a colon are ignored
+    CHECK(parse("GET /healthz HTTP/1.1\r\nno colon\r\n\r\n", request) == 200);
+}
+
+/**
+ * @brief Tests invalid `Content-Length` headers, which would frame the body differently than a proxy.
+ */
+static void test_content_length()
+{
+    CHECK(parse_header("Content-Length: 12") == 200);
+    CHECK(parse_header("Content-Length: 0") == 200);
+
+    CHECK(parse_header("Content-Length:") == 400);
+    CHECK(parse_header("Content-Length: 12abc") == 400);
+    CHECK(parse_header("Content-Length: -1") == 400);
+    CHECK(parse_header("Content-Length: +1") == 400);
+    CHECK(parse_header("Content-Length: 0x10") == 400);
+    CHECK(parse_header("Content-Length: 1 2") == 400);
+    CHECK(parse_header("Content-Length: 99999999999999999999") == 400);
+
+    http_request request;
+    CHECK(parse("POST /classify HTTP/1.1\r\nContent-Length: 4\r\nContent-Length: 4\r\n\r\n", request) == 400);
+    CHECK(parse("POST /classify HTTP/1.1\r\nContent-Length: 4\r\nContent-Length: 8\r\n\r\n", request) == 400);
+
+    CHECK(parse_header("Transfer-Encoding: chunked") == 501);
+    CHECK(parse_header("Transfer-Encoding: identity") == 200);
+}
+
+/**
+ * @brief Tests the `X-Deadline-Ms` header.
+ */
+static void test_deadline()
+{
+    CHECK(parse_header("X-Deadline-Ms: 0") == 200);
+    CHECK(parse_header("X-Deadline-Ms: " + std::to_string(max_deadline_ms)) == 200);
+
+    CHECK(parse_header("X-Deadline-Ms: " + std::to_string(max_deadline_ms + 1)) == 400);
+    CHECK(parse_header("X-Deadline-Ms: -5") == 400);
+    CHECK(parse_header("X-Deadline-Ms: soon") == 400);
+    CHECK(parse_header("X-Deadline-Ms: 1.5") == 400);
+}
+
+/**
+ * @brief Tests oversized headers and bodies.
+ */
+static void test_oversized()
+{
+    CHECK(parse_header("Content-Length: " + std::to_string(max_body_size)) == 200);
+    CHECK(parse_header("Content-Length: " + std::to_string(max_body_size + 1)) == 413);
+
+    // Headers without an end are rejected once they exceed the limit
+    http_request request;
+    std::string headers = "GET / HTTP/1.1\r\n";
+    while(headers.size() <= 64 * 1024)
+        headers += "X-Padding: " + std::string(100, 'a') + "\r\n";
+
+    std::string error;
+    CHECK(parse_http_request(headers, max_body_size, request, error) == 431);
+    CHECK(!error.empty());
+}
+
+int main()
+{
+    test_complete();
+    test_keep_alive();
+    test_truncated();
+    test_malformed();
+    test_content_length();
+    test_deadline();
+    test_oversized();
+
+    return check_status();
+}
\ No newline at end of file
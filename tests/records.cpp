@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file records.cpp
+ * @brief Tests the validation of record files with truncated, malformed and oversized files.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "check.h"
+#include "records.h"
+
+/// The directory of the record files of the tests.
+static std::filesystem::path const directory = std::filesystem::temp_directory_path() / ("yolo-cls-test-records-" + std::to_string(std::random_device()()));
+
+/**
+ * @struct record_layout
+ * @brief A record file with a single image, `a.jpg` with the content `abc`.
+ */
+struct record_layout
+{
+    records_header header = {};                            ///< The header.
+    records_entry entry   = {};                            ///< The only entry of the index.
+    std::string blob      = std::string("abc\0\0\0\0\0", 8); ///< The image blob, padded to the alignment of the index.
+    std::string paths     = "a.jpg";                       ///< The path table.
+
+    /**
+     * @brief Creates a valid layout.
+     */
+    record_layout()
+    {
+        std::memcpy(header.magic, records_magic, sizeof(records_magic));
+        header.version      = records_version;
+        header.alignment    = 8;
+        header.count        = 1;
+        header.index_offset = sizeof(records_header) + blob.size();
+        header.paths_offset = header.index_offset + sizeof(records_entry);
+        header.paths_size   = paths.size();
+
+        entry = {sizeof(records_header), 3, 0, paths.size()};
+    }
+
+    /**
+     * @brief Serializes the layout.
+     * @return The content of the record file.
+     */
+    std::string bytes() const
+    {
+        std::string result(reinterpret_cast<char const *>(&header), sizeof(header));
+        result += blob;
+        result.append(reinterpret_cast<char const *>(&entry), sizeof(entry));
+        result += paths;
+
+        return result;
+    }
+};
+
+/**
+ * @brief Writes a record file.
+ * @param[in] name The file name.
+ * @param[in] data The content.
+ * @return The path to the file.
+ */
+static std::string write_file(std::string const &name, std::string const &data)
+{
+    std::string const path = (directory / name).string();
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+    return path;
+}
+
+/**
+ * @brief Checks whether a record file is rejected.
+ * @param[in] data The content of the record file.
+ * @return True if opening the file throws `std::runtime_error`.
+ */
+static bool rejected(std::string const &data)
+{
+    try
+    {
+        record_file records(write_file("invalid.ycr", data));
+    }
+    catch(std::runtime_error const &)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Tests a valid record file.
+ */
+static void test_valid()
+{
+    record_file records(write_file("valid.ycr", record_layout().bytes()));
+
+    CHECK(records.size() == 1);
+    CHECK(records[0].path == "a.jpg");
+    CHECK(records[0].size == 3);
+    CHECK(std::memcmp(records[0].data, "abc", 3) == 0);
+
+    // An empty record file
+    record_layout empty;
+    empty.header.count = 0;
+    record_file no_records(write_file("empty.ycr", empty.bytes()));
+    CHECK(no_records.size() == 0);
+}
+
+/**
+ * @brief Tests truncated record files.
+ */
+static void test_truncated()
+{
+    std::string const data = record_layout().bytes();
+
+    CHECK(rejected(""));
+    CHECK(rejected(data.substr(0, sizeof(records_header) - 1)));
+
+    // Inside the index and inside the path table
+    CHECK(rejected(data.substr(0, sizeof(records_header) + 8 + sizeof(records_entry) / 2)));
+    CHECK(rejected(data.substr(0, data.size() - 1)));
+}
+
+/**
+ * @brief Tests record files with another format.
+ */
+static void test_malformed()
+{
+    record_layout magic;
+    magic.header.magic[0] = 'X';
+    CHECK(rejected(magic.bytes()));
+
+    record_layout version;
+    version.header.version = records_version + 1;
+    CHECK(rejected(version.bytes()));
+
+    // The index must be aligned for the entries
+    record_layout misaligned;
+    misaligned.header.index_offset -= 1;
+    CHECK(rejected(misaligned.bytes()));
+
+    CHECK(rejected(std::string(4096, 'x')));
+}
+
+/**
+ * @brief Tests offsets and sizes outside of the file, including ones that overflow when added.
+ */
+static void test_out_of_bounds()
+{
+    uint64_t const huge = std::numeric_limits<uint64_t>::max();
+
+    record_layout count;
+    count.header.count = 2;
+    CHECK(rejected(count.bytes()));
+
+    record_layout overflowing_count;
+    overflowing_count.header.count = huge / sizeof(records_entry) + 1;
+    CHECK(rejected(overflowing_count.bytes()));
+
+    record_layout index;
+    index.header.index_offset = huge - 7;
+    CHECK(rejected(index.bytes()));
+
+    record_layout paths;
+    paths.header.paths_size += 1;
+    CHECK(rejected(paths.bytes()));
+
+    record_layout paths_offset;
+    paths_offset.header.paths_offset = huge;
+    CHECK(rejected(paths_offset.bytes()));
+
+    record_layout blob;
+    blob.entry.size = 1024;
+    CHECK(rejected(blob.bytes()));
+
+    record_layout blob_offset;
+    blob_offset.entry.offset = huge - 1;
+    blob_offset.entry.size   = 2;
+    CHECK(rejected(blob_offset.bytes()));
+
+    record_layout path;
+    path.entry.path_size = path.paths.size() + 1;
+    CHECK(rejected(path.bytes()));
+
+    record_layout path_offset;
+    path_offset.entry.path_offset = huge;
+    path_offset.entry.path_size   = 2;
+    CHECK(rejected(path_offset.bytes()));
+}
+
+int main()
+{
+    std::filesystem::create_directories(directory);
+
+    test_valid();
+    test_truncated();
+    test_malformed();
+    test_out_of_bounds();
+
+    std::filesystem::remove_all(directory);
+
+    return check_status();
+}
\ No newline at end of file
@@ -0,0 +1,349 @@
+/* SPDX-License-Identifier: GPL-3.0-or-later */
+/*
+ * Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ *
+ * Author: Savelii Pototskii <savelii.pototskii@gmail.com>
+ *
+ * This file is part of yolo-cls.
+ *
+ * yolo-cls is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * yolo-cls is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with yolo-cls. If not, see <https://www.gnu.org/licenses/>.
+*/
+/**
+ * @file tar_reader.cpp
+ * @brief Tests the tar archive reader with truncated, malformed and oversized archives.
+ * @author Savelii Pototskii
+ * @date 2026-10-16
+ * @copyright Copyright (C) 2025 Savelii Pototskii (savalione.com)
+ * @copyright SPDX-License-Identifier: GPL-3.0-or-later
+*/
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "tar_reader.h"
+
+/// An anonymous temporary file, removed when it is closed.
+using temporary_file = std::unique_ptr<std::FILE, int (*)(std::FILE *)>;
+
+/**
+ * @brief Writes an archive to an anonymous temporary file.
+ * @param[in] data The archive.
+ * @return The file, positioned at the start.
+ * @throws std::runtime_error if the file cannot be created.
+ */
+static temporary_file open_archive(std::string const &data)
+{
+    temporary_file file(std::tmpfile(), std::fclose);
+    if(!file)
+        throw std::runtime_error("could not create a temporary file.");
+
+    std::fwrite(data.data(), 1, data.size(), file.get());
+    std::rewind(file.get());
+
+    return file;
+}
+
+/**
+ * @brief Writes the checksum of a header block.
+ * @param[in,out] header The header block.
+ */
+static void write_checksum(std::string &header)
+{
+    header.replace(148, 8, 8, ' ');
+
+    unsigned int sum = 0;
+    for(char c : header)
+        sum += static_cast<unsigned char>(c);
+
+    char field[8];
+    std::snprintf(field, sizeof(field), "%06o", sum);
+    header.replace(148, 7, field, 7);
+}
+
+/**
+ * @brief Creates a ustar header block.
+ * @param[in] name The name of the member.
+ * @param[in] size The size of the member.
+ * @param[in] type The type flag of the member.
+ * @param[in] prefix The ustar prefix of the name.
+ * @return The header block.
+ */
+static std::string make_header(std::string const &name, uint64_t size, char type = '0', std::string const &prefix = "")
+{
+    std::string header(512, '\0');
+
+    char field[12];
+    std::snprintf(field, sizeof(field), "%011llo", static_cast<unsigned long long>(size));
+
+    header.replace(0, std::min<size_t>(name.size(), 100), name, 0, 100);
+    header.replace(100, 7, "0000644");
+    header.replace(124, 11, field, 11);
+    header[156] = type;
+    header.replace(257, 6, "ustar\0", 6);
+    header.replace(263, 2, "00");
+    header.replace(345, prefix.size(), prefix);
+
+    write_checksum(header);
+
+    return header;
+}
+
+/**
+ * @brief Pads the content of a member to whole blocks.
+ * @param[in] content The content.
+ * @return The padded content.
+ */
+static std::string pad(std::string content)
+{
+    content.resize((content.size() + 511) / 512 * 512, '\0');
+    return content;
+}
+
+/**
+ * @brief Formats a pax extended header record.
+ * @param[in] key The key.
+ * @param[in] value The value.
+ * @return The record, `<length> <key>=<value>\n`.
+ */
+static std::string pax_record(std::string const &key, std::string const &value)
+{
+    // The length includes its own digits
+    size_t const rest = key.size() + value.size() + 3;
+    size_t length     = rest + 1;
+    while(std::to_string(length).size() + rest != length)
+        ++length;
+
+    return std::to_string(length) + " " + key + "=" + value + "\n";
+}
+
+/// The end of an archive, two zero blocks.
+static std::string const end_of_archive(1024, '\0');
+
+/**
+ * @brief Tests the ustar members, the prefix of the names and the skipped member types.
+ */
+static void test_ustar()
+{
+    std::string const data = make_header("images", 0, '5') + make_header("a.jpg", 5, '0', "images") + pad("hello") + make_header("b.png", 0) + end_of_archive;
+    auto const file        = open_archive(data);
+
+    tar_reader reader(file.get(), "test.tar");
+    std::string path;
+    std::vector<uchar> content;
+
+    auto size = reader.next(path);
+    CHECK(size && *size == 5);
+    CHECK(path == "images/a.jpg");
+
+    reader.read(content);
+    CHECK(std::string(content.begin(), content.end()) == "hello");
+
+    size = reader.next(path);
+    CHECK(size && *size == 0);
+    CHECK(path == "b.png");
+
+    CHECK(!reader.next(path));
+}
+
+/**
+ * @brief Tests an archive that ends without the zero blocks.
+ */
+static void test_missing_end()
+{
+    auto const file = open_archive(make_header("a.jpg", 3) + pad("abc"));
+
+    tar_reader reader(file.get(), "test.tar");
+    std::string path;
+
+    CHECK(reader.next(path));
+    CHECK(!reader.next(path));
+
+    auto const empty = open_archive("");
+    tar_reader empty_reader(empty.get(), "empty.tar");
+    CHECK(!empty_reader.next(path));
+}
+
+/**
+ * @brief Tests the GNU long names.
+ */
+static void test_gnu_long_name()
+{
+    std::string const name = std::string(150, 'd') + "/image.webp";
+    std::string const data = make_header("././@LongLink", name.size() + 1, 'L') + pad(name + '\0') + make_header(name.substr(0, 100), 2) + pad("ab") + end_of_archive;
+    auto const file        = open_archive(data);
+
+    tar_reader reader(file.get(), "test.tar");
+    std::string path;
+    std::vector<uchar> content;
+
+    auto const size = reader.next(path);
+    CHECK(size && *size == 2);
+    CHECK(path == name);
+
+    reader.read(content);
+    CHECK(std::string(content.begin(), content.end()) == "ab");
+    CHECK(!reader.next(path));
+}
+
+/**
+ * @brief Tests the pax extended headers, which override the name and the size of the following member.
+ */
+static void test_pax()
+{
+    std::string const name    = std::string(200, 'p') + ".jpg";
+    std::string const records = pax_record("mtime", "1700000000.5") + pax_record("path", name) + pax_record("size", "7");
+    std::string const data    = make_header("PaxHeaders/0", records.size(), 'x') + pad(records) + make_header("short.jpg", 0) + pad("1234567") + make_header("next.jpg", 1) + pad("n") + end_of_archive;
+    auto const file           = open_archive(data);
+
+    tar_reader reader(file.get(), "test.tar");
+    std::string path;
+    std::vector<uchar> content;
+
+    auto size = reader.next(path);
+    CHECK(size && *size == 7);
+    CHECK(path == name);
+
+    reader.read(content);
+    CHECK(std::string(content.begin(), content.end()) == "1234567");
+
+    // The extension applies to a single member
+    size = reader.next(path);
+    CHECK(size && *size == 1);
+    CHECK(path == "next.jpg");
+}
+
+/**
+ * @brief Tests the GNU base-256 sizes of members of 8 GiB and more.
+ */
+static void test_base256_size()
+{
+    // 9 GiB, larger than the 11 octal digits of the field
+    uint64_t const large = 9ull << 30;
+
+    std::string header = make_header("large.jpg", 0);
+    header.replace(124, 12, 12, '\0');
+    header[124] = static_cast<char>(0x80);
+    for(int i = 0; i < 8; ++i)
+        header[135 - i] = static_cast<char>((large >> (8 * i)) & 0xFF);
+    write_checksum(header);
+
+    auto const file = open_archive(header + std::string(512, 'x'));
+
+    tar_reader reader(file.get(), "test.tar");
+    std::string path;
+
+    auto const size = reader.next(path);
+    CHECK(size && *size == large);
+
+    // The content is not there
+    CHECK_THROWS(reader.skip(), std::runtime_error);
+}
+
+/**
+ * @brief Tests truncated archives.
+ */
+static void test_truncated()
+{
+    std::string path;
+    std::vector<uchar> content;
+
+    // Inside a header
+    auto const header = open_archive(make_header("a.jpg", 5).substr(0, 100));
+    tar_reader header_reader(header.get(), "test.tar");
+    CHECK_THROWS(header_reader.next(path), std::runtime_error);
+
+    // Inside the content
+    auto const data = open_archive(make_header("a.jpg", 1000) + std::string(10, 'x'));
+    tar_reader data_reader(data.get(), "test.tar");
+    CHECK(data_reader.next(path));
+    CHECK_THROWS(data_reader.read(content), std::runtime_error);
+
+    // Inside the content of a skipped member
+    auto const skipped = open_archive(make_header("a.jpg", 1000) + std::string(10, 'x'));
+    tar_reader skipped_reader(skipped.get(), "test.tar");
+    CHECK(skipped_reader.next(path));
+    CHECK_THROWS(skipped_reader.next(path), std::runtime_error);
+
+    // Inside a long name
+    auto const name = open_archive(make_header("././@LongLink", 300, 'L') + std::string(100, 'n'));
+    tar_reader name_reader(name.get(), "test.tar");
+    CHECK_THROWS(name_reader.next(path), std::runtime_error);
+}
+
+/**
+ * @brief Tests malformed headers.
+ */
+static void test_malformed()
+{
+    std::string path;
+
+    // A changed byte breaks the checksum
+    std::string header = make_header("a.jpg", 5);
+    header[0]          = 'b';
+
+    auto const checksum = open_archive(header + pad("hello") + end_of_archive);
+    tar_reader checksum_reader(checksum.get(), "test.tar");
+    CHECK_THROWS(checksum_reader.next(path), std::runtime_error);
+
+    // Not an archive
+    auto const text = open_archive(std::string(512, 'a'));
+    tar_reader text_reader(text.get(), "test.tar");
+    CHECK_THROWS(text_reader.next(path), std::runtime_error);
+
+    // A pax size that is not a number
+    std::string const records = pax_record("size", "12abc");
+    auto const pax            = open_archive(make_header("PaxHeaders/0", records.size(), 'x') + pad(records) + make_header("a.jpg", 0) + end_of_archive);
+    tar_reader pax_reader(pax.get(), "test.tar");
+    CHECK_THROWS(pax_reader.next(path), std::runtime_error);
+
+    // A pax record longer than the extended header
+    std::string const overlong = "99 path=a.jpg\n";
+    auto const record          = open_archive(make_header("PaxHeaders/0", overlong.size(), 'x') + pad(overlong) + make_header("a.jpg", 0) + end_of_archive);
+    tar_reader record_reader(record.get(), "test.tar");
+    CHECK_THROWS(record_reader.next(path), std::runtime_error);
+}
+
+/**
+ * @brief Tests oversized extension headers, which are read into memory.
+ */
+static void test_oversized()
+{
+    std::string path;
+
+    auto const name = open_archive(make_header("././@LongLink", 2 * 1024 * 1024, 'L') + end_of_archive);
+    tar_reader name_reader(name.get(), "test.tar");
+    CHECK_THROWS(name_reader.next(path), std::runtime_error);
+
+    auto const pax = open_archive(make_header("PaxHeaders/0", 2 * 1024 * 1024, 'x') + end_of_archive);
+    tar_reader pax_reader(pax.get(), "test.tar");
+    CHECK_THROWS(pax_reader.next(path), std::runtime_error);
+}
+
+int main()
+{
+    test_ustar();
+    test_missing_end();
+    test_gnu_long_name();
+    test_pax();
+    test_base256_size();
+    test_truncated();
+    test_malformed();
+    test_oversized();
+
+    return check_status();
+}
\ No newline at end of file